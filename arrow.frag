@@ -0,0 +1,18 @@
+#version 330 compatibility
+
+uniform int fogEnabled; // Non-zero when fog should be applied
+
+in vec3 color;    // Lit vertex color
+in float fogDist; // Distance from eye
+
+void main()
+{
+   vec4 c = vec4(color, 1.0);
+   // Linear fog, same as the terrain shader
+   if (fogEnabled != 0)
+   {
+      float fogFactor = clamp((gl_Fog.end - fogDist) * gl_Fog.scale, 0.0, 1.0);
+      c = mix(gl_Fog.color, c, fogFactor);
+   }
+   gl_FragColor = c;
+}
@@ -0,0 +1,47 @@
+#version 330 compatibility
+
+// Per-vertex: the baked arrow mesh (+Z forward, tail at the origin)
+layout(location = 0) in vec3 vertex;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec3 baseColor;
+// Per-instance (divisor 1)
+layout(location = 3) in vec3 instPos; // Tail position in world space
+layout(location = 4) in vec3 instDir; // Unit flight direction
+
+uniform int lit; // Non-zero when fixed-function lighting is on
+
+out vec3 color;    // Lit vertex color
+out float fogDist; // Distance from eye for fog
+
+void main()
+{
+   // 1) Frame from the direction, same as glRotated(yaw, Y) then (pitch, X):
+   //    Z -> dir, X stays horizontal
+   vec3 Z = instDir;
+   vec3 X = vec3(Z.z, 0.0, -Z.x);
+   float lx = length(X);
+   X = (lx > 1e-5) ? X / lx : vec3(1.0, 0.0, 0.0);
+   vec3 Y = cross(Z, X);
+   mat3 R = mat3(X, Y, Z);
+
+   // 2) Transform to eye space
+   vec4 P = gl_ModelViewMatrix * vec4(instPos + R * vertex, 1.0);
+   fogDist = length(P.xyz);
+   gl_Position = gl_ProjectionMatrix * P;
+
+   // 3) Per-vertex Blinn-Phong matching the fixed-function light 0
+   //    (color material drives ambient and diffuse)
+   if (lit == 0)
+   {
+      color = baseColor;
+      return;
+   }
+   vec3 N = normalize(gl_NormalMatrix * (R * normal));
+   vec3 L = normalize(gl_LightSource[0].position.xyz - P.xyz);
+   vec3 H = normalize(L - normalize(P.xyz));
+   float Id = max(dot(N, L), 0.0);
+   float Is = (Id > 0.0) ? pow(max(dot(N, H), 0.0), gl_FrontMaterial.shininess) : 0.0;
+   color = baseColor * (gl_LightModel.ambient.rgb + gl_LightSource[0].ambient.rgb +
+                        gl_LightSource[0].diffuse.rgb * Id) +
+           gl_FrontMaterial.specular.rgb * gl_LightSource[0].specular.rgb * Is;
+}
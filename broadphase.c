@@ -0,0 +1,176 @@
+/*
+ *  Broadphase module - implementation file
+ *  Boxes are inserted into every XZ cell they overlap. Cells hash into a
+ *  dim x dim table by wrapping their integer coordinates, so distant cells
+ *  may share a bucket; the exact box test after the lookup filters those.
+ */
+#include "broadphase.h"
+#include "utils.h"
+
+/*
+ *  Integer cell coordinate of a world position
+ */
+static int cellOf(const Broadphase *bp, double v) {
+  return (int)floor(v / bp->cell);
+}
+
+/*
+ *  Bucket index of cell (i,k); the mask wraps negative coordinates too
+ */
+static int bucketOf(const Broadphase *bp, int i, int k) {
+  const int m = bp->dim - 1;
+  return (k & m) * bp->dim + (i & m);
+}
+
+/*
+ *  Cell range under an XZ box; ranges wider than the table are clamped so
+ *  no bucket is visited twice
+ *  @param r output {i0, i1, k0, k1} (inclusive)
+ */
+static void cellRange(const Broadphase *bp, double x0, double z0, double x1,
+                      double z1, int r[4]) {
+  r[0] = cellOf(bp, x0);
+  r[1] = cellOf(bp, x1);
+  r[2] = cellOf(bp, z0);
+  r[3] = cellOf(bp, z1);
+  if (r[1] - r[0] >= bp->dim) r[1] = r[0] + bp->dim - 1;
+  if (r[3] - r[2] >= bp->dim) r[3] = r[2] + bp->dim - 1;
+}
+
+/*
+ *  Allocate an empty broadphase grid
+ *  @param bp grid to initialize
+ *  @param cellSize cell side in world units
+ *  @param capacity maximum number of boxes
+ *  @return 1 on success, 0 if allocation failed
+ */
+int initBroadphase(Broadphase *bp, double cellSize, int capacity) {
+  memset(bp, 0, sizeof(*bp));
+  bp->cell = cellSize;
+  bp->dim = 64;
+  bp->capacity = capacity;
+  bp->itemCapacity = 4 * capacity;
+  bp->box = malloc(6 * capacity * sizeof(float));
+  bp->stamp = calloc(capacity, sizeof(unsigned int));
+  bp->cellStart = calloc(bp->dim * bp->dim + 1, sizeof(int));
+  bp->cellItems = malloc(bp->itemCapacity * sizeof(int));
+  if (!bp->box || !bp->stamp || !bp->cellStart || !bp->cellItems) {
+    free(bp->box);
+    free(bp->stamp);
+    free(bp->cellStart);
+    free(bp->cellItems);
+    memset(bp, 0, sizeof(*bp));
+    return 0;
+  }
+  return 1;
+}
+
+/*
+ *  Remove all boxes (start of a refit)
+ *  @param bp broadphase grid
+ */
+void broadphaseClear(Broadphase *bp) {
+  bp->count = 0;
+  bp->itemCount = 0;
+  memset(bp->cellStart, 0, (bp->dim * bp->dim + 1) * sizeof(int));
+}
+
+/*
+ *  Add a collider box
+ *  @return box index (the caller's collider ID), or -1 if full
+ */
+int broadphaseAdd(Broadphase *bp, const double min[3], const double max[3]) {
+  if (bp->count >= bp->capacity) return -1;
+  float *b = bp->box + 6 * bp->count;
+  for (int a = 0; a < 3; a++) {
+    b[a] = min[a];
+    b[3 + a] = max[a];
+  }
+  return bp->count++;
+}
+
+/*
+ *  Sort the boxes added since the last clear into cells
+ *  Two passes (count, then scatter) give a compact cell -> boxes table
+ *  without per-cell allocations.
+ *  @param bp broadphase grid
+ */
+void broadphaseBuild(Broadphase *bp) {
+  const int buckets = bp->dim * bp->dim;
+  int *start = bp->cellStart;
+  memset(start, 0, (buckets + 1) * sizeof(int));
+
+  // 1) Count entries per bucket
+  int total = 0;
+  for (int n = 0; n < bp->count; n++) {
+    const float *box = bp->box + 6 * n;
+    int r[4];
+    cellRange(bp, box[0], box[2], box[3], box[5], r);
+    for (int k = r[2]; k <= r[3]; k++)
+      for (int i = r[0]; i <= r[1]; i++) {
+        start[bucketOf(bp, i, k) + 1]++;
+        total++;
+      }
+  }
+  if (total > bp->itemCapacity) {
+    int *items = realloc(bp->cellItems, total * sizeof(int));
+    if (!items) Fatal("Cannot grow broadphase grid\n");
+    bp->cellItems = items;
+    bp->itemCapacity = total;
+  }
+
+  // 2) Prefix sum, then scatter box indices into their buckets
+  for (int b = 0; b < buckets; b++) start[b + 1] += start[b];
+  int *fill = bp->cellItems;
+  for (int n = 0; n < bp->count; n++) {
+    const float *box = bp->box + 6 * n;
+    int r[4];
+    cellRange(bp, box[0], box[2], box[3], box[5], r);
+    // start[b] is used as the write cursor and restored below
+    for (int k = r[2]; k <= r[3]; k++)
+      for (int i = r[0]; i <= r[1]; i++) fill[start[bucketOf(bp, i, k)]++] = n;
+  }
+  for (int b = buckets; b > 0; b--) start[b] = start[b - 1];
+  start[0] = 0;
+  bp->itemCount = total;
+}
+
+/*
+ *  Find boxes overlapping the bounds of a segment
+ *  @return number of overlapping boxes (may exceed maxOut; only the first
+ *          maxOut are written)
+ */
+int broadphaseQuerySegment(Broadphase *bp, const double p0[3],
+                           const double p1[3], int *out, int maxOut) {
+  double min[3], max[3];
+  for (int a = 0; a < 3; a++) {
+    min[a] = fmin(p0[a], p1[a]);
+    max[a] = fmax(p0[a], p1[a]);
+  }
+
+  // New stamp per query; reset all stamps when the counter wraps
+  if (++bp->query == 0) {
+    memset(bp->stamp, 0, bp->capacity * sizeof(unsigned int));
+    bp->query = 1;
+  }
+
+  int found = 0;
+  int r[4];
+  cellRange(bp, min[0], min[2], max[0], max[2], r);
+  for (int k = r[2]; k <= r[3]; k++)
+    for (int i = r[0]; i <= r[1]; i++) {
+      const int b = bucketOf(bp, i, k);
+      for (int e = bp->cellStart[b]; e < bp->cellStart[b + 1]; e++) {
+        const int n = bp->cellItems[e];
+        if (bp->stamp[n] == bp->query) continue;
+        bp->stamp[n] = bp->query;
+        const float *box = bp->box + 6 * n;
+        if (max[0] < box[0] || min[0] > box[3] || max[1] < box[1] ||
+            min[1] > box[4] || max[2] < box[2] || min[2] > box[5])
+          continue;
+        if (found < maxOut) out[found] = n;
+        found++;
+      }
+    }
+  return found;
+}
@@ -0,0 +1,71 @@
+/*
+ *  Broadphase module - header file
+ *  Uniform hash grid over axis-aligned boxes, rebuilt (refit) every
+ *  simulation tick, so swept queries only see colliders in nearby cells
+ */
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+/*
+ *  Grid of collider boxes stored cell by cell (counting-sorted on build)
+ *  The XZ plane is split into square cells hashed into a fixed table, so
+ *  the world has no bounds; Y is only checked by the final box test.
+ */
+typedef struct {
+  double cell;         // Cell side in world units
+  int dim;             // Hash table is dim x dim cells (power of two)
+  int count;           // Boxes added since the last clear
+  int capacity;        // Maximum number of boxes
+  float *box;          // 6 floats per box: min xyz, max xyz
+  int *cellStart;      // dim*dim+1 offsets into cellItems
+  int *cellItems;      // Box indices grouped by cell
+  int itemCount;       // Entries in cellItems
+  int itemCapacity;    // Allocated entries in cellItems
+  unsigned int *stamp; // Per-box query stamp (reports each box once)
+  unsigned int query;  // Current query stamp
+} Broadphase;
+
+/*
+ *  Allocate an empty broadphase grid
+ *  @param bp grid to initialize
+ *  @param cellSize cell side in world units
+ *  @param capacity maximum number of boxes
+ *  @return 1 on success, 0 if allocation failed
+ */
+int initBroadphase(Broadphase *bp, double cellSize, int capacity);
+
+/*
+ *  Remove all boxes (start of a refit)
+ *  @param bp broadphase grid
+ */
+void broadphaseClear(Broadphase *bp);
+
+/*
+ *  Add a collider box
+ *  @param bp broadphase grid
+ *  @param min box minimum corner
+ *  @param max box maximum corner
+ *  @return box index (the caller's collider ID), or -1 if full
+ */
+int broadphaseAdd(Broadphase *bp, const double min[3], const double max[3]);
+
+/*
+ *  Sort the boxes added since the last clear into cells
+ *  @param bp broadphase grid
+ */
+void broadphaseBuild(Broadphase *bp);
+
+/*
+ *  Find boxes overlapping the bounds of a segment
+ *  @param bp broadphase grid
+ *  @param p0 segment start
+ *  @param p1 segment end
+ *  @param out box indices found (output)
+ *  @param maxOut size of out
+ *  @return number of overlapping boxes; only the first maxOut are written,
+ *          so a count above maxOut means out is incomplete
+ */
+int broadphaseQuerySegment(Broadphase *bp, const double p0[3],
+                           const double p1[3], int *out, int maxOut);
+
+#endif
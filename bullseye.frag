@@ -0,0 +1,66 @@
+#version 330 compatibility
+
+uniform int lit;          // Non-zero when fixed-function lighting is on
+uniform int fogEnabled;   // Non-zero when fog should be applied
+uniform int useTexture;   // Non-zero to modulate by the wood texture
+uniform sampler2D tex;    // Wood texture
+
+in vec3 eyePos;
+in vec3 eyeNormal;
+in vec2 local;
+in vec2 uv;
+in float face;
+flat in float rings;
+flat in vec3 ringColor;
+
+// Integral of the odd-ring indicator (1 on [1,2), [3,4), ...) from 0 to x
+float oddIntegral(float x)
+{
+   return floor(0.5 * x) + max(2.0 * fract(0.5 * x) - 1.0, 0.0);
+}
+
+void main()
+{
+   // Faces are quads: cut the exact circle
+   float r = length(local);
+   if (face > 0.5 && r > 1.0) discard;
+
+   // Ring index counted from the rim: t in [0, rings), even rings colored,
+   // odd rings white. Box-filtering the parity over the pixel's footprint
+   // keeps ring edges smooth at any distance.
+   vec3 base = ringColor;
+   if (face > 0.5)
+   {
+      float t = (1.0 - r) * rings;
+      float w = max(fwidth(t), 1e-4);
+      float odd = (oddIntegral(t + 0.5 * w) - oddIntegral(t - 0.5 * w)) / w;
+      base = mix(ringColor, vec3(1.0), clamp(odd, 0.0, 1.0));
+   }
+
+   // Blinn-Phong matching the fixed-function light 0 (one-sided; color
+   // material drives ambient and diffuse)
+   vec3 color = base;
+   if (lit != 0)
+   {
+      vec3 N = normalize(eyeNormal);
+      vec3 L = normalize(gl_LightSource[0].position.xyz - eyePos);
+      vec3 H = normalize(L - normalize(eyePos));
+      float Id = max(dot(N, L), 0.0);
+      float Is = (Id > 0.0) ? pow(max(dot(N, H), 0.0), gl_FrontMaterial.shininess) : 0.0;
+      color = base * (gl_LightModel.ambient.rgb + gl_LightSource[0].ambient.rgb +
+                      gl_LightSource[0].diffuse.rgb * Id) +
+              gl_FrontMaterial.specular.rgb * gl_LightSource[0].specular.rgb * Is;
+   }
+   // GL_MODULATE: the texture scales the (clamped) lit color
+   color = min(color, vec3(1.0));
+   if (useTexture != 0) color *= texture(tex, uv).rgb;
+
+   vec4 c = vec4(color, 1.0);
+   // Linear fog, same as the terrain shader
+   if (fogEnabled != 0)
+   {
+      float fogFactor = clamp((gl_Fog.end - length(eyePos)) * gl_Fog.scale, 0.0, 1.0);
+      c = mix(gl_Fog.color, c, fogFactor);
+   }
+   gl_FragColor = c;
+}
@@ -0,0 +1,40 @@
+#version 330 compatibility
+
+// Per-vertex: unit target mesh (faces are quads, the side a low-poly band)
+layout(location = 0) in vec3 vertex;   // x,y in radii, z = +/-1 (face side)
+layout(location = 1) in vec3 normal;   // Local normal
+layout(location = 2) in vec2 texCoord; // Wood texture coordinate
+// Per-instance (divisor 1)
+layout(location = 3) in vec4 instPos;   // Center, radius
+layout(location = 4) in vec4 instX;     // Local X axis, ring count
+layout(location = 5) in vec3 instN;     // Face normal (local Z)
+layout(location = 6) in vec3 instColor; // Color of the even rings
+
+const float halfThickness = 0.1; // Same as the immediate-mode target
+
+out vec3 eyePos;        // Eye-space position
+out vec3 eyeNormal;     // Eye-space normal
+out vec2 local;         // Position on the face in radii
+out vec2 uv;            // Wood texture coordinate
+out float face;         // 1 on the faces, 0 on the side
+flat out float rings;   // Ring count
+flat out vec3 ringColor;
+
+void main()
+{
+   // Frame from the table: X, Y = N x X, N
+   vec3 X = instX.xyz;
+   vec3 N = instN;
+   mat3 R = mat3(X, cross(N, X), N);
+   vec3 p = vec3(vertex.xy * instPos.w, vertex.z * halfThickness);
+
+   vec4 P = gl_ModelViewMatrix * vec4(instPos.xyz + R * p, 1.0);
+   gl_Position = gl_ProjectionMatrix * P;
+   eyePos = P.xyz;
+   eyeNormal = gl_NormalMatrix * (R * normal);
+   local = vertex.xy;
+   uv = texCoord;
+   face = abs(normal.z);
+   rings = instX.w;
+   ringColor = instColor;
+}
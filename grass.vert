@@ -0,0 +1,74 @@
+#version 330 compatibility
+
+// Per-vertex: one blade strip shared by every instance
+layout(location = 0) in vec2 blade;      // (side -1..1, height fraction 0..1)
+// Per-instance (divisor 1)
+layout(location = 1) in vec4 instPos;    // (x, y, z, blade height)
+layout(location = 2) in vec4 instParams; // (yaw, wind phase, tint, rank in chunk)
+
+uniform float time;       // Seconds, drives the wind sway
+uniform vec2 lodRange;    // Full density until x, no grass beyond y
+uniform float bladeWidth; // Half width at the root
+uniform sampler2DShadow shadowMap0; // Terrain shadow cascades, nearest first
+uniform sampler2DShadow shadowMap1;
+uniform sampler2DShadow shadowMap2;
+uniform mat4 shadowMatrix[3]; // World -> shadow map coordinates
+uniform int shadowCascades;   // Cascades in use (0 = no shadows)
+uniform float shadowMargin;   // Map border left to the next cascade
+
+out vec3 color;     // Lit blade color
+out float fogDist;  // Distance from eye for fog
+
+// Light reaching a point from the nearest shadow cascade that covers it
+float sunlight(vec3 w)
+{
+   vec3 lo = vec3(shadowMargin, shadowMargin, 0.0);
+   vec3 hi = vec3(1.0 - shadowMargin, 1.0 - shadowMargin, 1.0);
+   for (int i = 0; i < shadowCascades; i++)
+   {
+      vec3 s = (shadowMatrix[i] * vec4(w, 1.0)).xyz;
+      if (any(lessThan(s, lo)) || any(greaterThan(s, hi))) continue;
+      return i == 0 ? texture(shadowMap0, s) :
+             i == 1 ? texture(shadowMap1, s) : texture(shadowMap2, s);
+   }
+   return 1.0;
+}
+
+void main()
+{
+   // 1) Distance thinning, same curve as lodKeep() in grass.c:
+   //    blades ranked past the kept fraction shrink to nothing
+   vec3 root = instPos.xyz;
+   float dist = length((gl_ModelViewMatrix * vec4(root, 1.0)).xyz);
+   float keep = clamp((lodRange.y - dist) / (lodRange.y - lodRange.x), 0.0, 1.0);
+   keep *= keep;
+   float grow = clamp((keep - instParams.w) * 20.0, 0.0, 1.0);
+
+   // 2) Blade shape: taper to the tip, widen thinned blades to keep coverage
+   float h = instPos.w * grow;
+   float w = bladeWidth * grow * (1.0 - blade.y) * min(inversesqrt(max(keep, 0.01)), 3.0);
+   float s = sin(instParams.x);
+   float c = cos(instParams.x);
+   vec3 side = vec3(c, 0.0, -s);
+   vec3 face = vec3(s, 0.0, c);
+
+   // 3) Wind: a travelling wave, bend grows with height squared
+   float wave = sin(time * 1.7 + dot(root.xz, vec2(0.15, 0.05)) + 0.6 * instParams.y);
+   vec3 bend = vec3(0.8, 0.0, 0.25) * (0.15 + 0.3 * wave) * blade.y * blade.y * h;
+   vec3 p = root + side * (blade.x * w) + vec3(0.0, blade.y * h, 0.0) + bend;
+
+   // 4) Simple lighting with a mostly-up normal (blades read as a lawn,
+   //    not as flat cards) and a darker root for fake occlusion
+   vec4 P = gl_ModelViewMatrix * vec4(p, 1.0);
+   vec3 N = normalize(gl_NormalMatrix * normalize(vec3(0.0, 1.0, 0.0) + 0.3 * face));
+   vec3 L = normalize(gl_LightSource[0].position.xyz - P.xyz);
+   float Id = max(dot(N, L), 0.0);
+   //    Shadow at the root, so a blade is lit or shaded as a whole
+   if (Id > 0.0 && grow > 0.0) Id *= sunlight(root);
+   vec3 base = mix(vec3(0.10, 0.20, 0.05), vec3(0.42, 0.55, 0.18), blade.y);
+   base *= 0.75 + 0.5 * instParams.z;
+   color = base * (gl_LightSource[0].ambient.rgb + gl_LightSource[0].diffuse.rgb * Id);
+
+   fogDist = length(P.xyz);
+   gl_Position = gl_ProjectionMatrix * P;
+}
@@ -26,15 +26,50 @@
  *    o/O    Toggle texture filtering optimizations (mipmaps + anisotropy)
  *    f/F    Toggle distance fog
  *    b/B    Toggle normal-mapped rock mountains
+ *    t/T    Toggle tessellated terrain (OpenGL 4.0+)
+ *    v/V    Toggle virtual-textured mountain ring (OpenGL 3.0+)
+ *    g/G    Toggle instanced grass (OpenGL 3.3+)
+ *    r/R    Toggle rapid-fire stress mode (hold right-click to stream arrows)
+ *    p/P    Toggle the aim preview (predicted arc while charging a shot)
+ *    k/K    Toggle cached cascaded shadow maps (OpenGL 3.0+)
+ *
+ *  Command line:
+ *    --record FILE    Record input and the initial state to FILE
+ *    --replay FILE    Play FILE back and check the outcome (exit status 1
+ *                     if it differs)
+ *    --fast           With --replay: run the simulation as fast as possible
+ *    --headless       With --replay: no window, print the outcome and timing
+ *    --montecarlo N   Simulate N random shots without a window and print
+ *                     hit-probability and expected-score tables
+ *    --threads N      With --montecarlo: worker threads (default: one per CPU)
+ *    --seed N         With --montecarlo: random seed (default 1)
+ *    --targets FILE   Load the target layout from FILE (default targets.txt)
+ *    --telemetry FILE Log every shot, hit and miss to FILE (binary; convert
+ *                     with telemetry2csv)
+ *    --wind S         Mean wind speed in units per second (default 3, 0 for
+ *                     calm air)
  */
 //  Include custom modules
 #include "objects/arrow.h"
 #include "objects/bullseye.h"
+#include "objects/grass.h"
 #include "objects/ground.h"
 #include "objects/lighting.h"
+#include "objects/particles.h"
+#include "objects/trajectory.h"
 #include "objects/tree.h"
 #include "utils.h"
+#include "montecarlo.h"
+#include "replay.h"
+#include "scene.h"
+#include "scores.h"
+#include "shadow.h"
+#include "sky.h"
+#include "telemetry.h"
 #include "view.h"
+#include "vtex.h"
+#include "wind.h"
+#include <time.h>
 
 //  Global state variables
 // View parameters
@@ -57,14 +92,35 @@ int lastX = 0, lastY = 0;       // last mouse position
 double mouseSensitivity = 0.15; // degrees per pixel (lower for smoother feel)
 // Bullseye motion
 double zhTargets = 0;     // Animation angle for bullseye motion (degrees)
+double prevZhTargets = 0; // zhTargets at the previous simulation tick
+// Target poses at the previous and current tick (built once per tick)
+TargetTable targetTables[2];
+TargetTable *targetsPrev = &targetTables[0];
+TargetTable *targetsNow = &targetTables[1];
 double targetRate = 90.0; // Default target motion speed (degrees per second)
 // Trees animation (wind sway)
 double zhTrees = 0; // Animation angle for tree sway (degrees)
+double prevZhTrees = 0; // zhTrees at the previous simulation tick
+// Wind (gusts drift over the scene, sway trees and push arrows)
+double windSpeed = 3.0;  // Mean wind speed (units per second)
+double arrowDrag = 0.1;  // Arrow drag rate (1/s)
+WindField wind;
 // Arrow state
-// Arrow state
-#define MAX_ARROWS 15
-Arrow arrows[MAX_ARROWS]; // Array of arrows
-double chargeStartTime = 0; // Time when right click started
+#define MAX_ARROWS 15           // Arrows per round
+#define RAPID_FIRE_RATE 240.0   // Arrows per second in rapid-fire mode
+ArrowPool arrowPool;            // All flying and stuck arrows
+ParticlePool particles;         // Arrow trails, splinters and dust (visual only)
+// Scene graph: one node per target, stuck arrows are children of theirs
+SceneGraph scene;
+int targetNodes[TARGET_TABLE_MAX];
+// Trees around the range, planted once at startup
+#define FOREST_CAPACITY 256 // Most trees
+Forest forest;
+double chargeStartTime = 0; // Simulation time when right click started
+int charging = 0;           // 1 while the right button charges a shot
+int rapidFire = 0;          // Rapid-fire stress mode (unlimited, unscored)
+int showPreview = 1;        // Draw the predicted arc while charging
+Trajectory preview;         // Cached aim preview
 //  Lighting
 int light = 1;           // Lighting toggle
 double ylight = 12.0;     // Elevation of the light
@@ -73,8 +129,11 @@ double ldist = 24.0;     // Light distance from origin in XZ plane
 int fog = 1;             // Fog toggle (1=enabled, 0=disabled)
 //  Day/Night Cycle
 double dayNightCycle = 0.0;   // 0.0-1.0: 0 and 1 are noon, 0.5 is midnight
+double prevDayNightCycle = 0.0; // dayNightCycle at the previous simulation tick
 double cycleRate = 0.05;      // cycle speed (cycles per second) = 20 second full cycle
 int moveCycle = 1;            // Toggle day/night cycle motion
+SkyLuts sky;                  // Precomputed atmosphere
+SkyView skyView;              // Sky for this frame's sun (sky and fog color)
 //  Textures
 int textureOptimizations = 1; //  Texture filtering mode: 1=optimized, 0=basic
 int anisoSupported = 0;
@@ -88,11 +147,46 @@ unsigned int woodTexture = 0;           // Wood texture ID for bullseyes
 unsigned int barkTexture = 0;           // Bark texture ID for trees
 unsigned int leafTexture = 0;           // Leaf texture ID for tree foliage
 unsigned int terrainShaderProg = 0;     // Shader program for terrain normal mapping
+unsigned int terrainTessProg = 0;       // Tessellated terrain program (0 if unsupported)
+unsigned int terrainTessDepthProg = 0;  // Tessellated terrain, depth only (shadows)
+int useTerrainTess = 1;                 // Toggle hardware-tessellated terrain
+unsigned int terrainFeedbackProg = 0;   // Virtual texture feedback (mesh path)
+unsigned int terrainTessFeedbackProg = 0; // Virtual texture feedback (tessellated path)
+int virtualTextureAvailable = 0;        // Virtual texture created (OpenGL 3.0+)
+int useVirtualTexture = 1;              // Toggle virtual-textured mountain ring
+unsigned int grassProg = 0;             // Instanced grass program (0 if unsupported)
+unsigned int arrowProg = 0;             // Instanced arrow program (0 if unsupported)
+unsigned int bullseyeProg = 0;          // Instanced target program (0 if unsupported)
+unsigned int particleProg = 0;          // Point-sprite particle program (0 if unsupported)
+unsigned int skyProg = 0;               // Full-screen sky program (0 if unsupported)
+int useGrass = 1;                       // Toggle instanced grass
+int shadowsAvailable = 0;               // Shadow maps created (OpenGL 3.0+)
+int useShadows = 1;                     // Toggle cached shadow maps
+//  Terrain layout: forest island + surrounding mountain ring
+const double groundSize = 45.0;  // Island radius
+const double groundY = -3.0;     // Base height of the terrain
+const double overlap = 5.0;      // Amount to sink mountains into the ground
+const double ringOuterR = 200.0; // Outer radius of the mountain ring
 // Game State
 int score = 0;
-int arrowsLeft = 15;
+int arrowsLeft = MAX_ARROWS;
 int highScore = 0;
 int gameOver = 0;
+int arrowsFired = 0; // Arrows shot this session (replay check)
+int arrowHits = 0;   // Arrows that hit a target this session (replay check)
+int roundHits = 0;      // Scored hits this round
+int roundStartTick = 0; // Tick the round started
+Leaderboard leaderboard; // Best rounds (saved by the score writer)
+// Fixed-timestep simulation
+#define SIM_DT (1.0 / 120.0) // Simulation step (seconds)
+#define SIM_MAX_FRAME 0.25   // Longest frame fed to the accumulator (seconds)
+double simAlpha = 0.0;       // Render position between the last two ticks (0-1)
+int simTicks = 0;            // Simulation ticks run (input events are stamped with it)
+unsigned int simSeed = 1;    // Seed for simulation randomness (recorded in replays)
+// Replay playback
+int headless = 0;            // Replay without a window or GL context
+int replayFast = 0;          // Replay as fast as possible instead of real time
+double frameTime = 0.0;      // Length of the last frame (seconds, telemetry)
 // FPS tracking
 double fps = 0.0;         // Current frames per second
 int frameCount = 0;       // Frame counter for FPS calculation
@@ -100,28 +194,37 @@ double lastFPSTime = 0.0; // Last time FPS was calculated
 //  Debug helpers
 
 /*
- *  Load high score from file
+ *  Load the leaderboard and start its background writer (replays only read
+ *  it, so they never overwrite the player's scores)
  */
 void loadHighScore() {
-  FILE *f = fopen("highscore.txt", "r");
-  if (f) {
-    // Read a single integer; if it fails, reset highScore to 0
-    if (fscanf(f, "%d", &highScore) != 1) highScore = 0;
-    fclose(f);
-  }
+  loadLeaderboard(SCORE_FILE, &leaderboard);
+  highScore = leaderboard.best;
+  if (isReplaying()) return;
+  if (startScoreWriter(SCORE_FILE, &leaderboard))
+    atexit(stopScoreWriter);
+  else
+    fprintf(stderr, "Cannot start the score writer; scores won't be saved\n");
 }
 
 /*
- *  Save high score to file
+ *  Raise the high score (the writer saves it; nothing here touches disk)
  */
-void saveHighScore() {
-  // Open (or create) the high score file for writing (overwrite mode)
-  FILE *f = fopen("highscore.txt", "w");
-  if (f) {
-    // Write the current highScore value as an integer
-    fprintf(f, "%d", highScore);
-    fclose(f);
-  }
+void updateHighScore() {
+  if (score <= highScore) return;
+  highScore = score;
+  postHighScore(score);
+}
+
+/*
+ *  Put the round that just ended on the leaderboard
+ */
+void finishRound() {
+  ScoreEntry round = {score, MAX_ARROWS - arrowsLeft, roundHits,
+                      simTicks - roundStartTick, (long long)time(NULL)};
+  updateHighScore();
+  recordRound(&leaderboard, &round);
+  postRound(&round);
 }
 
 /*
@@ -164,6 +267,26 @@ void applyTextureFiltering(unsigned int texture) {
   }
 }
 
+/*
+ *  Ask GLUT for a redraw after input (no-op in a headless replay, where
+ *  there is no window or GL context)
+ *  @param reproject 1 to also update the projection
+ */
+void redraw(int reproject) {
+  if (headless) return;
+  if (reproject) Project(mode, fov, asp, dim);
+  glutPostRedisplay();
+}
+
+/*
+ *  Aim preview is shown while a scored shot is being charged
+ *  @return 1 if the preview is drawn this frame
+ */
+int aimPreviewActive() {
+  return showPreview && mode == 2 && charging && !rapidFire && !gameOver &&
+         arrowsLeft > 0;
+}
+
 /*
  *  Draw HUD with controls and status information
  *  Mode 0: Just hint to press H
@@ -213,9 +336,14 @@ void drawHUD() {
   // Special Controls (combined)
   yTop -= 15;
   glWindowPos2i(5, yTop);
-  Print("  Special: O)TexOpt %s  F)Fog  B)Ground+Rocks NM %s",
+  Print("  Special: O)TexOpt %s  F)Fog  B)Ground+Rocks NM %s  T)Tess %s  V)VirtTex %s  G)Grass %s  K)Shadows %s  R)Rapid %s  P)Preview %s",
         textureOptimizations ? "On" : "Off",
-        (useTerrainNormalMap && terrainShaderProg) ? "On" : "Off");
+        (useTerrainNormalMap && terrainShaderProg) ? "On" : "Off",
+        !terrainTessProg ? "N/A" : useTerrainTess ? "On" : "Off",
+        !virtualTextureAvailable ? "N/A" : useVirtualTexture ? "On" : "Off",
+        !grassProg ? "N/A" : useGrass ? "On" : "Off",
+        !shadowsAvailable ? "N/A" : useShadows ? "On" : "Off",
+        rapidFire ? "On" : "Off", showPreview ? "On" : "Off");
 
   // Mode 2 only: Show status info (at bottom of screen)
   if (showHUD == 2) {
@@ -240,8 +368,14 @@ void drawHUD() {
     // Debug status line
     yBottom += 15;
     glWindowPos2i(5, yBottom);
-    Print("TexOpt: %s | FPS: %.1f",
-          textureOptimizations ? "On" : "Off", fps);
+    int vtResident, vtCapacity, grassTotal;
+    virtualTextureResidency(&vtResident, &vtCapacity);
+    int grassDrawn = grassBladesDrawn(&grassTotal);
+    Print("TexOpt: %s | VT pages: %d/%d | Grass: %d/%d | Arrows: %d/%d | "
+          "Particles: %d | Shadow redraws: %d | FPS: %.1f",
+          textureOptimizations ? "On" : "Off", vtResident, vtCapacity,
+          grassDrawn, grassTotal, arrowPool.live, arrowPool.capacity,
+          particles.count, shadowRedraws(), fps);
   }
 
   // Game Stats (Always visible in top right or center)
@@ -258,6 +392,13 @@ void drawHUD() {
       Print("High Score: %d", highScore);
       glWindowPos2i(w - 220, h - 45);
       Print("Press '0' to Restart");
+      // Best rounds so far (the one just played is already in)
+      for (int k = 0; k < leaderboard.count && k < 5; k++) {
+        const ScoreEntry *e = &leaderboard.top[k];
+        glWindowPos2i(w - 220, h - 70 - 15 * k);
+        Print("%d. %d pts  %d/%d hits  %.0fs", k + 1, e->score, e->hits,
+              e->fired, e->ticks * SIM_DT);
+      }
   } else {
       glColor3f(1, 1, 0); // Yellow
       glWindowPos2i(w - 150, h - 15);
@@ -265,7 +406,23 @@ void drawHUD() {
       glWindowPos2i(w - 150, h - 30);
       Print("High Score: %d", highScore);
       glWindowPos2i(w - 150, h - 45);
-      Print("Arrows: %d", arrowsLeft);
+      if (rapidFire)
+        Print("Rapid fire: %d", arrowPool.live);
+      else
+        Print("Arrows: %d", arrowsLeft);
+      // Wind where the shooter stands: speed and the heading it blows toward
+      double wv[2];
+      sampleWind(&wind, px, pz, wv);
+      glWindowPos2i(w - 150, h - 60);
+      Print("Wind: %.1f @ %.0f", Vec3Length(wv[0], 0.0, wv[1]),
+            fmod(atan2(wv[1], wv[0]) * 180.0 / M_PI + 360.0, 360.0));
+      if (aimPreviewActive()) {
+        glWindowPos2i(w - 150, h - 75);
+        if (preview.hitKind == TRAJ_TARGET)
+          Print("Aim: %d pts", preview.hit.score);
+        else
+          Print("Aim: %s", preview.hitKind == TRAJ_GROUND ? "ground" : "miss");
+      }
   }
 }
 
@@ -280,9 +437,8 @@ void drawCrosshair() {
 
   // Calculate charge
   double charge = 0.0;
-  if (chargeStartTime > 0) {
-    double now = glutGet(GLUT_ELAPSED_TIME) / 1000.0;
-    double duration = now - chargeStartTime;
+  if (charging) {
+    double duration = (simTicks + simAlpha) * SIM_DT - chargeStartTime;
     if (duration > 1.0)
       duration = 1.0;
     charge = duration;
@@ -329,12 +485,43 @@ void drawCrosshair() {
   glLineWidth(1.0);
 }
 
+/*
+ *  Direction toward the sun for the sky and fog
+ *  The sun follows the light's azimuth. Its elevation is the light's as
+ *  seen from the center at noon and swings below the horizon at night, so
+ *  it sets when the light turns into the moon.
+ *  @param cycle day/night cycle position (0-1)
+ *  @param sun unit direction (output)
+ */
+void sunDirection(double cycle, double sun[3]) {
+  double zhLight = cycle * 360.0 * 4.0;
+  double el = atan2(ylight, ldist) * 180.0 / M_PI * Cos(cycle * 360.0);
+  sun[0] = Cos(el) * Cos(zhLight);
+  sun[1] = Sin(el);
+  sun[2] = Cos(el) * Sin(zhLight);
+}
+
+/*
+ *  Position of the sun/moon light (GL_LIGHT0) in world space
+ *  4 full rotations per complete cycle (2 during day, 2 during night)
+ *  @param cycle day/night cycle position (0-1)
+ *  @param pos homogeneous light position (output)
+ */
+void lightPosition(double cycle, float pos[4]) {
+  double zhLight = cycle * 360.0 * 4.0;
+  pos[0] = ldist * Cos(zhLight);
+  pos[1] = ylight;
+  pos[2] = ldist * Sin(zhLight);
+  pos[3] = 1.0;
+}
+
 /*
  *  Enable lighting with moving light position
+ *  @param cycle day/night cycle position (0-1) to light the frame with
  */
-void enableLighting() {
+void enableLighting(double cycle) {
   // Calculate day factor: 1.0 = full day, 0.0 = full night
-  double dayFactor = (Cos(dayNightCycle * 360.0) + 1.0) / 2.0;
+  double dayFactor = (Cos(cycle * 360.0) + 1.0) / 2.0;
   int isDay = dayFactor > 0.5 ? 1 : 0;
 
   // Interpolate light intensities based on time of day
@@ -353,10 +540,8 @@ void enableLighting() {
   float Specular[] = {0.5, 0.5, 0.5, 1.0};
 
   // Calculate light position from day/night cycle
-  // 4 full rotations per complete cycle (2 during day, 2 during night)
-  double zhLight = dayNightCycle * 360.0 * 4.0;
-  float Position[] = {(ldist * Cos(zhLight)), ylight, (ldist * Sin(zhLight)),
-                      1.0};
+  float Position[4];
+  lightPosition(cycle, Position);
 
   // Draw light position as sun or moon
   drawLightBall(Position[0], Position[1], Position[2], 0.15, isDay);
@@ -382,34 +567,18 @@ void enableLighting() {
 /*
  *  Enable distance fog to blend object color with the background
  *  Uses linear fog based on distance from the viewer.
+ *  @param cycle day/night cycle position (0-1) for the fog distance
+ *  @param view sky for the frame (colors the fog)
  */
-void enableFog() {
+void enableFog(double cycle, const SkyView *view) {
   glEnable(GL_FOG);
 
-  // Fog color roughly matches sky/horizon color and changes with time of day
-  double dayFactor = (Cos(dayNightCycle * 360.0) + 1.0) / 2.0; // 0=night,1=day
-
-  // Day and night horizon-like colors (averaged from sky top/bottom)
-  float dayFogTop[3] = {0.4f, 0.6f, 0.9f};
-  float dayFogBot[3] = {0.7f, 0.85f, 1.0f};
-  float nightFogTop[3] = {0.05f, 0.05f, 0.15f};
-  float nightFogBot[3] = {0.1f, 0.1f, 0.25f};
-
-  // Define average fog colors for day and night
-  float dayFog[3] = {
-      (dayFogTop[0] + dayFogBot[0]) * 0.5f,
-      (dayFogTop[1] + dayFogBot[1]) * 0.5f,
-      (dayFogTop[2] + dayFogBot[2]) * 0.5f};
-  float nightFog[3] = {
-      (nightFogTop[0] + nightFogBot[0]) * 0.5f,
-      (nightFogTop[1] + nightFogBot[1]) * 0.5f,
-      (nightFogTop[2] + nightFogBot[2]) * 0.5f};
-
-  float fogColor[4];
-  for (int i = 0; i < 3; ++i) {
-    fogColor[i] = nightFog[i] + dayFactor * (dayFog[i] - nightFog[i]);
-  }
-  fogColor[3] = 1.0f;
+  // Fog color is the sky at the horizon straight ahead (the same table
+  // lookup the sky pass does), so fogged terrain fades into the sky
+  double dayFactor = (Cos(cycle * 360.0) + 1.0) / 2.0; // 0=night,1=day
+  double ahead[3] = {Sin(th), 0, -Cos(th)};
+  float fogColor[4] = {0, 0, 0, 1};
+  skyColor(view, ahead, fogColor);
 
   glFogfv(GL_FOG_COLOR, fogColor);
   glFogi(GL_FOG_MODE, GL_LINEAR);
@@ -431,6 +600,65 @@ void enableFog() {
   glHint(GL_FOG_HINT, GL_NICEST);
 }
 
+/*
+ *  Interpolate a wrapping quantity (angle, cycle) that only moves forward
+ *  @param a value at the previous tick
+ *  @param b value at the current tick
+ *  @param t blend factor (0-1)
+ *  @param period wrap period (360 for degrees, 1 for the day cycle)
+ */
+double lerpWrap(double a, double b, double t, double period) {
+  if (b < a) b += period;
+  return fmod(a + (b - a) * t, period);
+}
+
+/*
+ *  Draw the splatted terrain (island + mountain ring) with a bound program
+ *  @param prog terrain splat or virtual texture feedback program
+ *  @param tess 1 for tessellated patches, 0 for the cached mesh
+ */
+void drawSplatTerrain(unsigned int prog, int tess) {
+  if (tess)
+    drawTerrainTess(0.5, groundSize, groundSize - overlap, ringOuterR, groundY,
+                    32.0, prog);
+  else
+    drawTerrain(0.5, groundSize, groundSize - overlap, ringOuterR, groundY,
+                32.0, prog);
+}
+
+/*
+ *  Draw the casters cached in the static shadow maps: terrain and trees
+ *  (posed as they are when the cascade is re-rendered)
+ *  @param zhW tree sway angle
+ */
+void drawStaticShadowCasters(double zhW) {
+  // The terrain casts from the surface it is drawn with: tessellated from
+  // the heightmap, or the cached mesh when tessellation is off
+  if (useTerrainTess && terrainTessDepthProg) {
+    glUseProgram(terrainTessDepthProg);
+    drawSplatTerrain(terrainTessDepthProg, 1);
+    glUseProgram(0);
+  } else
+    drawSplatTerrain(0, 0);
+  drawTreeScene(&forest, zhW, &wind, 0, 0);
+  // Leaves cut out by their alpha, as in the transparent pass
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, leafTexture);
+  glEnable(GL_ALPHA_TEST);
+  glAlphaFunc(GL_GREATER, 0.1f);
+  drawTreeLeaves(&forest, zhW, &wind, leafTexture);
+}
+
+/*
+ *  Draw the casters added to the shadow maps every frame: targets and
+ *  arrows
+ *  @param targets interpolated targets for this frame
+ */
+void drawDynamicShadowCasters(const TargetTable *targets) {
+  drawBullseyeScene(targets, 0, bullseyeProg);
+  drawArrows(&arrowPool, simAlpha, arrowProg);
+}
+
 /*
  *  OpenGL (GLUT) calls this routine to display the scene
  */
@@ -438,86 +666,137 @@ void display() {
   //  Erase the window and the depth buffer
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  // Configure distance fog (color based on day/night)
-  if (fog) enableFog();
+  // Render state interpolated between the last two simulation ticks
+  double cycle = lerpWrap(prevDayNightCycle, dayNightCycle, simAlpha, 1.0);
+  static TargetTable targetsDrawn;
+  lerpTargetTable(targetsPrev, targetsNow, simAlpha, &targetsDrawn);
+  // Only targets that moved (and the arrows stuck in them) are re-posed
+  poseTargetNodes(&scene, targetNodes, &targetsDrawn);
+  updateSceneGraph(&scene);
+  double zhW = lerpWrap(prevZhTrees, zhTrees, simAlpha, 360.0);
+
+  // Sky for this frame's sun: the sky pass and the fog color read it
+  double sun[3];
+  sunDirection(cycle, sun);
+  updateSkyView(&sky, sun, &skyView);
+
+  // Configure distance fog (color from the sky at the horizon)
+  if (fog) enableFog(cycle, &skyView);
   else glDisable(GL_FOG);
 
-  // Draw sky background first (before any transformations)
-  drawSky(dayNightCycle);
-
   //  Undo previous transformations
   glLoadIdentity();
   //  Set camera/view
   setViewMode(mode, th, ph, dim, px, py, pz);
+
+  // Draw sky background first (it follows the camera)
+  drawSky(&skyView, skyProg);
+
   //  Enable Z-buffering
   glEnable(GL_DEPTH_TEST);
   //  Use smooth shading
   glShadeModel(GL_SMOOTH);
 
   // Lighting setup
-  if (light) enableLighting();
+  if (light) enableLighting(cycle);
   else glDisable(GL_LIGHTING);
 
+  // Splatted terrain path (its shaders and the grass receive shadows)
+  int splat = useTerrainNormalMap && terrainShaderProg && groundTexture &&
+              groundNormalTexture && mountainTexture && mountainNormalTexture;
+
+  // Shadow maps: re-render at most one stale cascade of the cached static
+  // scene, then add the moving casters to every cascade
+  int shadows = 0;
+  if (splat && light && useShadows && shadowsAvailable) {
+    float lightPos[4];
+    lightPosition(cycle, lightPos);
+    shadows = updateShadows(lightPos);
+    if (shadows && beginStaticShadow()) {
+      drawStaticShadowCasters(zhW);
+      endShadowPass();
+    }
+    for (int c = 0; shadows && c < SHADOW_CASCADES; c++) {
+      if (!beginDynamicShadow(c)) continue;
+      drawDynamicShadowCasters(&targetsDrawn);
+      endShadowPass();
+    }
+  }
+
   // ===== OPAQUE PASS: Draw all opaque objects first =====
   glDepthMask(GL_TRUE);
   glDisable(GL_BLEND);
 
   // Draw bullseyes (animated)
-  drawBullseyeScene(zhTargets, woodTexture);
+  drawBullseyeScene(&targetsDrawn, woodTexture, bullseyeProg);
 
   // Enable back-face culling for terrain and trees, then disable for arrows
   glEnable(GL_CULL_FACE);
 
   // Terrain: ground + surrounding mountain ring
-  const double groundSize = 45.0;
-  const double groundY = -3.0;
-  const double overlap = 5.0; // amount to sink mountains into the ground
+  if (splat) {
+    // Single-pass splat path: ground + mountains are one mesh (tessellated
+    // patches when supported, a cached display list otherwise)
+    int tess = useTerrainTess && terrainTessProg;
+    unsigned int prog = tess ? terrainTessProg : terrainShaderProg;
+
+    // Virtual texture: draw page IDs into a small target every few frames,
+    // then stream the pages it asked for (within the upload budget)
+    int vt = useVirtualTexture && virtualTextureAvailable;
+    if (vt) {
+      unsigned int fbProg = tess ? terrainTessFeedbackProg : terrainFeedbackProg;
+      if (fbProg && beginVirtualTextureFeedback()) {
+        glUseProgram(fbProg);
+        setVirtualTextureFeedbackUniforms(fbProg);
+        drawSplatTerrain(fbProg, tess);
+        endVirtualTextureFeedback();
+      }
+      updateVirtualTexture();
+    }
 
-  if (useTerrainNormalMap && terrainShaderProg &&
-      groundTexture && groundNormalTexture &&
-      mountainTexture && mountainNormalTexture) {
-    // Normal-mapped path for both ground and mountains
-    glUseProgram(terrainShaderProg);
+    glUseProgram(prog);
+    bindVirtualTexture(prog, vt);
+    bindShadows(prog, shadows);
 
     // Keep fogEnabled uniform in sync with global fog toggle
-    GLint fogLoc = glGetUniformLocation(terrainShaderProg, "fogEnabled");
+    GLint fogLoc = glGetUniformLocation(prog, "fogEnabled");
     if (fogLoc >= 0) glUniform1i(fogLoc, fog ? 1 : 0);
 
-    // Ground (color in unit 0, normals in unit 1)
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, groundTexture);
+    // Bind both layers once: ground in units 0/1, rock in units 3/4
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, groundNormalTexture);
-    glActiveTexture(GL_TEXTURE0);
-    drawGround(0.5, groundSize, groundY, groundTexture);
-
-    // Mountain ring
-    glActiveTexture(GL_TEXTURE0);
+    glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, mountainTexture);
-    glActiveTexture(GL_TEXTURE1);
+    glActiveTexture(GL_TEXTURE4);
     glBindTexture(GL_TEXTURE_2D, mountainNormalTexture);
     glActiveTexture(GL_TEXTURE0);
-    drawMountainRing(groundSize - overlap, 200.0, groundY, mountainTexture, 32.0);
+    glBindTexture(GL_TEXTURE_2D, groundTexture);
+
+    drawSplatTerrain(prog, tess);
 
     // Restore fixed-function pipeline
     glUseProgram(0);
   } else {
     // Fixed-function fallback (no normal mapping)
     drawGround(0.5, groundSize, groundY, groundTexture);
-    drawMountainRing(groundSize - overlap, 200.0, groundY, mountainTexture, 32.0);
+    drawMountainRing(groundSize - overlap, ringOuterR, groundY, mountainTexture,
+                     32.0);
   }
 
+  // Ground cover: instanced grass on the island (needs the terrain above)
+  if (useGrass && grassProg) {
+    glUseProgram(grassProg);
+    bindShadows(grassProg, shadows);
+    drawGrass(groundSize - overlap, glutGet(GLUT_ELAPSED_TIME) / 1000.0,
+              grassProg);
+  }
 
   // Draw tree trunks and branches (opaque, uses bark texture)
-  drawTreeScene(zhTrees, barkTexture, 0);
+  drawTreeScene(&forest, zhW, &wind, barkTexture, 0);
   glDisable(GL_CULL_FACE); // Disable culling for arrows
 
-  // Draw Arrows
-  for (int i = 0; i < MAX_ARROWS; i++) {
-    if (arrows[i].active) {
-      drawArrow(&arrows[i]);
-    }
-  }
+  // Draw Arrows (flying: between ticks, stuck: on the interpolated target)
+  drawArrows(&arrowPool, simAlpha, arrowProg);
 
   // ===== TRANSPARENT PASS: Draw all transparent objects last =====
   glEnable(GL_BLEND);
@@ -529,10 +808,22 @@ void display() {
   glBindTexture(GL_TEXTURE_2D, leafTexture);
   glEnable(GL_ALPHA_TEST);
   glAlphaFunc(GL_GREATER, 0.1f);
-  drawTreeLeaves(zhTrees, leafTexture);
+  drawTreeLeaves(&forest, zhW, &wind, leafTexture);
   glDisable(GL_ALPHA_TEST);
   glDisable(GL_TEXTURE_2D);
 
+  // Particles (trails, splinters, dust) in one draw
+  drawParticles(&particles, simAlpha, particleProg);
+
+  // Predicted arc of the shot being charged: the launch a release would
+  // use now (tick-based charge), recomputed only when it or the targets move
+  if (aimPreviewActive()) {
+    updateTrajectory(&preview, px, py, pz, th, ph,
+                     chargeSpeed(simTicks * SIM_DT - chargeStartTime), &wind,
+                     zhTargets, targetRate);
+    drawTrajectory(&preview);
+  }
+
   // Restore render state
   glDepthMask(GL_TRUE);
   glDisable(GL_BLEND);
@@ -576,8 +867,7 @@ void specialDown(int key, int x, int y) {
     else if (ph < 0.0)
       ph += 360.0;
     //  Reproject and redraw
-    Project(mode, fov, asp, dim);
-    glutPostRedisplay();
+    redraw(1);
   }
 }
 
@@ -606,12 +896,12 @@ void key(unsigned char ch, int x, int y) {
     
     // Reset Game State
     score = 0;
-    arrowsLeft = 15;
+    arrowsLeft = MAX_ARROWS;
     gameOver = 0;
-    for (int i = 0; i < MAX_ARROWS; i++) {
-      arrows[i].active = 0;
-      arrows[i].stuck = 0;
-    }
+    roundHits = 0;
+    roundStartTick = simTicks;
+    clearArrowPool(&arrowPool);
+    clearParticlePool(&particles);
   }
   //  Movement keys (first-person only): set pressed flags for smooth motion
   else if (mode == 2 && (ch == 'w' || ch == 'W' || ch == 'a' || ch == 'A' ||
@@ -717,10 +1007,33 @@ void key(unsigned char ch, int x, int y) {
   else if (ch == 'b' || ch == 'B') {
     useTerrainNormalMap = 1 - useTerrainNormalMap;
   }
-  //  Update projection
-  Project(mode, fov, asp, dim);
-  //  Tell GLUT it is necessary to redisplay the scene
-  glutPostRedisplay();
+  //  Toggle hardware-tessellated terrain
+  else if (ch == 't' || ch == 'T') {
+    useTerrainTess = 1 - useTerrainTess;
+  }
+  //  Toggle virtual-textured mountain ring
+  else if (ch == 'v' || ch == 'V') {
+    useVirtualTexture = 1 - useVirtualTexture;
+  }
+  //  Toggle rapid-fire stress mode
+  else if (ch == 'r' || ch == 'R') {
+    rapidFire = 1 - rapidFire;
+    charging = 0;
+  }
+  //  Toggle instanced grass
+  else if (ch == 'g' || ch == 'G') {
+    useGrass = 1 - useGrass;
+  }
+  //  Toggle the aim preview
+  else if (ch == 'p' || ch == 'P') {
+    showPreview = 1 - showPreview;
+  }
+  //  Toggle cached shadow maps
+  else if (ch == 'k' || ch == 'K') {
+    useShadows = 1 - useShadows;
+  }
+  //  Update projection and redisplay the scene
+  redraw(1);
 }
 
 /*
@@ -753,84 +1066,181 @@ void reshape(int width, int height) {
 }
 
 /*
- *  GLUT calls this routine when there is nothing else to do
- *  Animate side-to-side motion by advancing zh
+ *  Particle effects for one arrow this tick
+ *  Particles are visual only (the simulation never reads them), so headless
+ *  replays skip them.
+ *  @param a arrow after its collision check
+ *  @param slot pool slot (staggers trail puffs between arrows)
+ *  @param hit 1 if the arrow just stuck in a target
  */
-void idle() {
-  static double lastT = 0.0;
-  double t = glutGet(GLUT_ELAPSED_TIME) / 1000.0;
-  if (lastT == 0.0) {
-    lastT = t;
-    lastFPSTime = t;
+static void arrowEffects(const Arrow *a, int slot, int hit) {
+  if (headless) return;
+  // (x,y,z) is the tail
+  const double tx = a->x + a->dx * ARROW_LENGTH,
+               ty = a->y + a->dy * ARROW_LENGTH,
+               tz = a->z + a->dz * ARROW_LENGTH;
+  // Splinters thrown back toward the shooter
+  if (hit) {
+    emitParticles(&particles, PARTICLE_SPLINTER, tx, ty, tz, -a->dx, -a->dy,
+                  -a->dz, 24);
+    return;
   }
-  double dt = t - lastT;
-  lastT = t;
+  // Trail: a puff from the fletching every other tick
+  if (((simTicks + slot) & 1) == 0)
+    emitParticles(&particles, PARTICLE_TRAIL, a->x, a->y, a->z, 0, 0, 0, 1);
+  // Dust where the tip goes into the ground
+  const double ground = terrainHeightAt(tx, tz);
+  if (ty <= ground && a->prevY + a->dy * ARROW_LENGTH > ground)
+    emitParticles(&particles, PARTICLE_DUST, tx, ground, tz, 0, 1, 0, 16);
+}
 
-  // Calculate FPS every 0.5 seconds
-  frameCount++;
-  if (t - lastFPSTime >= 0.5) {
-    fps = frameCount / (t - lastFPSTime);
-    frameCount = 0;
-    lastFPSTime = t;
+/*
+ *  Jump the targets to an angle (no motion between the last two ticks)
+ *  @param zh animation angle (degrees)
+ */
+void setTargetAngle(double zh) {
+  zhTargets = prevZhTargets = zh;
+  updateTargetTable(targetsPrev, zh);
+  updateTargetTable(targetsNow, zh);
+}
+
+/*
+ *  Fire an arrow from the camera, making room in a full pool by removing
+ *  the arrow that has been stuck the longest
+ *  @param sth aim azimuth (degrees)
+ *  @param sph aim elevation (degrees)
+ *  @param speed launch speed
+ *  @return pool slot, or -1 if every slot holds an arrow in flight
+ */
+int fireArrow(double sth, double sph, double speed) {
+  int slot = spawnArrow(&arrowPool, px, py, pz, sth, sph, speed);
+  if (slot < 0 && evictStuckArrow(&arrowPool))
+    slot = spawnArrow(&arrowPool, px, py, pz, sth, sph, speed);
+  return slot;
+}
+
+/*
+ *  Log a released arrow for telemetry (no-op unless --telemetry is on)
+ *  @param slot pool slot the arrow went into
+ *  @param charge charge time (seconds)
+ *  @param speed launch speed
+ *  @param sth aim azimuth (degrees)
+ *  @param sph aim elevation (degrees)
+ *  @param flags TELEMETRY_RAPID for rapid-fire arrows
+ */
+void logShot(int slot, double charge, double speed, double sth, double sph,
+             int flags) {
+  TelemetryEvent ev = {.tick = simTicks, .flags = flags,
+                       .charge = charge, .speed = speed, .th = sth, .ph = sph,
+                       .frameMs = 1000.0 * frameTime, .x = px, .y = py, .z = pz};
+  logTelemetryShot(slot, &ev);
+}
+
+/*
+ *  Log the end of an arrow's flight for telemetry
+ *  @param slot pool slot of the arrow
+ *  @param a the arrow (stuck in its target for a hit)
+ *  @param hitScore points for a hit, 0 for a miss
+ */
+void logShotEnd(int slot, const Arrow *a, int hitScore) {
+  TelemetryEvent ev = {.kind = hitScore > 0 ? TELEMETRY_HIT : TELEMETRY_MISS,
+                       .tick = simTicks, .x = a->x, .y = a->y, .z = a->z};
+  if (hitScore > 0) {
+    ev.target = a->stuckTargetIndex;
+    ev.ring = a->stuckRing;
+    ev.score = hitScore;
   }
+  logTelemetryEnd(slot, &ev);
+}
 
-  // First-person: update movement from WASD continuously
+/*
+ *  Advance the simulation by one fixed tick
+ *  Camera movement, targets, trees, the day cycle, arrow physics and
+ *  collisions all step with the same dt, so results don't depend on the
+ *  frame rate.
+ *  @param dt tick length in seconds (SIM_DT)
+ */
+void simStep(double dt) {
+  // First-person: move from WASD at the tick rate so replays follow the
+  // same path
   if (mode == 2) {
     fpUpdateMove(th, kW, kS, kA, kD, moveStep, dt, &px, &pz);
   }
 
+  // Keep the previous tick for render interpolation
+  prevZhTargets = zhTargets;
+  prevZhTrees = zhTrees;
+  prevDayNightCycle = dayNightCycle;
+
   // Light position is calculated from dayNightCycle in enableLighting()
   // Bullseyes always move at the configured targetRate
   zhTargets = fmod(zhTargets + targetRate * dt, 360.0);
+  TargetTable *swap = targetsPrev;
+  targetsPrev = targetsNow;
+  targetsNow = swap;
+  updateTargetTable(targetsNow, zhTargets);
+  advanceWindField(&wind, dt);
   // Trees sway continuously (gentle)
   zhTrees = fmod(zhTrees + 25.0 * dt, 360.0);
   // Day/Night cycle advances when enabled
   if (moveCycle)
     dayNightCycle = fmod(dayNightCycle + cycleRate * dt, 1.0);
 
-  // Update arrows
-  for (int i = 0; i < MAX_ARROWS; i++) {
-    if (!arrows[i].active) continue;
+  // Rapid fire: stream arrows while right-click is held
+  static double rapidDebt = 0.0;
+  if (rapidFire && rightMouseDown) {
+    for (rapidDebt += RAPID_FIRE_RATE * dt; rapidDebt >= 1.0; rapidDebt -= 1.0) {
+      double jth = th + 3.0 * (Rand01(simSeed++) - 0.5);
+      double jph = ph + 3.0 * (Rand01(simSeed++) - 0.5);
+      const int slot = fireArrow(jth, jph, 50.0);
+      if (slot >= 0) {
+        arrowsFired++;
+        logShot(slot, 0.0, 50.0, jth, jph, TELEMETRY_RAPID);
+      }
+    }
+  } else {
+    rapidDebt = 0.0;
+  }
 
-    if (arrows[i].stuck) {
-      // Update position based on target
-      updateStuckArrow(&arrows[i], zhTargets);
+  // Integrate all flying arrows in one pass; stuck arrows are posed from
+  // their target when drawn
+  integrateArrowPool(&arrowPool, dt, &wind);
+  updateParticles(&particles, dt);
+
+  // Collision and miss checks for arrows in flight
+  for (int i = 0; i < arrowPool.high; i++) {
+    if (arrowPool.flags[i] != ARROW_ACTIVE) continue;
+
+    Arrow a;
+    loadArrow(&arrowPool, i, &a);
+    int hitScore = checkBullseyeCollision(&a, targetsPrev, targetsNow);
+    if (hitScore > 0) {
+      // Arrow is now stuck (handled by checkBullseyeCollision)
+      storeArrow(&arrowPool, i, &a);
+      arrowEffects(&a, i, 1);
+      logShotEnd(i, &a, hitScore);
+      arrowHits++;
+      if (rapidFire) continue; // Stress mode is unscored
+      score += hitScore;
+      roundHits++;
+      updateHighScore();
+    } else if (a.y < -5.0) { // Ground/Miss check
+      logShotEnd(i, &a, 0);
+      killArrow(&arrowPool, i); // Recycle missed arrows
     } else {
-      // Physics update
-      updateArrow(&arrows[i], dt);
-      
-      // Check collision
-      int hitScore = checkBullseyeCollision(&arrows[i], zhTargets);
-      if (hitScore > 0) {
-        score += hitScore;
-        // Arrow is now stuck (handled by checkBullseyeCollision)
-        if (score > highScore) {
-          highScore = score;
-          saveHighScore();
-        }
-      } else if (arrows[i].y < -5.0) { // Ground/Miss check
-         arrows[i].active = 0; // Deactivate missed arrows
-      }
+      arrowEffects(&a, i, 0);
     }
   }
 
   // Check Game Over
   if (arrowsLeft == 0) { 
      // Count how many are flying.
-     int flying = 0;
-     for(int i=0; i<MAX_ARROWS; i++) {
-       if (arrows[i].active && !arrows[i].stuck) flying++;
-     }
+     int flying = arrowsInFlight(&arrowPool);
      if (flying == 0 && !gameOver) {
         gameOver = 1;
-        if (score > highScore) {
-          highScore = score;
-          saveHighScore();
-        }
+        finishRound();
      }
   }
-
-  glutPostRedisplay();
 }
 
 /*
@@ -851,7 +1261,7 @@ void mouse(int button, int state, int x, int y) {
       if (!rightMouseDown)
         mouseLook = 0;
     }
-    glutPostRedisplay();
+    redraw(0);
   } else if (button == GLUT_RIGHT_BUTTON) {
     // Right click to shoot (Charge mechanic) and allow look-drag while aiming
     if (state == GLUT_DOWN) {
@@ -859,47 +1269,31 @@ void mouse(int button, int state, int x, int y) {
       mouseLook = 1;
       lastX = x;
       lastY = y;
-      // Start charging
-      chargeStartTime = glutGet(GLUT_ELAPSED_TIME) / 1000.0;
+      // Start charging (simulation time, so replays charge identically)
+      chargeStartTime = simTicks * SIM_DT;
+      charging = 1;
     } else if (state == GLUT_UP) {
       rightMouseDown = 0;
       if (!leftMouseDown)
         mouseLook = 0;
 
-      if (chargeStartTime > 0.0) {
+      if (charging && !rapidFire) {
         // Release to shoot
         if (!gameOver && arrowsLeft > 0) {
-          double now = glutGet(GLUT_ELAPSED_TIME) / 1000.0;
-          double duration = now - chargeStartTime;
-
-          // Map duration to speed
-          // Min speed 10, Max speed 50
-          // Max charge time 1.0 second
-          double maxChargeTime = 1.0;
-          double minSpeed = 10.0;
-          double maxSpeed = 50.0;
-
-          if (duration > maxChargeTime)
-            duration = maxChargeTime;
-
-          double speed =
-              minSpeed + (duration / maxChargeTime) * (maxSpeed - minSpeed);
-
-          // Find first inactive arrow slot
-          for (int i = 0; i < MAX_ARROWS; i++) {
-            if (!arrows[i].active) {
-               shootArrow(&arrows[i], px, py, pz, th, ph, speed);
-               arrows[i].stuck = 0; // Ensure not stuck
-               break;
-            }
+          double duration = simTicks * SIM_DT - chargeStartTime;
+          double speed = chargeSpeed(duration);
+
+          const int slot = fireArrow(th, ph, speed);
+          if (slot >= 0) {
+            arrowsFired++;
+            arrowsLeft--;
+            logShot(slot, duration, speed, th, ph, 0);
           }
-          
-          arrowsLeft--;
         }
       }
 
-      // Reset charge time
-      chargeStartTime = 0;
+      // Reset charge
+      charging = 0;
     }
   }
 }
@@ -922,13 +1316,286 @@ void motion(int x, int y) {
     ph = 89.0;
   else if (ph < -89.0)
     ph = -89.0;
+  redraw(0);
+}
+
+/*
+ *  Checksum of the simulation outcome: arrow slots, poses and score
+ */
+unsigned int simChecksum() {
+  unsigned int h = 2166136261u;
+  for (int i = 0; i < arrowPool.high; i++) {
+    if (!arrowPool.flags[i]) continue;
+    h = HashBytes(h, &i, sizeof(i));
+    h = HashBytes(h, &arrowPool.flags[i], 1);
+    h = HashBytes(h, &arrowPool.x[i], sizeof(float));
+    h = HashBytes(h, &arrowPool.y[i], sizeof(float));
+    h = HashBytes(h, &arrowPool.z[i], sizeof(float));
+    h = HashBytes(h, &arrowPool.rel[6 * i], 6 * sizeof(float));
+  }
+  return HashBytes(h, &score, sizeof(score));
+}
+
+/*
+ *  Outcome of the session so far (written to and checked against replays)
+ */
+ReplayResult sessionResult() {
+  ReplayResult r = {simTicks, arrowsFired, arrowHits, score, simChecksum()};
+  return r;
+}
+
+/*
+ *  Write the end record when a recorded session exits
+ */
+void finishRecording() {
+  ReplayResult r = sessionResult();
+  stopRecording(&r);
+}
+
+/*
+ *  Capture the state a replay starts from
+ */
+ReplayState captureReplayState() {
+  ReplayState st = {px, py, pz, th, ph, mode, zhTargets, zhTrees,
+                    dayNightCycle, targetRate, cycleRate, moveCycle,
+                    rapidFire, score, arrowsLeft, simSeed, windSpeed,
+                    arrowDrag};
+  return st;
+}
+
+/*
+ *  Restore the state a replay starts from
+ */
+void applyReplayState(const ReplayState *st) {
+  px = st->px;
+  py = st->py;
+  pz = st->pz;
+  th = st->th;
+  ph = st->ph;
+  mode = st->mode;
+  setTargetAngle(st->zhTargets);
+  zhTrees = prevZhTrees = st->zhTrees;
+  dayNightCycle = prevDayNightCycle = st->dayNightCycle;
+  targetRate = st->targetRate;
+  cycleRate = st->cycleRate;
+  moveCycle = st->moveCycle;
+  rapidFire = st->rapidFire;
+  score = st->score;
+  arrowsLeft = st->arrowsLeft;
+  simSeed = st->seed;
+  windSpeed = st->wind;
+  arrowDrag = st->drag;
+  initWindField(&wind, windSpeed, arrowDrag, simSeed);
+}
+
+/*
+ *  Apply a recorded input event through the normal input handlers
+ */
+void applyReplayEvent(const ReplayEvent *ev) {
+  if (ev->type == REPLAY_KEY)
+    key(ev->a, ev->x, ev->y);
+  else if (ev->type == REPLAY_KEY_UP)
+    keyUp(ev->a, ev->x, ev->y);
+  else if (ev->type == REPLAY_SPECIAL)
+    specialDown(ev->a, ev->x, ev->y);
+  else if (ev->type == REPLAY_MOUSE)
+    mouse(ev->a, ev->b, ev->x, ev->y);
+  else if (ev->type == REPLAY_MOTION)
+    motion(ev->x, ev->y);
+}
+
+/*
+ *  Run one simulation tick: play back the input due before it, then step
+ *  @return 0 when a replay has reached its end, 1 otherwise
+ */
+int runTick() {
+  if (isReplaying()) {
+    if (simTicks >= replayLength()) return 0;
+    ReplayEvent ev;
+    while (nextReplayEvent(simTicks, &ev)) applyReplayEvent(&ev);
+  }
+  simStep(SIM_DT);
+  simTicks++;
+  return 1;
+}
+
+/*
+ *  GLUT calls this routine when there is nothing else to do
+ *  Runs as many fixed simulation ticks as real time allows and leaves the
+ *  remainder in simAlpha for render interpolation
+ */
+void idle() {
+  static double lastT = 0.0;
+  static double accumulator = 0.0;
+  double t = TimeNow();
+  if (lastT == 0.0) {
+    lastT = t;
+    lastFPSTime = t;
+  }
+  double dt = t - lastT;
+  lastT = t;
+  frameTime = dt;
+
+  // Calculate FPS every 0.5 seconds
+  frameCount++;
+  if (t - lastFPSTime >= 0.5) {
+    fps = frameCount / (t - lastFPSTime);
+    frameCount = 0;
+    lastFPSTime = t;
+  }
+
+  // Fast replay: a fixed batch of ticks per frame regardless of real time
+  if (replayFast) dt = 64 * SIM_DT;
+
+  // Fixed-step simulation; clamp long stalls so catching up stays bounded
+  if (dt > SIM_MAX_FRAME && !replayFast) dt = SIM_MAX_FRAME;
+  accumulator += dt;
+  while (accumulator >= SIM_DT) {
+    if (!runTick()) {
+      ReplayResult r = sessionResult();
+      exit(checkReplayResult(&r) ? 0 : 1);
+    }
+    accumulator -= SIM_DT;
+  }
+  simAlpha = accumulator / SIM_DT;
+
   glutPostRedisplay();
 }
 
+/*
+ *  GLUT input callbacks: record the event for replays (stamped with the
+ *  tick it precedes), then handle it. Live input is ignored during a
+ *  replay except ESC.
+ */
+void keyInput(unsigned char ch, int x, int y) {
+  if (ch == 27) exit(0);
+  if (isReplaying()) return;
+  recordEvent(simTicks, REPLAY_KEY, ch, 0, x, y);
+  key(ch, x, y);
+}
+
+void keyUpInput(unsigned char ch, int x, int y) {
+  if (isReplaying()) return;
+  recordEvent(simTicks, REPLAY_KEY_UP, ch, 0, x, y);
+  keyUp(ch, x, y);
+}
+
+void specialInput(int k, int x, int y) {
+  if (isReplaying()) return;
+  recordEvent(simTicks, REPLAY_SPECIAL, k, 0, x, y);
+  specialDown(k, x, y);
+}
+
+void mouseInput(int button, int state, int x, int y) {
+  if (isReplaying()) return;
+  recordEvent(simTicks, REPLAY_MOUSE, button, state, x, y);
+  mouse(button, state, x, y);
+}
+
+void motionInput(int x, int y) {
+  if (isReplaying()) return;
+  recordEvent(simTicks, REPLAY_MOTION, 0, 0, x, y);
+  motion(x, y);
+}
+
+/*
+ *  Play a replay with no window: run every tick back to back, then report
+ *  the outcome and simulation speed
+ *  @return process exit status (0 if the outcome matches the recording)
+ */
+int runHeadlessReplay() {
+  double t0 = TimeNow();
+  while (runTick())
+    ;
+  double elapsed = TimeNow() - t0;
+  ReplayResult r = sessionResult();
+  int match = checkReplayResult(&r);
+  printf("Simulated %.1f s in %.3f s (%.0fx real time, %.1f us/tick)\n",
+         simTicks * SIM_DT, elapsed, simTicks * SIM_DT / fmax(elapsed, 1e-9),
+         1e6 * elapsed / fmax(simTicks, 1));
+  return match ? 0 : 1;
+}
+
 /*
  *  Start up GLUT and tell it what to do
  */
 int main(int argc, char *argv[]) {
+  //  Recording, replay and simulator options
+  const char *recordFile = NULL, *replayFile = NULL, *telemetryFile = NULL;
+  const char *targetsFile = "targets.txt";
+  long mcShots = 0;
+  int mcThreads = 0;
+  unsigned int mcSeed = 1;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--record") && i + 1 < argc)
+      recordFile = argv[++i];
+    else if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+      replayFile = argv[++i];
+    else if (!strcmp(argv[i], "--fast"))
+      replayFast = 1;
+    else if (!strcmp(argv[i], "--headless"))
+      headless = 1;
+    else if (!strcmp(argv[i], "--montecarlo") && i + 1 < argc)
+      mcShots = atol(argv[++i]);
+    else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+      mcThreads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+      mcSeed = strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "--targets") && i + 1 < argc)
+      targetsFile = argv[++i];
+    else if (!strcmp(argv[i], "--telemetry") && i + 1 < argc)
+      telemetryFile = argv[++i];
+    else if (!strcmp(argv[i], "--wind") && i + 1 < argc)
+      windSpeed = fmax(0.0, atof(argv[++i]));
+  }
+  if (!loadTargetLayout(targetsFile))
+    Fatal("Cannot load target layout %s\n", targetsFile);
+  //  Shot simulator: no window, sweep the area around the start position
+  if (mcShots > 0) {
+    MonteCarloConfig cfg = {mcShots, mcThreads, mcSeed, SIM_DT, targetRate,
+                            py,      -10.0,     10.0,   15.0,   40.0,
+                            -30.0,   30.0,      -5.0,   25.0,   0.0,
+                            1.0,     windSpeed, arrowDrag};
+    return runMonteCarlo(&cfg);
+  }
+  if (!initArrowPool(&arrowPool, ARROW_POOL_CAPACITY))
+    Fatal("Cannot allocate arrow pool\n");
+  setTargetAngle(zhTargets);
+  initWindField(&wind, windSpeed, arrowDrag, simSeed);
+  if (!initSceneGraph(&scene, ARROW_POOL_CAPACITY + TARGET_TABLE_MAX))
+    Fatal("Cannot allocate scene graph\n");
+  for (int k = 0; k < targetsNow->count; k++)
+    targetNodes[k] = addSceneNode(&scene, SCENE_NONE, NULL);
+  attachArrowScene(&arrowPool, &scene, targetNodes, targetsNow->count);
+  // Trees stand on the terrain, so its layout is needed before planting
+  setTerrainLayout(0.5, groundSize, groundSize - overlap, ringOuterR, groundY,
+                   32.0);
+  if (!initForest(&forest, FOREST_CAPACITY))
+    Fatal("Cannot allocate forest\n");
+  spawnForest(&forest);
+  if (replayFile) {
+    ReplayState st;
+    if (!loadReplay(replayFile, &st)) Fatal("Cannot load replay %s\n", replayFile);
+    applyReplayState(&st);
+    if (headless) return runHeadlessReplay();
+  } else {
+    headless = replayFast = 0;
+    if (recordFile) {
+      ReplayState st = captureReplayState();
+      if (!startRecording(recordFile, &st))
+        Fatal("Cannot record to %s\n", recordFile);
+      atexit(finishRecording);
+    }
+    if (telemetryFile) {
+      if (!startTelemetry(telemetryFile, ARROW_POOL_CAPACITY,
+                          (int)(1.0 / SIM_DT + 0.5)))
+        Fatal("Cannot write telemetry to %s\n", telemetryFile);
+      atexit(stopTelemetry);
+    }
+  }
+  if (!initParticlePool(&particles, PARTICLE_CAPACITY))
+    Fatal("Cannot allocate particle pool\n");
+
   //  Initialize GLUT and process user parameters
   glutInit(&argc, argv);
   //  Request double buffered, true color window with Z buffering
@@ -971,15 +1638,70 @@ int main(int argc, char *argv[]) {
   //  Create shader program for normal-mapped terrain (ground + rock ring)
   terrainShaderProg = CreateShaderProg("terrain_normal.vert",
                                        "terrain_normal.frag");
-  //  Bind samplers: colorTex -> unit 0, normalTex -> unit 1
-  if (terrainShaderProg) {
-    glUseProgram(terrainShaderProg);
-    GLint locColor = glGetUniformLocation(terrainShaderProg, "colorTex");
-    GLint locNormal = glGetUniformLocation(terrainShaderProg, "normalTex");
-    if (locColor >= 0) glUniform1i(locColor, 0);
-    if (locNormal >= 0) glUniform1i(locNormal, 1);
+  //  Tessellated terrain needs OpenGL 4.0 (also available on Mesa llvmpipe)
+  if (GLVersionAtLeast(4, 0))
+    terrainTessProg = CreateShaderProgTess("terrain_tess.vert", "terrain_tess.tesc",
+                                           "terrain_tess.tese", "terrain_normal.frag");
+  //  Virtual texture for the mountain ring (needs framebuffer objects)
+  virtualTextureAvailable = initVirtualTexture(-ringOuterR, -ringOuterR,
+                                               2.0 * ringOuterR,
+                                               "textures/rock_color.bmp",
+                                               "textures/ground_color.bmp");
+  //  Cascaded shadow maps for the terrain (needs framebuffer objects)
+  shadowsAvailable = initShadows();
+  if (shadowsAvailable && terrainTessProg)
+    terrainTessDepthProg = CreateShaderProgTess(
+        "terrain_tess.vert", "terrain_tess.tesc", "terrain_tess.tese",
+        "terrain_depth.frag");
+  if (virtualTextureAvailable) {
+    terrainFeedbackProg = CreateShaderProg("terrain_normal.vert",
+                                           "vtex_feedback.frag");
+    if (terrainTessProg)
+      terrainTessFeedbackProg = CreateShaderProgTess(
+          "terrain_tess.vert", "terrain_tess.tesc", "terrain_tess.tese",
+          "vtex_feedback.frag");
+  }
+  //  The cached terrain mesh feeds tangents to one fixed attribute index,
+  //  so relink the mesh programs with "tangent" bound to it
+  unsigned int meshProgs[2] = {terrainShaderProg, terrainFeedbackProg};
+  for (int i = 0; i < 2; i++) {
+    if (!meshProgs[i]) continue;
+    glBindAttribLocation(meshProgs[i], TERRAIN_TANGENT_ATTRIB, "tangent");
+    glLinkProgram(meshProgs[i]);
+  }
+  //  Bind splat samplers: ground -> units 0/1, heights -> 2, rock -> units 3/4,
+  //  virtual texture page cache -> 5, page table -> 6
+  unsigned int terrainProgs[5] = {terrainShaderProg, terrainTessProg,
+                                  terrainFeedbackProg, terrainTessFeedbackProg,
+                                  terrainTessDepthProg};
+  for (int i = 0; i < 5; i++) {
+    if (!terrainProgs[i]) continue;
+    glUseProgram(terrainProgs[i]);
+    glUniform1i(glGetUniformLocation(terrainProgs[i], "groundColorTex"), 0);
+    glUniform1i(glGetUniformLocation(terrainProgs[i], "groundNormalTex"), 1);
+    glUniform1i(glGetUniformLocation(terrainProgs[i], "heightTex"), 2);
+    glUniform1i(glGetUniformLocation(terrainProgs[i], "rockColorTex"), 3);
+    glUniform1i(glGetUniformLocation(terrainProgs[i], "rockNormalTex"), 4);
+    glUniform1i(glGetUniformLocation(terrainProgs[i], "vtCache"), 5);
+    glUniform1i(glGetUniformLocation(terrainProgs[i], "vtPageTable"), 6);
     glUseProgram(0);
   }
+  //  Instanced grass needs OpenGL 3.3 (instanced attributes)
+  //  Instanced arrows, targets and particle sprites share the requirement
+  if (GLVersionAtLeast(3, 3)) {
+    grassProg = CreateShaderProg("grass.vert", "grass.frag");
+    arrowProg = CreateShaderProg("arrow.vert", "arrow.frag");
+    bullseyeProg = CreateShaderProg("bullseye.vert", "bullseye.frag");
+    particleProg = CreateShaderProg("particle.vert", "particle.frag");
+    skyProg = CreateShaderProg("sky.vert", "sky.frag");
+  }
+  //  Integrate the atmosphere into the sky tables once (about 130 ms); the
+  //  sky and the fog color are lookups from then on
+  buildSkyLuts(&sky);
+  //  Generate tessellation heightmaps on the GPU when compute shaders exist
+  //  (OpenGL 4.3); heights are read back once so CPU code can query them
+  if (terrainTessProg && GLVersionAtLeast(4, 3))
+    setTerrainGenerator(CreateComputeProg("terrain_gen.comp"), 1);
   //  Tell GLUT to call "display" when the scene should be drawn
   glutDisplayFunc(display);
   //  Tell GLUT to call "idle" when there is nothing else to do (animate)
@@ -988,15 +1710,15 @@ int main(int argc, char *argv[]) {
   glutReshapeFunc(reshape);
   //  Tell GLUT to call arrow key handler (down); arrows are used in non-FP
   //  modes only
-  glutSpecialFunc(specialDown);
+  glutSpecialFunc(specialInput);
   // No specialUp needed
   //  Tell GLUT to call "key" when a key is pressed
-  glutKeyboardFunc(key);
+  glutKeyboardFunc(keyInput);
   //  Tell GLUT to call keyUp when a key is released (for WASD)
-  glutKeyboardUpFunc(keyUp);
+  glutKeyboardUpFunc(keyUpInput);
   //  Mouse look in first-person
-  glutMouseFunc(mouse);
-  glutMotionFunc(motion);
+  glutMouseFunc(mouseInput);
+  glutMotionFunc(motionInput);
   //  Pass control to GLUT so it can interact with the user
   glutMainLoop();
   return 0;
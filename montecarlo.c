@@ -0,0 +1,310 @@
+/*
+ *  Monte Carlo module - implementation file
+ *  Shots are fired in batches of MC_BATCH into a private arrow pool per
+ *  worker and stepped with the game's integrator and swept collision test
+ *  until every arrow has hit, left the target area or timed out. All shots
+ *  in a batch share a random target phase. Workers take batch numbers from
+ *  a shared counter and keep their own tallies, which are summed at the end.
+ */
+#include "montecarlo.h"
+#include "objects/arrow.h"
+#include "objects/bullseye.h"
+#include "utils.h"
+#include <pthread.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#define MC_BATCH 1024      // Shots fired together (one target phase)
+#define MC_MAX_TARGETS TARGET_MAX   // Targets tallied
+#define MC_MAX_RINGS TARGET_MAX_RINGS // Rings tallied per target
+#define MC_CHARGE_BINS 10  // Rows in the charge table
+#define MC_MAX_THREADS 64  // Most worker threads started
+#define MC_MAX_FLIGHT 10.0 // Longest flight simulated (seconds)
+
+/*
+ *  Counts gathered by one worker (summed over all workers at the end)
+ */
+typedef struct {
+  long long shots;
+  long long hits[MC_MAX_TARGETS][MC_MAX_RINGS];
+  long long chargeShots[MC_CHARGE_BINS];
+  long long chargeHits[MC_CHARGE_BINS];
+  long long chargePoints[MC_CHARGE_BINS];
+} McTally;
+
+/*
+ *  State shared by the workers
+ */
+typedef struct {
+  const MonteCarloConfig *cfg;
+  int targets;                    // Number of targets
+  double radius[MC_MAX_TARGETS];  // Target radius
+  int rings[MC_MAX_TARGETS];      // Target ring count
+  double box[6];                  // Bounds of every target over a cycle
+  long batches;                   // Batches to run
+  long next;                      // Next batch to hand out
+  pthread_mutex_t lock;           // Guards next
+} McShared;
+
+typedef struct {
+  McShared *shared;
+  McTally tally;
+} McWorker;
+
+/*
+ *  Next value of a xorshift generator, in [0,1)
+ */
+static double mcRand(unsigned int *s) {
+  unsigned int x = *s;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *s = x;
+  return x / 4294967296.0;
+}
+
+/*
+ *  Seed for a batch (integer hash so neighboring batches are unrelated)
+ */
+static unsigned int batchSeed(unsigned int seed, long batch) {
+  unsigned int h = seed ^ (unsigned int)(batch * 2654435761u);
+  h ^= h >> 16;
+  h *= 0x7feb352dU;
+  h ^= h >> 15;
+  h *= 0x846ca68bU;
+  h ^= h >> 16;
+  return h ? h : 1u;
+}
+
+/*
+ *  An arrow that can no longer reach a target: below the game's miss
+ *  height, or outside the targets' bounds and moving away (below them and
+ *  falling, since gravity only pulls down)
+ */
+static int outOfPlay(const Arrow *a, const double box[6]) {
+  return a->y < -5.0 || (a->x < box[0] && a->vx <= 0.0) ||
+         (a->x > box[3] && a->vx >= 0.0) || (a->z < box[2] && a->vz <= 0.0) ||
+         (a->z > box[5] && a->vz >= 0.0) || (a->y < box[1] && a->vy <= 0.0);
+}
+
+/*
+ *  A flying arrow whose tail is outside the targets' bounds and moving
+ *  toward them: it was farther out at the previous tick, so neither end of
+ *  the tip's swept segment can be inside a target yet
+ */
+static int approaching(const ArrowPool *p, int i, const double box[6]) {
+  return (p->x[i] < box[0] && p->vx[i] > 0.0f) ||
+         (p->x[i] > box[3] && p->vx[i] < 0.0f) ||
+         (p->z[i] < box[2] && p->vz[i] > 0.0f) ||
+         (p->z[i] > box[5] && p->vz[i] < 0.0f) ||
+         (p->y[i] > box[4] && p->vy[i] < 0.0f);
+}
+
+/*
+ *  Fire and resolve one batch of shots
+ *  @param sh shared state
+ *  @param pool worker's arrow pool
+ *  @param batch batch number (selects the seed)
+ *  @param t tally to add to
+ */
+static void runBatch(const McShared *sh, ArrowPool *pool, long batch,
+                     McTally *t) {
+  const MonteCarloConfig *cfg = sh->cfg;
+  const long first = batch * MC_BATCH;
+  const int n = (int)(cfg->shots - first < MC_BATCH ? cfg->shots - first
+                                                    : MC_BATCH);
+  unsigned int s = batchSeed(cfg->seed, batch);
+  unsigned char bin[MC_BATCH];
+
+  // Fire every shot at tick 0 with its own position, aim and charge
+  double zh = 360.0 * mcRand(&s);
+  WindField wind;
+  initWindField(&wind, cfg->wind, cfg->drag, s);
+  TargetTable tables[2], *t0 = &tables[0], *t1 = &tables[1];
+  updateTargetTable(t1, zh);
+  clearArrowPool(pool);
+  for (int k = 0; k < n; k++) {
+    const double x = cfg->x0 + (cfg->x1 - cfg->x0) * mcRand(&s);
+    const double z = cfg->z0 + (cfg->z1 - cfg->z0) * mcRand(&s);
+    const double th = cfg->th0 + (cfg->th1 - cfg->th0) * mcRand(&s);
+    const double ph = cfg->ph0 + (cfg->ph1 - cfg->ph0) * mcRand(&s);
+    const double u = mcRand(&s);
+    const double charge = cfg->charge0 + (cfg->charge1 - cfg->charge0) * u;
+    const int i = spawnArrow(pool, x, cfg->y, z, th, ph, chargeSpeed(charge));
+    bin[i] = (unsigned char)(u * MC_CHARGE_BINS);
+    t->chargeShots[bin[i]]++;
+  }
+  t->shots += n;
+
+  // Same tick loop as simStep: integrate, then swept collision per arrow
+  const int maxTicks = (int)(MC_MAX_FLIGHT / cfg->dt);
+  for (int tick = 0; pool->live && tick < maxTicks; tick++) {
+    TargetTable *swap = t0;
+    t0 = t1;
+    t1 = swap;
+    zh = fmod(zh + cfg->targetRate * cfg->dt, 360.0);
+    updateTargetTable(t1, zh);
+    advanceWindField(&wind, cfg->dt);
+    integrateArrowPool(pool, cfg->dt, &wind);
+    for (int i = 0; i < pool->high; i++) {
+      if (pool->flags[i] != ARROW_ACTIVE || approaching(pool, i, sh->box))
+        continue;
+      Arrow a;
+      loadArrow(pool, i, &a);
+      const int score = checkBullseyeCollision(&a, t0, t1);
+      if (score > 0) {
+        t->hits[a.stuckTargetIndex][a.stuckRing]++;
+        t->chargeHits[bin[i]]++;
+        t->chargePoints[bin[i]] += score;
+        killArrow(pool, i);
+      } else if (outOfPlay(&a, sh->box)) {
+        killArrow(pool, i);
+      }
+    }
+  }
+}
+
+/*
+ *  Worker thread: run batches until none are left
+ */
+static void *mcWorker(void *arg) {
+  McWorker *w = arg;
+  McShared *sh = w->shared;
+  ArrowPool pool;
+  if (!initArrowPool(&pool, MC_BATCH))
+    Fatal("Cannot allocate simulator arrow pool\n");
+  for (;;) {
+    pthread_mutex_lock(&sh->lock);
+    const long batch = sh->next++;
+    pthread_mutex_unlock(&sh->lock);
+    if (batch >= sh->batches) break;
+    runBatch(sh, &pool, batch, &w->tally);
+  }
+  freeArrowPool(&pool);
+  return NULL;
+}
+
+/*
+ *  Print the per-target/ring and per-charge tables
+ */
+static void printTables(const McShared *sh, const McTally *t) {
+  const MonteCarloConfig *cfg = sh->cfg;
+  const double shots = (double)t->shots;
+  long long allHits = 0;
+  double allScore = 0.0;
+
+  printf("Shooter x [%g, %g] z [%g, %g] y %g | aim th [%g, %g] ph [%g, %g] | "
+         "charge [%g, %g] s | wind %g drag %g\n\n",
+         cfg->x0, cfg->x1, cfg->z0, cfg->z1, cfg->y, cfg->th0, cfg->th1,
+         cfg->ph0, cfg->ph1, cfg->charge0, cfg->charge1, cfg->wind, cfg->drag);
+  for (int k = 0; k < sh->targets; k++) {
+    long long hits = 0;
+    double expected = 0.0;
+    for (int r = 0; r < sh->rings[k]; r++) {
+      hits += t->hits[k][r];
+      expected += t->hits[k][r] * (double)bullseyeScore(sh->rings[k], r);
+    }
+    allHits += hits;
+    allScore += expected;
+    printf("Target %d (radius %.2f, %d rings): P(hit) %.4f%%  "
+           "E[score]/shot %.4f\n",
+           k, sh->radius[k], sh->rings[k], 100.0 * hits / shots,
+           expected / shots);
+    printf("  ring  points      hits    P(hit)  E[score]/shot\n");
+    for (int r = 0; r < sh->rings[k]; r++) {
+      const int points = bullseyeScore(sh->rings[k], r);
+      printf("  %4d  %6d  %8lld  %7.4f%%  %13.5f\n", r, points,
+             t->hits[k][r], 100.0 * t->hits[k][r] / shots,
+             t->hits[k][r] * (double)points / shots);
+    }
+  }
+  printf("All targets: P(hit) %.4f%%  E[score]/shot %.4f\n\n",
+         100.0 * allHits / shots, allScore / shots);
+
+  printf("charge (s)      shots    P(hit)  E[score]/shot\n");
+  for (int c = 0; c < MC_CHARGE_BINS; c++) {
+    const double lo = cfg->charge0 + (cfg->charge1 - cfg->charge0) * c /
+                                         MC_CHARGE_BINS;
+    const double hi = cfg->charge0 + (cfg->charge1 - cfg->charge0) * (c + 1) /
+                                         MC_CHARGE_BINS;
+    const double n = t->chargeShots[c] ? (double)t->chargeShots[c] : 1.0;
+    printf("%4.2f-%4.2f  %10lld  %7.4f%%  %13.4f\n", lo, hi,
+           t->chargeShots[c], 100.0 * t->chargeHits[c] / n,
+           t->chargePoints[c] / n);
+  }
+}
+
+/*
+ *  Run the simulation and print the tables to stdout
+ *  @return 0 on success, 1 if the workers couldn't be started
+ */
+int runMonteCarlo(const MonteCarloConfig *cfg) {
+  McShared sh;
+  memset(&sh, 0, sizeof(sh));
+  sh.cfg = cfg;
+
+  // Target sizes, and the volume they sweep over a full cycle (padded by
+  // an arrow length so tails outside it still count as in play)
+  for (int k = 0; k < 6; k++) sh.box[k] = k < 3 ? 1e30 : -1e30;
+  sh.targets = targetLayoutCount();
+  for (int k = 0; k < sh.targets; k++) {
+    const TargetDef *d = targetLayoutDef(k);
+    sh.radius[k] = d->radius;
+    sh.rings[k] = d->rings;
+    for (int a = 0; a < 3; a++) {
+      sh.box[a] = fmin(sh.box[a], d->lo[a] - d->radius - 4.0);
+      sh.box[3 + a] = fmax(sh.box[3 + a], d->hi[a] + d->radius + 4.0);
+    }
+  }
+
+  // One worker per CPU unless told otherwise
+  int threads = cfg->threads;
+#ifdef _SC_NPROCESSORS_ONLN
+  if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  sh.batches = (cfg->shots + MC_BATCH - 1) / MC_BATCH;
+  if (threads > sh.batches) threads = (int)sh.batches;
+  if (threads > MC_MAX_THREADS) threads = MC_MAX_THREADS;
+  if (threads < 1) threads = 1;
+
+  McWorker *workers = calloc(threads, sizeof(McWorker));
+  pthread_t *ids = malloc(threads * sizeof(pthread_t));
+  if (!workers || !ids) Fatal("Out of memory starting the simulator\n");
+  pthread_mutex_init(&sh.lock, NULL);
+
+  printf("Monte Carlo: %ld shots on %d thread%s (seed %u)\n", cfg->shots,
+         threads, threads == 1 ? "" : "s", cfg->seed);
+  const double t0 = TimeNow();
+  int started = 0;
+  for (; started < threads; started++) {
+    workers[started].shared = &sh;
+    if (pthread_create(&ids[started], NULL, mcWorker, &workers[started]))
+      break;
+  }
+  for (int i = 0; i < started; i++) pthread_join(ids[i], NULL);
+  const double elapsed = TimeNow() - t0;
+  pthread_mutex_destroy(&sh.lock);
+
+  // Workers share one batch counter, so any that started ran every batch
+  int status = 1;
+  if (started > 0) {
+    McTally total;
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i < started; i++) {
+      const long long *src = (const long long *)&workers[i].tally;
+      long long *dst = (long long *)&total;
+      for (size_t k = 0; k < sizeof(McTally) / sizeof(long long); k++)
+        dst[k] += src[k];
+    }
+    printf("Simulated in %.2f s (%.0f shots/s)\n", elapsed,
+           total.shots / fmax(elapsed, 1e-9));
+    printTables(&sh, &total);
+    status = 0;
+  } else {
+    fprintf(stderr, "Cannot start simulator threads\n");
+  }
+  free(workers);
+  free(ids);
+  return status;
+}
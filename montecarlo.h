@@ -0,0 +1,38 @@
+/*
+ *  Monte Carlo module - header file
+ *  Headless shot simulator for balancing: fires millions of random shots
+ *  through the game's arrow pool and collision code on a pool of worker
+ *  threads, then prints hit-probability and expected-score tables
+ */
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+/*
+ *  Shots to simulate and the ranges they are drawn from (uniformly)
+ */
+typedef struct {
+  long shots;               // Total shots
+  int threads;              // Worker threads (0 = one per CPU)
+  unsigned int seed;        // Random seed (same seed, same tables)
+  double dt;                // Simulation tick (seconds)
+  double targetRate;        // Target animation speed (degrees per second)
+  double y;                 // Shooter eye height
+  double x0, x1, z0, z1;    // Shooter position range in XZ
+  double th0, th1;          // Azimuth range (degrees)
+  double ph0, ph1;          // Elevation range (degrees)
+  double charge0, charge1;  // Charge duration range (seconds)
+  double wind;              // Mean wind speed (0 = calm)
+  double drag;              // Arrow drag rate (1/s, 0 = none)
+} MonteCarloConfig;
+
+/*
+ *  Run the simulation and print the tables to stdout
+ *  Results don't depend on the thread count: shots are split into batches
+ *  seeded by batch number (each with its own wind), and only integer
+ *  counts are summed.
+ *  @param cfg shots and sampling ranges
+ *  @return 0 on success, 1 if the workers couldn't be started
+ */
+int runMonteCarlo(const MonteCarloConfig *cfg);
+
+#endif
@@ -149,105 +149,525 @@ void drawArrow(const Arrow *arrow) {
 }
 
 /*
- *  Update arrow physics
- *  @param arrow pointer to Arrow structure
- *  @param dt time delta in seconds
+ *  Launch speed for a charged shot
+ *  Speed grows linearly from 10 to 50 over a 1 second charge.
+ *  @param duration seconds the shot was charged
+ *  @return arrow speed
  */
-void updateArrow(Arrow *arrow, double dt) {
-  if (!arrow || !arrow->active) return;
+double chargeSpeed(double duration) {
+  const double maxChargeTime = 1.0;
+  const double minSpeed = 10.0;
+  const double maxSpeed = 50.0;
+  if (duration > maxChargeTime) duration = maxChargeTime;
+  if (duration < 0.0) duration = 0.0;
+  return minSpeed + (duration / maxChargeTime) * (maxSpeed - minSpeed);
+}
 
-  // Gravity
-  const double g = 9.8; // m/s^2
-  arrow->vy -= g * dt;
-
-  // Update position
-  arrow->prevX = arrow->x;
-  arrow->prevY = arrow->y;
-  arrow->prevZ = arrow->z;
-  arrow->x += arrow->vx * dt;
-  arrow->y += arrow->vy * dt;
-  arrow->z += arrow->vz * dt;
-
-  // Update direction to match velocity
-  double speed = sqrt(arrow->vx * arrow->vx + arrow->vy * arrow->vy +
-                      arrow->vz * arrow->vz);
-  if (speed > 0.001) {
-    arrow->dx = arrow->vx / speed;
-    arrow->dy = arrow->vy / speed;
-    arrow->dz = arrow->vz / speed;
+/*
+ *  Allocate an empty arrow pool
+ *  @param pool pool to initialize
+ *  @param capacity maximum number of arrows
+ *  @return 1 on success, 0 if allocation failed
+ */
+int initArrowPool(ArrowPool *pool, int capacity) {
+  memset(pool, 0, sizeof(*pool));
+  // One block for all float arrays: 15 per-arrow fields + 6 stuck floats
+  float *f = calloc((size_t)capacity * 21, sizeof(float));
+  pool->flags = calloc(capacity, 1);
+  pool->stuckTarget = calloc(capacity, sizeof(short));
+  // Free stack, scene nodes and stuck order share one int block
+  pool->freeList = malloc((size_t)capacity * 3 * sizeof(int));
+  if (!f || !pool->flags || !pool->stuckTarget || !pool->freeList) {
+    free(f);
+    free(pool->flags);
+    free(pool->stuckTarget);
+    free(pool->freeList);
+    memset(pool, 0, sizeof(*pool));
+    return 0;
   }
+  float **arrays[15] = {&pool->x,  &pool->y,  &pool->z,  &pool->px,
+                        &pool->py, &pool->pz, &pool->vx, &pool->vy,
+                        &pool->vz, &pool->dx, &pool->dy, &pool->dz,
+                        &pool->wx, &pool->wz, &pool->fly};
+  for (int k = 0; k < 15; k++) *arrays[k] = f + (size_t)k * capacity;
+  pool->rel = f + (size_t)15 * capacity;
+  pool->node = pool->freeList + capacity;
+  pool->stuckOrder = pool->node + capacity;
+  for (int i = 0; i < capacity; i++) pool->node[i] = SCENE_NONE;
+  pool->capacity = capacity;
+  clearArrowPool(pool);
+  return 1;
 }
 
 /*
- *  Shoot arrow from position with angle
- *  @param arrow pointer to Arrow structure
- *  @param x starting position x
- *  @param y starting position y
- *  @param z starting position z
- *  @param th view angle theta (degrees)
- *  @param ph view angle phi (degrees)
- *  @param speed initial speed
- */
-void shootArrow(Arrow *arrow, double x, double y, double z, double th,
-                double ph, double speed) {
-  if (!arrow) return;
-
-  arrow->active = 1;
-  arrow->active = 1;
-  arrow->x = x;
-  arrow->y = y;
-  arrow->z = z;
-  arrow->prevX = x;
-  arrow->prevY = y;
-  arrow->prevZ = z;
+ *  Release a pool's arrays
+ *  @param pool arrow pool
+ */
+void freeArrowPool(ArrowPool *pool) {
+  free(pool->x); // Start of the shared float block
+  free(pool->flags);
+  free(pool->stuckTarget);
+  free(pool->freeList); // Also holds node and stuckOrder
+  memset(pool, 0, sizeof(*pool));
+}
+
+/*
+ *  Attach stuck arrows to a scene graph
+ *  @param pool arrow pool (should be empty)
+ *  @param scene scene graph
+ *  @param targetNodes scene node of each target
+ *  @param count number of targets
+ */
+void attachArrowScene(ArrowPool *pool, SceneGraph *scene,
+                      const int *targetNodes, int count) {
+  pool->scene = scene;
+  pool->targetNode = targetNodes;
+  pool->targetCount = count;
+}
+
+/*
+ *  Add a stuck arrow's scene node under its target: origin at the relative
+ *  position, X along the relative direction (Y and Z complete the frame)
+ */
+static void attachStuckArrow(ArrowPool *pool, int i) {
+  const int k = pool->stuckTarget[i];
+  if (!pool->scene || pool->node[i] != SCENE_NONE || k < 0 ||
+      k >= pool->targetCount)
+    return;
+  const float *r = pool->rel + 6 * i;
+  SceneTransform m = {r[0], r[1], r[2], r[3], r[4], r[5]};
+  float *X = m + 3, *Y = m + 6, *Z = m + 9;
+  // Y: the axis least aligned with X, made perpendicular
+  Y[fabsf(X[0]) < 0.9f ? 0 : 1] = 1.0f;
+  const float d = Y[0] * X[0] + Y[1] * X[1] + Y[2] * X[2];
+  for (int a = 0; a < 3; a++) Y[a] -= d * X[a];
+  const float s = 1.0f / sqrtf(Y[0] * Y[0] + Y[1] * Y[1] + Y[2] * Y[2]);
+  for (int a = 0; a < 3; a++) Y[a] *= s;
+  Z[0] = X[1] * Y[2] - X[2] * Y[1];
+  Z[1] = X[2] * Y[0] - X[0] * Y[2];
+  Z[2] = X[0] * Y[1] - X[1] * Y[0];
+  pool->node[i] = addSceneNode(pool->scene, pool->targetNode[k], m);
+}
+
+/*
+ *  Remove an arrow's scene node (if it has one)
+ */
+static void detachArrow(ArrowPool *pool, int i) {
+  if (pool->node[i] == SCENE_NONE) return;
+  removeSceneNode(pool->scene, pool->node[i]);
+  pool->node[i] = SCENE_NONE;
+}
+
+/*
+ *  Remove every arrow from the pool
+ *  @param pool arrow pool
+ */
+void clearArrowPool(ArrowPool *pool) {
+  for (int i = 0; i < pool->high; i++) detachArrow(pool, i);
+  memset(pool->flags, 0, pool->capacity);
+  memset(pool->fly, 0, pool->capacity * sizeof(float));
+  // Push slots in reverse so the lowest indices are handed out first,
+  // which keeps the integrator range [0, high) tight
+  pool->freeCount = 0;
+  for (int i = pool->capacity - 1; i >= 0; i--)
+    pool->freeList[pool->freeCount++] = i;
+  pool->live = 0;
+  pool->high = 0;
+  pool->stuckClock = 0;
+}
+
+/*
+ *  Fire an arrow from the pool along the view angles
+ *  @return slot index, or -1 if the pool is full
+ */
+int spawnArrow(ArrowPool *pool, double x, double y, double z, double th,
+               double ph, double speed) {
+  if (pool->freeCount == 0) return -1;
+  int i = pool->freeList[--pool->freeCount];
+
+  double dx, dy, dz;
+  DirectionFromAngles(th, ph, &dx, &dy, &dz);
+  pool->x[i] = pool->px[i] = x;
+  pool->y[i] = pool->py[i] = y;
+  pool->z[i] = pool->pz[i] = z;
+  pool->dx[i] = dx;
+  pool->dy[i] = dy;
+  pool->dz[i] = dz;
+  pool->vx[i] = dx * speed;
+  pool->vy[i] = dy * speed;
+  pool->vz[i] = dz * speed;
+  pool->flags[i] = ARROW_ACTIVE;
+  pool->fly[i] = 1.0f;
+
+  pool->live++;
+  if (i >= pool->high) pool->high = i + 1;
+  return i;
+}
+
+/*
+ *  Return an arrow's slot to the free-list
+ *  @param pool arrow pool
+ *  @param i slot index
+ */
+void killArrow(ArrowPool *pool, int i) {
+  if (!(pool->flags[i] & ARROW_ACTIVE)) return;
+  detachArrow(pool, i);
+  pool->flags[i] = 0;
+  pool->fly[i] = 0.0f;
+  pool->freeList[pool->freeCount++] = i;
+  pool->live--;
+  // Shrink the integrator range past trailing free slots
+  while (pool->high > 0 && !pool->flags[pool->high - 1]) pool->high--;
+}
+
+/*
+ *  Free the slot of the arrow that has been stuck the longest
+ *  @param pool arrow pool
+ *  @return 1 if an arrow was removed, 0 if none is stuck
+ */
+int evictStuckArrow(ArrowPool *pool) {
+  int oldest = -1;
+  for (int i = 0; i < pool->high; i++)
+    if ((pool->flags[i] & ARROW_STUCK) &&
+        (oldest < 0 || pool->stuckOrder[i] < pool->stuckOrder[oldest]))
+      oldest = i;
+  if (oldest < 0) return 0;
+  killArrow(pool, oldest);
+  return 1;
+}
+
+/*
+ *  Integration kernel over [0, n): restrict-qualified parameters tell the
+ *  compiler the arrays don't alias, so the loop vectorizes
+ *  Free and stuck slots are masked by fly[] instead of skipped, so the loop
+ *  has no branches. Drag k pulls the velocity toward the wind (wx, 0, wz);
+ *  with k = 0 the step is exactly gravity only.
+ */
+static void integrateKernel(int n, float h, float k, float *restrict x,
+                            float *restrict y, float *restrict z,
+                            float *restrict px, float *restrict py,
+                            float *restrict pz, float *restrict vx,
+                            float *restrict vy, float *restrict vz,
+                            float *restrict dx, float *restrict dy,
+                            float *restrict dz, const float *restrict wx,
+                            const float *restrict wz,
+                            const float *restrict fly) {
+  const float g = 9.8f; // m/s^2
+  for (int i = 0; i < n; i++) {
+    // 1 for flying arrows, 0 for free or stuck slots
+    const float m = fly[i];
+    const float mh = m * h;
+    const float kh = k * mh;
+
+    px[i] = x[i];
+    py[i] = y[i];
+    pz[i] = z[i];
+    vx[i] += kh * (wx[i] - vx[i]);
+    vy[i] -= g * mh + kh * vy[i];
+    vz[i] += kh * (wz[i] - vz[i]);
+    x[i] += vx[i] * mh;
+    y[i] += vy[i] * mh;
+    z[i] += vz[i] * mh;
+
+    // Direction follows velocity (stuck arrows keep theirs)
+    const float s2 = vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i];
+    const float inv = 1.0f / sqrtf(s2 + 1e-12f);
+    dx[i] += m * (vx[i] * inv - dx[i]);
+    dy[i] += m * (vy[i] * inv - dy[i]);
+    dz[i] += m * (vz[i] * inv - dz[i]);
+  }
+}
+
+/*
+ *  Integrate every flying arrow in one pass (gravity, drag toward the
+ *  wind, position, direction)
+ *  The wind is looked up for every slot first (one bilinear read each), so
+ *  the integrator itself stays branch-free.
+ *  @param pool arrow pool
+ *  @param dt time delta in seconds
+ *  @param wind air the arrows fly through (NULL for still air, no drag)
+ */
+void integrateArrowPool(ArrowPool *pool, double dt, const WindField *wind) {
+  const float k = wind ? (float)wind->drag : 0.0f;
+  if (k > 0.0f)
+    sampleWindArrays(wind, pool->high, pool->x, pool->z, pool->wx, pool->wz);
+  integrateKernel(pool->high, (float)dt, k, pool->x, pool->y, pool->z,
+                  pool->px, pool->py, pool->pz, pool->vx, pool->vy, pool->vz,
+                  pool->dx, pool->dy, pool->dz, pool->wx, pool->wz, pool->fly);
+}
+
+/*
+ *  Copy one pooled arrow into an Arrow struct (for collision and drawing)
+ */
+void loadArrow(const ArrowPool *pool, int i, Arrow *arrow) {
+  const float *r = pool->rel + 6 * i;
+  arrow->x = pool->x[i];
+  arrow->y = pool->y[i];
+  arrow->z = pool->z[i];
+  arrow->prevX = pool->px[i];
+  arrow->prevY = pool->py[i];
+  arrow->prevZ = pool->pz[i];
+  arrow->vx = pool->vx[i];
+  arrow->vy = pool->vy[i];
+  arrow->vz = pool->vz[i];
+  arrow->dx = pool->dx[i];
+  arrow->dy = pool->dy[i];
+  arrow->dz = pool->dz[i];
   arrow->scale = 1.0;
+  arrow->active = (pool->flags[i] & ARROW_ACTIVE) != 0;
+  arrow->stuck = (pool->flags[i] & ARROW_STUCK) != 0;
+  arrow->stuckTargetIndex = pool->stuckTarget[i];
+  arrow->stuckRelX = r[0];
+  arrow->stuckRelY = r[1];
+  arrow->stuckRelZ = r[2];
+  arrow->stuckRelDx = r[3];
+  arrow->stuckRelDy = r[4];
+  arrow->stuckRelDz = r[5];
+}
 
-  // Convert view angles to direction vector
-  DirectionFromAngles(th, ph, &arrow->dx, &arrow->dy, &arrow->dz);
+/*
+ *  Write an Arrow struct back into its pool slot
+ */
+void storeArrow(ArrowPool *pool, int i, const Arrow *arrow) {
+  float *r = pool->rel + 6 * i;
+  const int wasStuck = pool->flags[i] & ARROW_STUCK;
+  pool->x[i] = arrow->x;
+  pool->y[i] = arrow->y;
+  pool->z[i] = arrow->z;
+  pool->px[i] = arrow->prevX;
+  pool->py[i] = arrow->prevY;
+  pool->pz[i] = arrow->prevZ;
+  pool->vx[i] = arrow->vx;
+  pool->vy[i] = arrow->vy;
+  pool->vz[i] = arrow->vz;
+  pool->dx[i] = arrow->dx;
+  pool->dy[i] = arrow->dy;
+  pool->dz[i] = arrow->dz;
+  pool->flags[i] = (arrow->active ? ARROW_ACTIVE : 0) |
+                   (arrow->stuck ? ARROW_STUCK : 0);
+  pool->fly[i] = (pool->flags[i] == ARROW_ACTIVE) ? 1.0f : 0.0f;
+  pool->stuckTarget[i] = arrow->stuckTargetIndex;
+  r[0] = arrow->stuckRelX;
+  r[1] = arrow->stuckRelY;
+  r[2] = arrow->stuckRelZ;
+  r[3] = arrow->stuckRelDx;
+  r[4] = arrow->stuckRelDy;
+  r[5] = arrow->stuckRelDz;
+  if (pool->flags[i] & ARROW_STUCK) {
+    if (!wasStuck) pool->stuckOrder[i] = pool->stuckClock++;
+    attachStuckArrow(pool, i);
+  } else
+    detachArrow(pool, i);
+}
 
-  arrow->vx = arrow->dx * speed;
-  arrow->vy = arrow->dy * speed;
-  arrow->vz = arrow->dz * speed;
+/*
+ *  Number of arrows still in flight
+ *  @param pool arrow pool
+ *  @return flying arrow count
+ */
+int arrowsInFlight(const ArrowPool *pool) {
+  int n = 0;
+  for (int i = 0; i < pool->high; i++) n += (pool->flags[i] == ARROW_ACTIVE);
+  return n;
 }
 
 /*
- *  Update arrow position when stuck to a target
- *  @param arrow pointer to Arrow structure
- *  @param zh animation angle of targets
- */
-void updateStuckArrow(Arrow *arrow, double zh) {
-  if (!arrow || !arrow->stuck) return;
-
-  // Update position based on target
-  Bullseye b;
-  // We need to include bullseye.h for this
-  // Assuming arrow.c includes bullseye.h now
-  if (getBullseye(arrow->stuckTargetIndex, zh, &b)) {
-    // Reconstruct world position from relative
-    // P_world = Origin + P_local * Basis
-    // Basis: X=Forward(dx,dy,dz), Y=Up(ux,uy,uz), Z=Normal(nx,ny,nz)
-    
-    double fx = b.dx, fy = b.dy, fz = b.dz;
-    double ux = b.ux, uy = b.uy, uz = b.uz;
-    double nx, ny, nz;
-    Vec3Cross(fx, fy, fz, ux, uy, uz, &nx, &ny, &nz);
-    Vec3Normalize(&nx, &ny, &nz);
-    
-    double rx = arrow->stuckRelX;
-    double ry = arrow->stuckRelY;
-    double rz = arrow->stuckRelZ;
-    
-    arrow->x = b.x + rx * fx + ry * ux + rz * nx;
-    arrow->y = b.y + rx * fy + ry * uy + rz * ny;
-    arrow->z = b.z + rx * fz + ry * uz + rz * nz;
-    
-    // Update direction too
-    double rdx = arrow->stuckRelDx;
-    double rdy = arrow->stuckRelDy;
-    double rdz = arrow->stuckRelDz;
-    
-    arrow->dx = rdx * fx + rdy * ux + rdz * nx;
-    arrow->dy = rdx * fy + rdy * uy + rdz * ny;
-    arrow->dz = rdx * fz + rdy * uz + rdz * nz;
+ *  Instanced drawing: one baked arrow mesh (OpenGL 3.3+)
+ *  The mesh is the same shaft, tip and fletching drawArrow builds, baked
+ *  once into a vertex buffer as triangles with per-vertex color. Each frame
+ *  every live arrow contributes one instance (tail position + direction).
+ */
+#define ARROW_MESH_MAX 512   // Vertex capacity of the baked mesh
+
+static struct {
+  int built;
+  unsigned int vao, meshBuf, instBuf;
+  int meshVerts;
+  float *inst; // CPU staging for instance data (6 floats per arrow)
+} arrowGL;
+
+/*
+ *  Append one vertex (position, normal, color) to the baked mesh
+ */
+static void meshVertex(float *m, int *n, double x, double y, double z,
+                       double nx, double ny, double nz, const float rgb[3]) {
+  float *v = m + 9 * (*n)++;
+  v[0] = x; v[1] = y; v[2] = z;
+  v[3] = nx; v[4] = ny; v[5] = nz;
+  v[6] = rgb[0]; v[7] = rgb[1]; v[8] = rgb[2];
+}
+
+/*
+ *  Bake the arrow into triangles (same dimensions as drawArrow)
+ *  @param m output vertices (9 floats each)
+ *  @return vertex count
+ */
+static int bakeArrowMesh(float *m) {
+  const float wood[3] = {0.6f, 0.4f, 0.2f}, metal[3] = {0.5f, 0.5f, 0.5f},
+              red[3] = {1.0f, 0.0f, 0.0f};
+  const double shaftLength = 3.0, shaftRadius = 0.05;
+  const double tipLength = 0.5, tipRadius = 0.1;
+  const double fletchLength = 0.8, fletchWidth = 0.2;
+  const int d = 15;
+  int n = 0;
+
+  for (int th = 0; th < 360; th += d) {
+    double c0 = Cos(th), s0 = Sin(th), c1 = Cos(th + d), s1 = Sin(th + d);
+    // Shaft side (quad as two triangles) and bottom cap
+    double r = shaftRadius, h = shaftLength;
+    meshVertex(m, &n, r * c0, r * s0, 0, c0, s0, 0, wood);
+    meshVertex(m, &n, r * c1, r * s1, 0, c1, s1, 0, wood);
+    meshVertex(m, &n, r * c1, r * s1, h, c1, s1, 0, wood);
+    meshVertex(m, &n, r * c0, r * s0, 0, c0, s0, 0, wood);
+    meshVertex(m, &n, r * c1, r * s1, h, c1, s1, 0, wood);
+    meshVertex(m, &n, r * c0, r * s0, h, c0, s0, 0, wood);
+    meshVertex(m, &n, 0, 0, 0, 0, 0, -1, wood);
+    meshVertex(m, &n, r * c1, r * s1, 0, 0, 0, -1, wood);
+    meshVertex(m, &n, r * c0, r * s0, 0, 0, 0, -1, wood);
+    // Tip cone side and base cap
+    double len = sqrt(tipRadius * tipRadius + tipLength * tipLength);
+    double a = tipLength / len, b = tipRadius / len;
+    r = tipRadius;
+    h = shaftLength + tipLength;
+    meshVertex(m, &n, 0, 0, h, 0, 0, 1, metal);
+    meshVertex(m, &n, r * c0, r * s0, shaftLength, a * c0, a * s0, b, metal);
+    meshVertex(m, &n, r * c1, r * s1, shaftLength, a * c1, a * s1, b, metal);
+    meshVertex(m, &n, 0, 0, shaftLength, 0, 0, -1, metal);
+    meshVertex(m, &n, r * c1, r * s1, shaftLength, 0, 0, -1, metal);
+    meshVertex(m, &n, r * c0, r * s0, shaftLength, 0, 0, -1, metal);
+  }
+  // Fletching: 3 double-sided feathers at 120 degrees
+  for (int i = 0; i < 3; i++) {
+    double c = Cos(120 * i), s = Sin(120 * i);
+    // Feather plane is local X=0 rotated about Z: (x,y) -> (-y*s, y*c)
+    double y0 = shaftRadius, y1 = shaftRadius + fletchWidth;
+    meshVertex(m, &n, -y0 * s, y0 * c, 0, c, s, 0, red);
+    meshVertex(m, &n, -y1 * s, y1 * c, 0.2, c, s, 0, red);
+    meshVertex(m, &n, -y0 * s, y0 * c, fletchLength, c, s, 0, red);
+    meshVertex(m, &n, -y0 * s, y0 * c, fletchLength, -c, -s, 0, red);
+    meshVertex(m, &n, -y1 * s, y1 * c, 0.2, -c, -s, 0, red);
+    meshVertex(m, &n, -y0 * s, y0 * c, 0, -c, -s, 0, red);
+  }
+  return n;
+}
+
+#ifdef GL_VERSION_3_3
+/*
+ *  Create the mesh and instance buffers
+ *  @param capacity maximum number of instances
+ */
+static void buildArrowGL(int capacity) {
+  float mesh[9 * ARROW_MESH_MAX];
+  arrowGL.meshVerts = bakeArrowMesh(mesh);
+  arrowGL.inst = malloc(sizeof(float) * 6 * capacity);
+  if (!arrowGL.inst) Fatal("Cannot allocate arrow instances\n");
+
+  glGenVertexArrays(1, &arrowGL.vao);
+  glBindVertexArray(arrowGL.vao);
+  glGenBuffers(1, &arrowGL.meshBuf);
+  glBindBuffer(GL_ARRAY_BUFFER, arrowGL.meshBuf);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 9 * arrowGL.meshVerts, mesh,
+               GL_STATIC_DRAW);
+  for (int a = 0; a < 3; a++) {
+    glEnableVertexAttribArray(a);
+    glVertexAttribPointer(a, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float),
+                          (void *)(sizeof(float) * 3 * a));
+  }
+  glGenBuffers(1, &arrowGL.instBuf);
+  glBindBuffer(GL_ARRAY_BUFFER, arrowGL.instBuf);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * capacity, NULL,
+               GL_STREAM_DRAW);
+  for (int a = 3; a <= 4; a++) {
+    glEnableVertexAttribArray(a);
+    glVertexAttribPointer(a, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+                          (void *)(sizeof(float) * 3 * (a - 3)));
+    glVertexAttribDivisor(a, 1);
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  ErrCheck("buildArrowGL");
+  arrowGL.built = 1;
+}
+#endif
+
+/*
+ *  Draw every live arrow in the pool
+ *  Flying arrows are drawn between their last two ticks; stuck arrows at
+ *  their scene node's world transform.
+ *  @param pool arrow pool
+ *  @param alpha blend between the previous and current tick (0-1)
+ *  @param shader arrow.vert/arrow.frag program (0 for immediate mode)
+ */
+void drawArrows(const ArrowPool *pool, double alpha, unsigned int shader) {
+  if (!pool->live) return;
+
+#ifdef GL_VERSION_3_3
+  if (shader) {
+    if (!arrowGL.built) buildArrowGL(pool->capacity);
+
+    // Instance data: tail position and direction for each live arrow
+    const float t = (float)alpha;
+    int count = 0;
+    for (int i = 0; i < pool->high; i++) {
+      if (!(pool->flags[i] & ARROW_ACTIVE)) continue;
+      float *o = arrowGL.inst + 6 * count;
+      if (pool->flags[i] & ARROW_STUCK) {
+        // World origin and X axis (the arrow's direction), kept up to date
+        // by the scene graph
+        if (pool->node[i] == SCENE_NONE) continue;
+        memcpy(o, pool->scene->world[pool->node[i]], 6 * sizeof(float));
+      } else {
+        o[0] = pool->px[i] + (pool->x[i] - pool->px[i]) * t;
+        o[1] = pool->py[i] + (pool->y[i] - pool->py[i]) * t;
+        o[2] = pool->pz[i] + (pool->z[i] - pool->pz[i]) * t;
+        o[3] = pool->dx[i];
+        o[4] = pool->dy[i];
+        o[5] = pool->dz[i];
+      }
+      count++;
+    }
+    if (!count) return;
+
+    // Orphan the buffer so the upload doesn't wait on last frame's draw
+    glBindBuffer(GL_ARRAY_BUFFER, arrowGL.instBuf);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * pool->capacity, NULL,
+                 GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * 6 * count,
+                    arrowGL.inst);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(shader);
+    glUniform1i(glGetUniformLocation(shader, "lit"),
+                glIsEnabled(GL_LIGHTING) ? 1 : 0);
+    glUniform1i(glGetUniformLocation(shader, "fogEnabled"),
+                glIsEnabled(GL_FOG) ? 1 : 0);
+    glBindVertexArray(arrowGL.vao);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, arrowGL.meshVerts, count);
+    glBindVertexArray(0);
+    glUseProgram(0);
+    return;
+  }
+#endif
+
+  // Fallback: one immediate-mode arrow at a time
+  for (int i = 0; i < pool->high; i++) {
+    if (!(pool->flags[i] & ARROW_ACTIVE)) continue;
+    Arrow a;
+    loadArrow(pool, i, &a);
+    if (a.stuck) {
+      if (pool->node[i] == SCENE_NONE) continue;
+      const float *W = pool->scene->world[pool->node[i]];
+      a.x = W[0];
+      a.y = W[1];
+      a.z = W[2];
+      a.dx = W[3];
+      a.dy = W[4];
+      a.dz = W[5];
+    } else {
+      a.x = a.prevX + (a.x - a.prevX) * alpha;
+      a.y = a.prevY + (a.y - a.prevY) * alpha;
+      a.z = a.prevZ + (a.z - a.prevZ) * alpha;
+    }
+    drawArrow(&a);
   }
 }
@@ -1,6 +1,12 @@
 #ifndef ARROW_H
 #define ARROW_H
 
+#include "../scene.h"
+#include "../wind.h"
+
+#define ARROW_LENGTH 3.5 // Tail to tip: shaft (3.0) + tip (0.5); an arrow's
+                         // position is its tail, collisions use its tip
+
 /*
  *  Arrow structure
  */
@@ -14,6 +20,7 @@ typedef struct {
   // Sticky state
   int stuck;              // 1 if stuck to a target
   int stuckTargetIndex;   // Index of the target
+  int stuckRing;          // Ring the tip hit (0 = bullseye)
   double stuckRelX, stuckRelY, stuckRelZ;    // Relative position to target center
   double stuckRelDx, stuckRelDy, stuckRelDz; // Relative direction
 } Arrow;
@@ -25,30 +32,150 @@ typedef struct {
 void drawArrow(const Arrow *arrow);
 
 /*
- *  Update arrow physics
- *  @param arrow pointer to Arrow structure
- *  @param dt time delta in seconds
+ *  Launch speed for a charged shot (10 to 50 over a 1 second charge)
+ *  @param duration seconds the shot was charged
+ *  @return arrow speed
  */
-void updateArrow(Arrow *arrow, double dt);
+double chargeSpeed(double duration);
 
 /*
- *  Shoot arrow from position with angle
- *  @param arrow pointer to Arrow structure
+ *  Arrow pool: structure-of-arrays storage for many projectiles
+ *  Flight state is kept in parallel float arrays so the integrator runs
+ *  over contiguous memory in one branch-free (vectorizable) pass. Free
+ *  slots are recycled through a free-list; stuck arrows keep their pose
+ *  relative to the target they hit, and with a scene graph attached they
+ *  are nodes under their target's node.
+ */
+#define ARROW_POOL_CAPACITY 16384
+#define ARROW_ACTIVE 1 // Slot holds an arrow (flying or stuck)
+#define ARROW_STUCK 2  // Arrow is stuck to a target
+
+typedef struct {
+  int capacity;  // Number of slots
+  int live;      // Slots in use
+  int high;      // One past the highest slot in use (integrator range)
+  float *x, *y, *z;       // Position
+  float *px, *py, *pz;    // Position at the previous tick
+  float *vx, *vy, *vz;    // Velocity
+  float *dx, *dy, *dz;    // Unit direction (follows velocity while flying)
+  float *wx, *wz;          // Wind at each arrow this tick
+  float *fly;             // 1 for flying arrows, 0 otherwise (integrator mask)
+  unsigned char *flags;   // ARROW_ACTIVE | ARROW_STUCK
+  short *stuckTarget;     // Index of the target a stuck arrow is attached to
+  float *rel;             // Stuck pose: 6 floats (position, direction) per slot
+  int *node;              // Scene node of a stuck arrow (SCENE_NONE if none)
+  int *stuckOrder;        // When each stuck arrow hit (stuckClock stamp)
+  int stuckClock;         // Stamp for the next arrow to stick
+  SceneGraph *scene;      // Graph stuck arrows are attached to (or NULL)
+  const int *targetNode;  // Scene node of each target
+  int targetCount;        // Entries in targetNode
+  int *freeList;          // Stack of free slot indices
+  int freeCount;          // Entries on the free stack
+} ArrowPool;
+
+/*
+ *  Allocate an empty arrow pool
+ *  @param pool pool to initialize
+ *  @param capacity maximum number of arrows
+ *  @return 1 on success, 0 if allocation failed
+ */
+int initArrowPool(ArrowPool *pool, int capacity);
+
+/*
+ *  Release a pool's arrays
+ *  @param pool arrow pool
+ */
+void freeArrowPool(ArrowPool *pool);
+
+/*
+ *  Attach stuck arrows to a scene graph
+ *  From now on an arrow that sticks becomes a child node of its target's
+ *  node, and is removed from the graph with its slot.
+ *  @param pool arrow pool (should be empty)
+ *  @param scene scene graph
+ *  @param targetNodes scene node of each target
+ *  @param count number of targets
+ */
+void attachArrowScene(ArrowPool *pool, SceneGraph *scene,
+                      const int *targetNodes, int count);
+
+/*
+ *  Remove every arrow from the pool
+ *  @param pool arrow pool
+ */
+void clearArrowPool(ArrowPool *pool);
+
+/*
+ *  Fire an arrow from the pool along the view angles
+ *  @param pool arrow pool
  *  @param x starting position x
  *  @param y starting position y
  *  @param z starting position z
  *  @param th view angle theta (degrees)
  *  @param ph view angle phi (degrees)
  *  @param speed initial speed
+ *  @return slot index, or -1 if the pool is full
  */
-void shootArrow(Arrow *arrow, double x, double y, double z, double th,
-                double ph, double speed);
+int spawnArrow(ArrowPool *pool, double x, double y, double z, double th,
+               double ph, double speed);
 
 /*
- *  Update arrow position when stuck to a target
- *  @param arrow pointer to Arrow structure
- *  @param zh animation angle of targets
+ *  Return an arrow's slot to the free-list
+ *  @param pool arrow pool
+ *  @param i slot index
+ */
+void killArrow(ArrowPool *pool, int i);
+
+/*
+ *  Free the slot of the arrow that has been stuck the longest, so a full
+ *  pool can keep firing
+ *  @param pool arrow pool
+ *  @return 1 if an arrow was removed, 0 if none is stuck
+ */
+int evictStuckArrow(ArrowPool *pool);
+
+/*
+ *  Integrate every flying arrow in one pass (gravity, drag toward the
+ *  wind, position, direction)
+ *  @param pool arrow pool
+ *  @param dt time delta in seconds
+ *  @param wind air the arrows fly through (NULL for still air, no drag)
+ */
+void integrateArrowPool(ArrowPool *pool, double dt, const WindField *wind);
+
+/*
+ *  Copy one pooled arrow into an Arrow struct (for collision and drawing)
+ *  @param pool arrow pool
+ *  @param i slot index
+ *  @param arrow Arrow structure to fill
+ */
+void loadArrow(const ArrowPool *pool, int i, Arrow *arrow);
+
+/*
+ *  Write an Arrow struct back into its pool slot
+ *  @param pool arrow pool
+ *  @param i slot index
+ *  @param arrow Arrow structure to store
+ */
+void storeArrow(ArrowPool *pool, int i, const Arrow *arrow);
+
+/*
+ *  Number of arrows still in flight
+ *  @param pool arrow pool
+ *  @return flying arrow count
+ */
+int arrowsInFlight(const ArrowPool *pool);
+
+/*
+ *  Draw every live arrow in the pool
+ *  With a shader (OpenGL 3.3+) all arrows are one instanced draw of a baked
+ *  mesh; otherwise each arrow is drawn with drawArrow. Stuck arrows are
+ *  drawn at their scene node's world transform, so the graph must be
+ *  updated first.
+ *  @param pool arrow pool
+ *  @param alpha blend between the previous and current tick (0-1)
+ *  @param shader arrow.vert/arrow.frag program (0 for immediate mode)
  */
-void updateStuckArrow(Arrow *arrow, double zh);
+void drawArrows(const ArrowPool *pool, double alpha, unsigned int shader);
 
 #endif
@@ -5,107 +5,18 @@
 
 #include "bullseye.h"
 #include "arrow.h"
+#include "../broadphase.h"
 #include "../utils.h"
 
 /*
- *  Aim a bullseye so its face points toward a target point in XZ
- *  Used to keep targets oriented toward the player's starting area
- *  @param b pointer to Bullseye structure
- *  @param tx target X coordinate
- *  @param tz target Z coordinate
- */
-static void orientTowardXZ(Bullseye *b, double tx, double tz) {
-  if (!b) return;
-  double vx = tx - b->x;
-  double vz = tz - b->z;
-  double len = Vec3Length(vx, 0.0, vz);
-  if (len < 1e-6) {
-    b->dx = 1.0;
-    b->dy = 0.0;
-    b->dz = 0.0;
-  } else {
-    vx /= len;
-    vz /= len;
-    b->dx = vz;
-    b->dy = 0.0;
-    b->dz = -vx;
-  }
-  b->ux = 0.0;
-  b->uy = 1.0;
-  b->uz = 0.0;
-}
-
-/*
- *  Apply translation and orientation for a bullseye given Bullseye struct
- *  @param b pointer to Bullseye structure
- */
-static void applyBullseyeTransform(const Bullseye *b) {
-  if (!b)
-    return;
-  // Translate to (x,y,z), orient by (dx,dy,dz) and (ux,uy,uz)
-  glTranslatef((float)b->x, (float)b->y, (float)b->z);
-
-  double forwardX = b->dx;
-  double forwardY = b->dy;
-  double forwardZ = b->dz;
-  double forwardLen = Vec3Length(forwardX, forwardY, forwardZ);
-  if (forwardLen < 1e-6) {
-    forwardX = 1.0;
-    forwardY = forwardZ = 0.0;
-  } else {
-    forwardX /= forwardLen;
-    forwardY /= forwardLen;
-    forwardZ /= forwardLen;
-  }
-
-  double upX = b->ux;
-  double upY = b->uy;
-  double upZ = b->uz;
-  double upLen = Vec3Length(upX, upY, upZ);
-  if (upLen < 1e-6) {
-    upX = 0.0;
-    upY = 1.0;
-    upZ = 0.0;
-  } else {
-    upX /= upLen;
-    upY /= upLen;
-    upZ /= upLen;
-  }
-
-  double rightX, rightY, rightZ;
-  Vec3Cross(forwardX, forwardY, forwardZ, upX, upY, upZ, &rightX, &rightY, &rightZ);
-  double rightLen = Vec3Length(rightX, rightY, rightZ);
-  if (rightLen > 1e-6) {
-    rightX /= rightLen;
-    rightY /= rightLen;
-    rightZ /= rightLen;
-  } else {
-    Vec3Cross(forwardX, forwardY, forwardZ, 0.0, 1.0, 0.0, &rightX, &rightY, &rightZ);
-    Vec3Normalize(&rightX, &rightY, &rightZ);
-  }
-
-  double mat[16] = {
-    forwardX, forwardY, forwardZ, 0.0,  // local +X
-    upX,      upY,      upZ,      0.0,  // local +Y
-    rightX,   rightY,   rightZ,   0.0,  // local +Z
-    0.0,      0.0,      0.0,      1.0,
-  };
-
-  glMultMatrixd(mat);
-}
-
-/*
- *  Draw a bullseye from a Bullseye struct
- *  @param b pointer to Bullseye structure
+ *  Draw the rings of a bullseye in its local frame (face along +Z)
+ *  @param radius outer radius
+ *  @param rings number of rings
+ *  @param color color for alternating rings
  *  @param texture texture ID
  */
-void drawBullseye(const Bullseye *b, unsigned int texture) {
-  if (!b) return;
-  // Save transformation
-  glPushMatrix();
-  // Translate to (x,y,z), orient by (dx,dy,dz) and (ux,uy,uz)
-  applyBullseyeTransform(b);
-
+static void drawRings(double radius, int rings, const double color[3],
+                      unsigned int texture) {
   // Enable texturing if texture provided
   if (texture) {
     glEnable(GL_TEXTURE_2D);
@@ -114,8 +25,8 @@ void drawBullseye(const Bullseye *b, unsigned int texture) {
   }
 
   // Draw concentric rings (bullseye) as a short 3D stack
-  int nRings = (b->rings > 0) ? b->rings : 1; // Number of colored rings (validated)
-  const double R = (b->radius > 0.0) ? b->radius : 1.0; // Outer radius in world units
+  int nRings = (rings > 0) ? rings : 1; // Number of colored rings (validated)
+  const double R = (radius > 0.0) ? radius : 1.0; // Outer radius in world units
   const double step = R / nRings;
   const int d = 10;      // Angular step in degrees
   const double hz = 0.1; // Half-thickness in world units (constant)
@@ -128,7 +39,7 @@ void drawBullseye(const Bullseye *b, unsigned int texture) {
     // Alternate colors: specified color/white per ring (colors blend with
     // texture via GL_MODULATE)
     if (i % 2 == 0)
-      glColor3f(b->r, b->g, b->b);
+      glColor3f(color[0], color[1], color[2]);
     else
       glColor3f(1.0, 1.0, 1.0);
 
@@ -227,188 +138,704 @@ void drawBullseye(const Bullseye *b, unsigned int texture) {
 
   // Disable texturing after drawing
   if (texture) glDisable(GL_TEXTURE_2D);
+}
 
-  // Restore transformation
-  glPopMatrix();
+/*
+ *  Instanced drawing: procedural rings (OpenGL 3.3+)
+ *  Every target is the same small mesh: each face is one quad that
+ *  bullseye.frag cuts to a circle and colors by ring, and the side is a
+ *  low-poly band. Each target is one instance of 14 floats, so the cost
+ *  doesn't depend on ring count and the whole table is one draw call.
+ */
+#define BULLSEYE_SIDES 48 // Segments of the side band
+#define BULLSEYE_MESH_MAX (12 + 6 * BULLSEYE_SIDES)
+#define BULLSEYE_INST 14  // Floats per instance
+
+static struct {
+  int built;
+  unsigned int vao, meshBuf, instBuf;
+  int meshVerts;
+  float inst[BULLSEYE_INST * TARGET_TABLE_MAX]; // CPU staging
+} bullseyeGL;
+
+/*
+ *  Append one vertex (position, normal, texture coordinate) to the mesh
+ */
+static void targetVertex(float *m, int *n, double x, double y, double z,
+                         double nx, double ny, double nz, double s,
+                         double t) {
+  float *v = m + 8 * (*n)++;
+  v[0] = x; v[1] = y; v[2] = z;
+  v[3] = nx; v[4] = ny; v[5] = nz;
+  v[6] = s; v[7] = t;
 }
 
 /*
- *  Get a bullseye definition by index
- *  @param index index of the bullseye (0 to N-1)
- *  @param zh animation angle
- *  @param b pointer to Bullseye structure to fill
- *  @return 1 if index is valid, 0 otherwise
+ *  Bake the unit target: x,y in radii, z = +1 (front face) or -1 (back)
+ *  @param m output vertices (8 floats each)
+ *  @return vertex count
  */
-int getBullseye(int index, double zh, Bullseye *b) {
-  const double aimX = 0.0;
-  const double aimZ = 30.0;
-  double off = 3.0 * Sin(zh);
-
-  if (index == 0) {
-    // Main center target
-    b->x = 0.0; b->y = 0.0; b->z = -1.5 + 0.4 * off;
-    b->radius = 2.0; b->rings = 6;
-    b->r = 1.0; b->g = 0.0; b->b = 0.0;
-  } else if (index == 1) {
-    // Left target
-    b->x = -8.0 + 0.6 * off; b->y = 5.0; b->z = -4.0 - 0.4 * off;
-    b->radius = 1.25; b->rings = 5;
-    b->r = 0.0; b->g = 0.0; b->b = 1.0;
-  } else if (index == 2) {
-    // Right target
-    b->x = 8.0 - 0.6 * off; b->y = 5.0; b->z = -4.0 + 0.4 * off;
-    b->radius = 1.25; b->rings = 4;
-    b->r = 0.0; b->g = 1.0; b->b = 0.0;
-  } else if (index == 3) {
-    // Back left target
-    b->x = -7.0 + 0.5 * off; b->y = 1.75; b->z = 5.5 + 0.7 * off;
-    b->radius = 1.25; b->rings = 4;
-    b->r = 1.0; b->g = 0.0; b->b = 1.0;
-  } else if (index == 4) {
-    // Back right target
-    b->x = 7.5 - 0.5 * off; b->y = 2.25; b->z = 6.0 + 0.6 * off;
-    b->radius = 1.25; b->rings = 5;
-    b->r = 0.0; b->g = 1.0; b->b = 1.0;
-  } else {
-    return 0;
+static int bakeTargetMesh(float *m) {
+  static const double quad[6][2] = {{-1, -1}, {1, -1}, {1, 1},
+                                    {-1, -1}, {1, 1},  {-1, 1}};
+  int n = 0;
+  // Faces (the back one wound the other way); texture spans the disk
+  for (int k = 0; k < 6; k++) {
+    const double x = quad[k][0], y = quad[k][1];
+    targetVertex(m, &n, x, y, 1, 0, 0, 1, 0.5 + 0.5 * x, 0.5 + 0.5 * y);
   }
-  
-  orientTowardXZ(b, aimX, aimZ);
-  return 1;
+  for (int k = 5; k >= 0; k--) {
+    const double x = quad[k][0], y = quad[k][1];
+    targetVertex(m, &n, x, y, -1, 0, 0, -1, 0.5 + 0.5 * x, 0.5 + 0.5 * y);
+  }
+  // Side band, circumscribed so it never falls inside the faces' circle
+  const double d = 360.0 / BULLSEYE_SIDES, k = 1.0 / Cos(0.5 * d);
+  for (int i = 0; i < BULLSEYE_SIDES; i++) {
+    const double c0 = Cos(i * d), s0 = Sin(i * d);
+    const double c1 = Cos((i + 1) * d), s1 = Sin((i + 1) * d);
+    const double u0 = (double)i / BULLSEYE_SIDES;
+    const double u1 = (double)(i + 1) / BULLSEYE_SIDES;
+    targetVertex(m, &n, k * c0, k * s0, -1, c0, s0, 0, u0, 0);
+    targetVertex(m, &n, k * c1, k * s1, -1, c1, s1, 0, u1, 0);
+    targetVertex(m, &n, k * c1, k * s1, 1, c1, s1, 0, u1, 1);
+    targetVertex(m, &n, k * c0, k * s0, -1, c0, s0, 0, u0, 0);
+    targetVertex(m, &n, k * c1, k * s1, 1, c1, s1, 0, u1, 1);
+    targetVertex(m, &n, k * c0, k * s0, 1, c0, s0, 0, u0, 1);
+  }
+  return n;
+}
+
+#ifdef GL_VERSION_3_3
+/*
+ *  Create the mesh and instance buffers
+ */
+static void buildBullseyeGL(void) {
+  float mesh[8 * BULLSEYE_MESH_MAX];
+  bullseyeGL.meshVerts = bakeTargetMesh(mesh);
+
+  glGenVertexArrays(1, &bullseyeGL.vao);
+  glBindVertexArray(bullseyeGL.vao);
+  glGenBuffers(1, &bullseyeGL.meshBuf);
+  glBindBuffer(GL_ARRAY_BUFFER, bullseyeGL.meshBuf);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 8 * bullseyeGL.meshVerts,
+               mesh, GL_STATIC_DRAW);
+  const int meshSize[3] = {3, 3, 2}, meshOffset[3] = {0, 3, 6};
+  for (int a = 0; a < 3; a++) {
+    glEnableVertexAttribArray(a);
+    glVertexAttribPointer(a, meshSize[a], GL_FLOAT, GL_FALSE,
+                          8 * sizeof(float),
+                          (void *)(sizeof(float) * meshOffset[a]));
+  }
+  glGenBuffers(1, &bullseyeGL.instBuf);
+  glBindBuffer(GL_ARRAY_BUFFER, bullseyeGL.instBuf);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(bullseyeGL.inst), NULL,
+               GL_STREAM_DRAW);
+  // Center + radius, X axis + rings, normal, color
+  const int instSize[4] = {4, 4, 3, 3}, instOffset[4] = {0, 4, 8, 11};
+  for (int a = 0; a < 4; a++) {
+    glEnableVertexAttribArray(3 + a);
+    glVertexAttribPointer(3 + a, instSize[a], GL_FLOAT, GL_FALSE,
+                          BULLSEYE_INST * sizeof(float),
+                          (void *)(sizeof(float) * instOffset[a]));
+    glVertexAttribDivisor(3 + a, 1);
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  ErrCheck("buildBullseyeGL");
+  bullseyeGL.built = 1;
 }
+#endif
 
 /*
  *  Draw the scene with multiple bullseye targets
- *  @param zh z angle (degrees)
+ *  With a shader every target is one instance of a procedural mesh and the
+ *  table is one draw call; otherwise each target is drawn with drawRings.
+ *  The table's frames are already orthonormal, so neither path rebuilds
+ *  an orientation.
+ *  @param targets target poses
  *  @param texture texture ID
+ *  @param shader bullseye.vert/bullseye.frag program (0 for immediate mode)
  */
-void drawBullseyeScene(double zh, unsigned int texture) {
-  Bullseye b;
-  int i = 0;
-  while (getBullseye(i, zh, &b)) {
-    drawBullseye(&b, texture);
-    i++;
+void drawBullseyeScene(const TargetTable *targets, unsigned int texture,
+                       unsigned int shader) {
+  if (!targets->count) return;
+
+#ifdef GL_VERSION_3_3
+  if (shader) {
+    if (!bullseyeGL.built) buildBullseyeGL();
+    for (int i = 0; i < targets->count; i++) {
+      const TargetState *t = &targets->t[i];
+      const TargetPose *p = &t->pose;
+      float *o = bullseyeGL.inst + BULLSEYE_INST * i;
+      for (int a = 0; a < 3; a++) {
+        o[a] = p->c[a];
+        o[4 + a] = p->f[a];
+        o[8 + a] = p->n[a];
+        o[11 + a] = t->color[a];
+      }
+      o[3] = t->radius;
+      o[7] = t->rings;
+    }
+
+    // Orphan the buffer so the upload doesn't wait on last frame's draw
+    glBindBuffer(GL_ARRAY_BUFFER, bullseyeGL.instBuf);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(bullseyeGL.inst), NULL,
+                 GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0,
+                    sizeof(float) * BULLSEYE_INST * targets->count,
+                    bullseyeGL.inst);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(shader);
+    glUniform1i(glGetUniformLocation(shader, "lit"),
+                glIsEnabled(GL_LIGHTING) ? 1 : 0);
+    glUniform1i(glGetUniformLocation(shader, "fogEnabled"),
+                glIsEnabled(GL_FOG) ? 1 : 0);
+    glUniform1i(glGetUniformLocation(shader, "useTexture"), texture ? 1 : 0);
+    glUniform1i(glGetUniformLocation(shader, "tex"), 0);
+    if (texture) glBindTexture(GL_TEXTURE_2D, texture);
+    glBindVertexArray(bullseyeGL.vao);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, bullseyeGL.meshVerts,
+                          targets->count);
+    glBindVertexArray(0);
+    glUseProgram(0);
+    return;
+  }
+#endif
+
+  // Fallback: immediate-mode rings, one target at a time
+  for (int i = 0; i < targets->count; i++) {
+    const TargetState *t = &targets->t[i];
+    const TargetPose *p = &t->pose;
+    const double mat[16] = {
+      p->f[0], p->f[1], p->f[2], 0.0, // local +X
+      p->u[0], p->u[1], p->u[2], 0.0, // local +Y
+      p->n[0], p->n[1], p->n[2], 0.0, // local +Z (face normal)
+      p->c[0], p->c[1], p->c[2], 1.0,
+    };
+    glPushMatrix();
+    glMultMatrixd(mat);
+    drawRings(t->radius, t->rings, t->color, texture);
+    glPopMatrix();
   }
 }
 
+/*
+ *  Broadphase over the targets, refit whenever the tick's animation
+ *  interval changes (once per simulation tick)
+ */
+#define MAX_TARGETS TARGET_TABLE_MAX
+#define MAX_CANDIDATES 32
+#define CCD_MAX_STEP 5.0 // Largest target angle per linear sub-interval (deg)
+// Thread-local so simulator workers each refit their own grid
+static _Thread_local Broadphase targetGrid;
+static _Thread_local double targetGridZh0 = 0.0, targetGridZh1 = 0.0;
+static _Thread_local int targetGridReady = 0;
 
 /*
- *  Check collision between arrow and bullseyes
- *  @param arrowPtr pointer to Arrow structure
+ *  Pose between two poses (center lerped, frame lerped and renormalized)
+ *  @param a pose at r = 0
+ *  @param b pose at r = 1
+ *  @param r blend factor (0-1)
+ *  @param p pose (output)
+ */
+static void lerpPose(const TargetPose *a, const TargetPose *b, double r,
+                     TargetPose *p) {
+  for (int k = 0; k < 3; k++) {
+    p->c[k] = a->c[k] + r * (b->c[k] - a->c[k]);
+    p->f[k] = a->f[k] + r * (b->f[k] - a->f[k]);
+    p->u[k] = a->u[k] + r * (b->u[k] - a->u[k]);
+  }
+  Vec3Normalize(&p->f[0], &p->f[1], &p->f[2]);
+  Vec3Normalize(&p->u[0], &p->u[1], &p->u[2]);
+  Vec3Cross(p->f[0], p->f[1], p->f[2], p->u[0], p->u[1], p->u[2],
+            &p->n[0], &p->n[1], &p->n[2]);
+  Vec3Normalize(&p->n[0], &p->n[1], &p->n[2]);
+}
+
+/*
+ *  Number of linear sub-intervals for a target angle change; within one the
+ *  target's motion along its arc is treated as linear
+ *  @param dzh angle change over the tick (degrees)
+ */
+static int sweepSteps(double dzh) {
+  int steps = (int)ceil(fabs(dzh) / CCD_MAX_STEP);
+  return steps < 1 ? 1 : steps;
+}
+
+/*
+ *  Angle change from zh0 to zh1, unwrapped across 360
+ */
+static double angleStep(double zh0, double zh1) {
+  double dzh = zh1 - zh0;
+  if (dzh > 180.0) dzh -= 360.0;
+  if (dzh < -180.0) dzh += 360.0;
+  return dzh;
+}
+
+/*
+ *  State of a target with its center at c
+ *  Targets face their layout's aim point in XZ with local Y up, so the
+ *  frame is orthonormal by construction: f = (vz, 0, -vx), n = f x u =
+ *  (vx, 0, vz) for the unit direction v toward the aim point.
+ *  @param d target definition
+ *  @param c center
+ *  @param t state (output)
+ */
+static void stateOf(const TargetDef *d, const double c[3], TargetState *t) {
+  double vx = d->face[0] - c[0];
+  double vz = d->face[1] - c[2];
+  const double len = sqrt(vx * vx + vz * vz);
+  if (len < 1e-6) {
+    vx = 0.0;
+    vz = 1.0;
+  } else {
+    vx /= len;
+    vz /= len;
+  }
+  TargetPose *p = &t->pose;
+  for (int a = 0; a < 3; a++) {
+    p->c[a] = c[a];
+    t->color[a] = d->color[a];
+  }
+  p->f[0] = vz;  p->f[1] = 0.0; p->f[2] = -vx;
+  p->u[0] = 0.0; p->u[1] = 1.0; p->u[2] = 0.0;
+  p->n[0] = vx;  p->n[1] = 0.0; p->n[2] = vz;
+  t->radius = d->radius;
+  t->rings = d->rings;
+}
+
+/*
+ *  State of one target at an animation angle
+ */
+static void stateAt(int index, double zh, TargetState *t) {
+  double c[3];
+  targetLayoutPositions(zh, index, 1, &c);
+  stateOf(targetLayoutDef(index), c, t);
+}
+
+/*
+ *  Build the pose of every target at an animation angle
+ *  All centers come from one pass over the layout's motion tables, then
+ *  each target's frame is a few multiplies and one sqrt.
+ *  @param table table to fill
  *  @param zh animation angle
+ */
+void updateTargetTable(TargetTable *table, double zh) {
+  double c[TARGET_TABLE_MAX][3];
+  table->zh = zh;
+  table->count = targetLayoutCount();
+  targetLayoutPositions(zh, 0, table->count, c);
+  for (int i = 0; i < table->count; i++)
+    stateOf(targetLayoutDef(i), c[i], &table->t[i]);
+}
+
+/*
+ *  Blend two tables (for drawing between simulation ticks)
+ *  @param a table at alpha = 0
+ *  @param b table at alpha = 1
+ *  @param alpha blend factor (0-1)
+ *  @param out blended table (output)
+ */
+void lerpTargetTable(const TargetTable *a, const TargetTable *b, double alpha,
+                     TargetTable *out) {
+  out->zh = fmod(a->zh + alpha * angleStep(a->zh, b->zh) + 360.0, 360.0);
+  out->count = a->count < b->count ? a->count : b->count;
+  for (int i = 0; i < out->count; i++) {
+    out->t[i] = b->t[i];
+    lerpPose(&a->t[i].pose, &b->t[i].pose, alpha, &out->t[i].pose);
+  }
+}
+
+/*
+ *  Pose the targets' scene nodes from a table
+ *  @param scene scene graph
+ *  @param nodes scene node of each target (table count entries)
+ *  @param table target poses
+ */
+void poseTargetNodes(SceneGraph *scene, const int *nodes,
+                     const TargetTable *table) {
+  for (int i = 0; i < table->count; i++) {
+    const TargetPose *p = &table->t[i].pose;
+    SceneTransform m;
+    for (int a = 0; a < 3; a++) {
+      m[a] = p->c[a];
+      m[3 + a] = p->f[a];
+      m[6 + a] = p->u[a];
+      m[9 + a] = p->n[a];
+    }
+    setSceneNodeLocal(scene, nodes[i], m);
+  }
+}
+
+/*
+ *  Pose of a target at sub-interval k of steps between two states
+ *  The ends are the given states; only interior poses (large angle steps)
+ *  are evaluated.
+ */
+static void sweepPose(const TargetState *a, const TargetState *b, int index,
+                      double zh0, double dzh, int k, int steps,
+                      TargetPose *p) {
+  if (k == 0) {
+    *p = a->pose;
+  } else if (k == steps) {
+    *p = b->pose;
+  } else {
+    TargetState s;
+    stateAt(index, zh0 + dzh * k / steps, &s);
+    *p = s.pose;
+  }
+}
+
+/*
+ *  Bounds of one target while it moves from state a to state b
+ *  The union of its exact disk AABBs at every sub-interval pose (along axis
+ *  a a disk extends radius * sqrt(1 - n_a^2)), so it covers the whole sweep.
+ *  @param index target index
+ *  @param a target at the start (animation angle zh0)
+ *  @param b target at the end (zh0 + dzh)
+ *  @param zh0 animation angle at the start
+ *  @param dzh angle change
+ *  @param min box minimum corner (output)
+ *  @param max box maximum corner (output)
+ */
+static void sweptTargetBox(int index, const TargetState *a,
+                           const TargetState *b, double zh0, double dzh,
+                           double min[3], double max[3]) {
+  const int steps = sweepSteps(dzh);
+  for (int c = 0; c < 3; c++) {
+    min[c] = 1e30;
+    max[c] = -1e30;
+  }
+  for (int k = 0; k <= steps; k++) {
+    TargetPose p;
+    sweepPose(a, b, index, zh0, dzh, k, steps, &p);
+    for (int c = 0; c < 3; c++) {
+      double e = a->radius * sqrt(fmax(0.0, 1.0 - p.n[c] * p.n[c])) + 0.05;
+      min[c] = fmin(min[c], p.c[c] - e);
+      max[c] = fmax(max[c], p.c[c] + e);
+    }
+  }
+}
+
+/*
+ *  Rebuild the target grid for the tick from t0 to t1
+ *  @param t0 targets at the start of the tick
+ *  @param t1 targets at the end of the tick
+ *  @param dzh angle change over the tick
+ */
+static void refitTargetGrid(const TargetTable *t0, const TargetTable *t1,
+                            double dzh) {
+  if (!targetGrid.capacity && !initBroadphase(&targetGrid, 4.0, MAX_TARGETS))
+    Fatal("Cannot allocate target broadphase\n");
+  broadphaseClear(&targetGrid);
+
+  for (int i = 0; i < t0->count; i++) {
+    double min[3], max[3];
+    sweptTargetBox(i, &t0->t[i], &t1->t[i], t0->zh, dzh, min, max);
+    // Box index == target index because targets are added in order
+    broadphaseAdd(&targetGrid, min, max);
+  }
+  broadphaseBuild(&targetGrid);
+  targetGridReady = 1;
+}
+
+/*
+ *  Roots of a*r^2 + b*r + c in [0,1], ascending
+ *  @param r roots (output, up to 2)
+ *  @return number of roots
+ */
+static int unitRoots(double a, double b, double c, double r[2]) {
+  int n = 0;
+  if (fabs(a) < 1e-12) {
+    if (fabs(b) < 1e-12) return 0;
+    r[n++] = -c / b;
+  } else {
+    double disc = b * b - 4 * a * c;
+    if (disc < 0) return 0;
+    // Numerically stable form (no cancellation between b and sqrt(disc))
+    double q = -0.5 * (b + copysign(sqrt(disc), b));
+    r[n++] = q / a;
+    if (fabs(q) > 1e-12) r[n++] = c / q;
+  }
+  if (n == 2 && r[1] < r[0]) {
+    double t = r[0];
+    r[0] = r[1];
+    r[1] = t;
+  }
+  // Keep only roots inside the interval
+  int m = 0;
+  for (int k = 0; k < n; k++)
+    if (r[k] >= 0.0 && r[k] <= 1.0) r[m++] = r[k];
+  return m;
+}
+
+/*
+ *  Earliest impact of a tip segment on one moving target
+ */
+typedef struct {
+  double s;        // Time of impact over the interval (0-1)
+  double dist;     // Distance of the hit from the target center
+  double hit[3];   // Hit point
+  double radius;   // Target radius
+  int rings;       // Target ring count
+  TargetPose pose; // Target pose at impact
+} SweepHit;
+
+/*
+ *  Sweep a tip segment against one target moving from state a to state b
+ *  The tip moves linearly from tip0 to tip1 over the same interval.
+ *  @param index target index
+ *  @param a target at the start of the interval (animation angle zh0)
+ *  @param b target at the end of the interval (zh0 + dzh)
+ *  @param zh0 animation angle at the start
+ *  @param dzh angle change over the interval
+ *  @param maxS only impacts earlier than this count (an earlier hit elsewhere)
+ *  @param h impact (output)
+ *  @return 1 if the target is hit before maxS
+ */
+static int sweepTarget(int index, const double tip0[3], const double tip1[3],
+                       const TargetState *a, const TargetState *b,
+                       double zh0, double dzh, double maxS, SweepHit *h) {
+  const int steps = sweepSteps(dzh);
+  const TargetState *t = a;
+  TargetPose A = a->pose, B;
+  for (int k = 0; k < steps; k++) {
+    const double s0 = (double)k / steps, s1 = (double)(k + 1) / steps;
+    if (s0 >= maxS) break;
+    sweepPose(a, b, index, zh0, dzh, k + 1, steps, &B);
+
+    // Tip relative to the center, and the normal, both linear in r
+    double q0[3], dq[3], dn[3];
+    for (int axis = 0; axis < 3; axis++) {
+      double pa = tip0[axis] + s0 * (tip1[axis] - tip0[axis]);
+      double pb = tip0[axis] + s1 * (tip1[axis] - tip0[axis]);
+      q0[axis] = pa - A.c[axis];
+      dq[axis] = (pb - B.c[axis]) - q0[axis];
+      dn[axis] = B.n[axis] - A.n[axis];
+    }
+    double roots[2];
+    int n = unitRoots(Vec3Dot(dn[0], dn[1], dn[2], dq[0], dq[1], dq[2]),
+                      Vec3Dot(A.n[0], A.n[1], A.n[2], dq[0], dq[1], dq[2]) +
+                          Vec3Dot(dn[0], dn[1], dn[2], q0[0], q0[1], q0[2]),
+                      Vec3Dot(A.n[0], A.n[1], A.n[2], q0[0], q0[1], q0[2]),
+                      roots);
+
+    // First root inside the disk is this target's time of impact
+    for (int r = 0; r < n; r++) {
+      const double s = s0 + roots[r] * (s1 - s0);
+      if (s >= maxS) break;
+      TargetPose P;
+      lerpPose(&A, &B, roots[r], &P);
+      double e[3], dist2 = 0.0;
+      for (int axis = 0; axis < 3; axis++) {
+        e[axis] = tip0[axis] + s * (tip1[axis] - tip0[axis]) - P.c[axis];
+        dist2 += e[axis] * e[axis];
+      }
+      if (dist2 > t->radius * t->radius) continue;
+      h->s = s;
+      h->dist = sqrt(dist2);
+      h->radius = t->radius;
+      h->rings = t->rings;
+      h->pose = P;
+      for (int axis = 0; axis < 3; axis++) h->hit[axis] = P.c[axis] + e[axis];
+      return 1;
+    }
+    A = B;
+  }
+  return 0;
+}
+
+/*
+ *  Ring hit at a distance from the target center (0 = bullseye)
+ *  @param radius target radius
+ *  @param rings number of rings
+ *  @param dist distance of the hit from the center
+ *  @return ring index (0 to rings-1)
+ */
+int bullseyeRing(double radius, int rings, double dist) {
+  double ringWidth = radius / rings;
+  int ringIndex = (int)(dist / ringWidth);
+  return ringIndex >= rings ? rings - 1 : ringIndex;
+}
+
+/*
+ *  Points for a hit in a ring
+ *  @param rings number of rings on the target
+ *  @param ringIndex ring hit (0 = bullseye)
+ *  @return score
+ */
+int bullseyeScore(int rings, int ringIndex) {
+  // Scoring Logic:
+  // Fewer rings = harder target = more points per ring.
+  // Base multiplier scales inversely with ring count.
+  // The 6-ring main target is the baseline (multiplier 1).
+  // Multiplier = 6.0 / rings
+  double multiplier = 6.0 / rings;
+  
+  int score = (int)((rings - ringIndex) * 10 * multiplier);
+  if (ringIndex == 0) score += (int)(20 * multiplier); // Scale bonus too
+  return score;
+}
+
+/*
+ *  Check collision between arrow and bullseyes over one tick
+ *  Continuous (swept-vs-swept): the arrow tip moves from its previous to its
+ *  current position while each target moves from its pose at zh0 to its
+ *  pose at zh1. In each sub-interval both motions are linear, so the tip's
+ *  signed distance to the moving plane, n(s).(p(s) - c(s)), is a quadratic
+ *  in s and the time of impact is its earliest root that lands inside the
+ *  disk. Only targets whose swept boxes overlap the tip's segment are tested.
+ *  Target poses at both ends of the tick come from the tick's tables.
+ *  @param arrowPtr pointer to Arrow structure
+ *  @param t0 targets at the start of the tick
+ *  @param t1 targets at the end of the tick
  *  @return score (0 if no hit)
  */
-int checkBullseyeCollision(void *arrowPtr, double zh) {
+int checkBullseyeCollision(void *arrowPtr, const TargetTable *t0,
+                           const TargetTable *t1) {
   Arrow *arrow = (Arrow *)arrowPtr;
   if (!arrow || !arrow->active || arrow->stuck) return 0;
 
   // Ray from prev to current (TIP of the arrow)
-  // Arrow length = shaft (3.0) + tip (0.5) = 3.5
-  const double arrowLen = 3.5;
-  
   // Tip positions
-  double tip1x = arrow->prevX + arrow->dx * arrowLen;
-  double tip1y = arrow->prevY + arrow->dy * arrowLen;
-  double tip1z = arrow->prevZ + arrow->dz * arrowLen;
+  double tip0[3] = {arrow->prevX + arrow->dx * ARROW_LENGTH,
+                    arrow->prevY + arrow->dy * ARROW_LENGTH,
+                    arrow->prevZ + arrow->dz * ARROW_LENGTH};
+  double tip1[3] = {arrow->x + arrow->dx * ARROW_LENGTH,
+                    arrow->y + arrow->dy * ARROW_LENGTH,
+                    arrow->z + arrow->dz * ARROW_LENGTH};
+
+  // Angle change over the tick, unwrapped across 360
+  const double dzh = angleStep(t0->zh, t1->zh);
+
+  // Broadphase: targets whose sweep is near the tip's segment
+  if (!targetGridReady || t0->zh != targetGridZh0 || t1->zh != targetGridZh1) {
+    refitTargetGrid(t0, t1, dzh);
+    targetGridZh0 = t0->zh;
+    targetGridZh1 = t1->zh;
+  }
+  int candidates[MAX_CANDIDATES];
+  int count = broadphaseQuerySegment(&targetGrid, tip0, tip1, candidates,
+                                     MAX_CANDIDATES);
+  if (count == 0) return 0;
+  // More overlaps than the candidate buffer holds (dense layouts, long
+  // ticks): test every target rather than drop real hits
+  const int fullScan = count > MAX_CANDIDATES;
+  if (fullScan) count = t0->count;
+
+  // Narrow phase: earliest time of impact among the candidates
+  SweepHit best = {0}, h;
+  int bestIndex = -1;
+  best.s = 2.0;
+  for (int c = 0; c < count; c++) {
+    const int i = fullScan ? c : candidates[c];
+    if (i >= t0->count || !sweepTarget(i, tip0, tip1, &t0->t[i], &t1->t[i],
+                                       t0->zh, dzh, best.s, &h))
+      continue;
+    best = h;
+    bestIndex = i;
+  }
+  if (bestIndex < 0) return 0;
+
+  // Hit! Calculate score
+  const int ring = bullseyeRing(best.radius, best.rings, best.dist);
+  int score = bullseyeScore(best.rings, ring);
+
+  // STICK THE ARROW
+  arrow->stuck = 1;
+  arrow->stuckTargetIndex = bestIndex;
+  arrow->stuckRing = ring;
+  arrow->active = 1; // Keep active so it gets drawn, but physics will skip it
   
-  double tip2x = arrow->x + arrow->dx * arrowLen;
-  double tip2y = arrow->y + arrow->dy * arrowLen;
-  double tip2z = arrow->z + arrow->dz * arrowLen;
-
-  double dirx = tip2x - tip1x, diry = tip2y - tip1y, dirz = tip2z - tip1z;
-  double len = sqrt(dirx*dirx + diry*diry + dirz*dirz);
-  if (len < 1e-6) return 0; // Not moving
-
-  // Normalize direction
-  double ndx = dirx / len, ndy = diry / len, ndz = dirz / len;
-
-  Bullseye b;
-  int i = 0;
-  while (getBullseye(i, zh, &b)) {
-    // Calculate correct normal vector for the bullseye plane
-    double fx = b.dx, fy = b.dy, fz = b.dz;
-    double ux = b.ux, uy = b.uy, uz = b.uz;
-    double nx, ny, nz; // Normal
-    Vec3Cross(fx, fy, fz, ux, uy, uz, &nx, &ny, &nz);
-    Vec3Normalize(&nx, &ny, &nz);
-
-    // Plane equation: nx*x + ny*y + nz*z + d = 0
-    double d = -(nx * b.x + ny * b.y + nz * b.z);
-
-    // Ray-plane intersection: t = -(N.P1 + d) / (N.D)
-    double denom = nx * ndx + ny * ndy + nz * ndz;
-    
-    // Check if moving towards the face (denom < 0) or generic intersection
-    if (fabs(denom) > 1e-6) {
-      double t = -(nx * tip1x + ny * tip1y + nz * tip1z + d) / denom;
-      if (t >= 0 && t <= len) {
-        // Intersection point (World coords of hit)
-        double ix = tip1x + t * ndx;
-        double iy = tip1y + t * ndy;
-        double iz = tip1z + t * ndz;
-
-        // Check distance from center
-        double dist = sqrt(pow(ix - b.x, 2) + pow(iy - b.y, 2) + pow(iz - b.z, 2));
-        if (dist <= b.radius) {
-          // Hit! Calculate score
-          double ringWidth = b.radius / b.rings;
-          int ringIndex = (int)(dist / ringWidth);
-          if (ringIndex >= b.rings) ringIndex = b.rings - 1;
-
-          // Scoring Logic:
-          // Fewer rings = harder target = more points per ring.
-          // Base multiplier scales inversely with ring count.
-          // Max rings is 6 (from getBullseye).
-          // Multiplier = 6.0 / b.rings
-          double multiplier = 6.0 / b.rings;
-          
-          int score = (int)((b.rings - ringIndex) * 10 * multiplier);
-          if (ringIndex == 0) score += (int)(20 * multiplier); // Scale bonus too
-
-          // STICK THE ARROW
-          arrow->stuck = 1;
-          arrow->stuckTargetIndex = i;
-          arrow->active = 1; // Keep active so it gets drawn, but physics will skip it
-          
-          // Calculate relative position/rotation
-          // We need to transform the intersection point (ix, iy, iz) into the bullseye's local space
-          // Local space basis: X=Forward, Y=Up, Z=Normal
-          // P_local = [X Y Z]^T * (P_world - Origin)
-          
-          double relX = ix - b.x;
-          double relY = iy - b.y;
-          double relZ = iz - b.z;
-          
-          // Project onto basis vectors
-          // The relative position of the TIP
-          double tipRelX = relX * fx + relY * fy + relZ * fz;
-          double tipRelY = relX * ux + relY * uy + relZ * uz;
-          double tipRelZ = relX * nx + relY * ny + relZ * nz;
-          
-          // Store the relative position of the ARROW ORIGIN (Tail)
-          // Arrow Origin = Tip - Dir * arrowLen
-          double localDx = arrow->dx * fx + arrow->dy * fy + arrow->dz * fz;
-          double localDy = arrow->dx * ux + arrow->dy * uy + arrow->dz * uz;
-          double localDz = arrow->dx * nx + arrow->dy * ny + arrow->dz * nz;
-          
-          arrow->stuckRelX = tipRelX - localDx * arrowLen;
-          arrow->stuckRelY = tipRelY - localDy * arrowLen;
-          arrow->stuckRelZ = tipRelZ - localDz * arrowLen;
-          
-          arrow->stuckRelDx = localDx;
-          arrow->stuckRelDy = localDy;
-          arrow->stuckRelDz = localDz;
-          
-          // Snap arrow position to intersection point exactly (offset by length)
-          arrow->x = ix - arrow->dx * arrowLen;
-          arrow->y = iy - arrow->dy * arrowLen;
-          arrow->z = iz - arrow->dz * arrowLen;
-
-          return score;
-        }
-      }
+  // Calculate relative position/rotation in the target's frame at the
+  // time of impact; it is rigid, so the same offsets hold at any later zh
+  // Local space basis: X=Forward, Y=Up, Z=Normal
+  // P_local = [X Y Z]^T * (P_world - Origin)
+  const double *f = best.pose.f, *u = best.pose.u, *n = best.pose.n;
+  const double *hit = best.hit;
+  double relX = hit[0] - best.pose.c[0];
+  double relY = hit[1] - best.pose.c[1];
+  double relZ = hit[2] - best.pose.c[2];
+  
+  // Project onto basis vectors
+  // The relative position of the TIP
+  double tipRelX = Vec3Dot(relX, relY, relZ, f[0], f[1], f[2]);
+  double tipRelY = Vec3Dot(relX, relY, relZ, u[0], u[1], u[2]);
+  double tipRelZ = Vec3Dot(relX, relY, relZ, n[0], n[1], n[2]);
+  
+  // Store the relative position of the ARROW ORIGIN (Tail)
+  // Arrow Origin = Tip - Dir * ARROW_LENGTH
+  double localDx = Vec3Dot(arrow->dx, arrow->dy, arrow->dz, f[0], f[1], f[2]);
+  double localDy = Vec3Dot(arrow->dx, arrow->dy, arrow->dz, u[0], u[1], u[2]);
+  double localDz = Vec3Dot(arrow->dx, arrow->dy, arrow->dz, n[0], n[1], n[2]);
+  
+  arrow->stuckRelX = tipRelX - localDx * ARROW_LENGTH;
+  arrow->stuckRelY = tipRelY - localDy * ARROW_LENGTH;
+  arrow->stuckRelZ = tipRelZ - localDz * ARROW_LENGTH;
+  
+  arrow->stuckRelDx = localDx;
+  arrow->stuckRelDy = localDy;
+  arrow->stuckRelDz = localDz;
+  
+  // Snap arrow position to intersection point exactly (offset by length)
+  arrow->x = hit[0] - arrow->dx * ARROW_LENGTH;
+  arrow->y = hit[1] - arrow->dy * ARROW_LENGTH;
+  arrow->z = hit[2] - arrow->dz * ARROW_LENGTH;
+
+  return score;
+}
+
+/*
+ *  First target hit along a predicted flight path
+ *  Path points are equally spaced in time and targets advance dzh degrees
+ *  between consecutive points. Segments are first tested against each
+ *  target's bounds over its whole motion cycle (from the layout), so only
+ *  targets near a segment are posed and swept with the same test as
+ *  checkBullseyeCollision.
+ *  @param path arrow tip positions along the flight
+ *  @param n number of points
+ *  @param zh animation angle at the first point
+ *  @param dzh angle change between points
+ *  @param hit first hit (output)
+ *  @return 1 if a target is hit
+ */
+int sweepPathBullseyes(const double (*path)[3], int n, double zh, double dzh,
+                       BullseyeHit *hit) {
+  const int targets = targetLayoutCount();
+  for (int k = 0; k + 1 < n; k++) {
+    const double *p0 = path[k], *p1 = path[k + 1];
+    SweepHit best = {0}, h;
+    int bestIndex = -1;
+    best.s = 2.0;
+    for (int i = 0; i < targets; i++) {
+      const TargetDef *d = targetLayoutDef(i);
+      const double e = d->radius + 0.05;
+      if (fmax(p0[0], p1[0]) < d->lo[0] - e ||
+          fmin(p0[0], p1[0]) > d->hi[0] + e ||
+          fmax(p0[1], p1[1]) < d->lo[1] - e ||
+          fmin(p0[1], p1[1]) > d->hi[1] + e ||
+          fmax(p0[2], p1[2]) < d->lo[2] - e ||
+          fmin(p0[2], p1[2]) > d->hi[2] + e)
+        continue;
+      TargetState a, b;
+      stateAt(i, zh + dzh * k, &a);
+      stateAt(i, zh + dzh * (k + 1), &b);
+      if (!sweepTarget(i, p0, p1, &a, &b, zh + dzh * k, dzh, best.s, &h))
+        continue;
+      best = h;
+      bestIndex = i;
+    }
+    if (bestIndex >= 0) {
+      hit->target = bestIndex;
+      hit->score = bullseyeScore(
+          best.rings, bullseyeRing(best.radius, best.rings, best.dist));
+      hit->t = k + best.s;
+      hit->x = best.hit[0];
+      hit->y = best.hit[1];
+      hit->z = best.hit[2];
+      return 1;
     }
-    i++;
   }
   return 0;
 }
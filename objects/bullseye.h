@@ -1,61 +1,137 @@
 /*
  *  Bullseye object - header file
- *  Defines bullseye structure and drawing functions
+ *  Defines target poses, drawing and collision functions
  */
 
 #ifndef OBJECTS_BULLSEYE_H
 #define OBJECTS_BULLSEYE_H
 
+#include "targets.h"
+#include "../scene.h"
+
 /*
- *  Bullseye description for passing parameters around
+ *  Target pose: center and orthonormal frame
+ *  (f = local X, u = local Y, n = face normal)
  */
 typedef struct {
-  /* world position */
-  double x, y, z;
-  /* local X direction vector (orientation) */
-  double dx, dy, dz;
-  /* local Y up vector (orientation) */
-  double ux, uy, uz;
-  /* geometry */
-  double radius; /* outer radius */
-  int rings;     /* number of rings */
-  /* color for alternating rings */
-  double r, g, b;
-} Bullseye;
+  double c[3], f[3], u[3], n[3];
+} TargetPose;
 
 /*
- *  Function prototypes
+ *  One target at one animation angle
+ */
+typedef struct {
+  TargetPose pose; /* position and orientation */
+  double radius;   /* outer radius */
+  int rings;       /* number of rings */
+  double color[3]; /* color for alternating rings */
+} TargetState;
+
+/*
+ *  Every target at one animation angle, built once per simulation tick and
+ *  shared by drawing, collisions and stuck arrows
+ */
+#define TARGET_TABLE_MAX TARGET_MAX
+typedef struct {
+  double zh;   /* animation angle the table was built for */
+  int count;   /* number of targets */
+  TargetState t[TARGET_TABLE_MAX];
+} TargetTable;
+
+/*
+ *  Predicted target hit along a flight path
  */
+typedef struct {
+  int target;     /* target index */
+  int score;      /* points the hit would score */
+  double t;       /* position along the path: segment index + fraction */
+  double x, y, z; /* hit point */
+} BullseyeHit;
 
 /*
- *  Draw a single bullseye from a Bullseye struct
- *  @param b pointer to Bullseye structure
- *  @param texture OpenGL texture ID (0 for no texture)
+ *  Function prototypes
  */
-void drawBullseye(const Bullseye *b, unsigned int texture);
 
 /*
  *  Draw the scene with multiple bullseye targets
- *  @param zh animation angle in degrees for bullseye motion
+ *  With a shader (OpenGL 3.3+) all targets are one instanced draw whose
+ *  rings are computed per pixel; otherwise each is drawn with ring strips.
+ *  @param targets target poses to draw
  *  @param texture OpenGL texture ID for bullseyes
+ *  @param shader bullseye.vert/bullseye.frag program (0 for immediate mode)
  */
-void drawBullseyeScene(double zh, unsigned int texture);
+void drawBullseyeScene(const TargetTable *targets, unsigned int texture,
+                       unsigned int shader);
 
 /*
- *  Get a bullseye definition by index
- *  @param index index of the bullseye (0 to N-1)
+ *  Build the pose of every target at an animation angle
+ *  @param table table to fill
  *  @param zh animation angle
- *  @param b pointer to Bullseye structure to fill
- *  @return 1 if index is valid, 0 otherwise
  */
-int getBullseye(int index, double zh, Bullseye *b);
+void updateTargetTable(TargetTable *table, double zh);
 
 /*
- *  Check collision between arrow and bullseyes
- *  @param arrow pointer to Arrow structure (modified if stuck)
- *  @param zh animation angle
+ *  Blend two tables (for drawing between simulation ticks)
+ *  @param a table at alpha = 0
+ *  @param b table at alpha = 1 (same targets)
+ *  @param alpha blend factor (0-1)
+ *  @param out blended table (output)
+ */
+void lerpTargetTable(const TargetTable *a, const TargetTable *b, double alpha,
+                     TargetTable *out);
+
+/*
+ *  Pose the targets' scene nodes from a table
+ *  A target that didn't move leaves its node (and everything attached to
+ *  it) clean.
+ *  @param scene scene graph
+ *  @param nodes scene node of each target (table count entries)
+ *  @param table target poses
+ */
+void poseTargetNodes(SceneGraph *scene, const int *nodes,
+                     const TargetTable *table);
+
+/*
+ *  Ring hit at a distance from the target center (0 = bullseye)
+ *  @param radius target radius
+ *  @param rings number of rings
+ *  @param dist distance of the hit from the center
+ *  @return ring index (0 to rings-1)
+ */
+int bullseyeRing(double radius, int rings, double dist);
+
+/*
+ *  Points for a hit in a ring (fewer rings = more points per ring)
+ *  @param rings number of rings on the target
+ *  @param ringIndex ring hit (0 = bullseye)
+ *  @return score
+ */
+int bullseyeScore(int rings, int ringIndex);
+
+/*
+ *  Check collision between arrow and bullseyes over one simulation tick
+ *  (continuous: targets move from their t0 pose to their t1 pose while
+ *  the arrow moves from its previous to its current position)
+ *  @param arrow pointer to Arrow structure (modified if stuck: target, ring
+ *               and pose relative to the target)
+ *  @param t0 targets at the start of the tick
+ *  @param t1 targets at the end of the tick
  *  @return score (0 if no hit)
  */
-int checkBullseyeCollision(void *arrow, double zh); // void* to avoid circular dependency if arrow.h not included
+int checkBullseyeCollision(void *arrow, const TargetTable *t0,
+                           const TargetTable *t1); // void* to avoid circular dependency if arrow.h not included
+
+/*
+ *  First target hit along a predicted flight path (targets keep moving
+ *  while the arrow flies)
+ *  @param path arrow tip positions, equally spaced in time
+ *  @param n number of points
+ *  @param zh animation angle at the first point
+ *  @param dzh angle change between points
+ *  @param hit first hit (output)
+ *  @return 1 if a target is hit
+ */
+int sweepPathBullseyes(const double (*path)[3], int n, double zh, double dzh,
+                       BullseyeHit *hit);
 
 #endif
@@ -0,0 +1,333 @@
+/*
+ *  Ground-cover object - implementation
+ *  Blades are scattered once over the island from a procedural density map
+ *  into square chunks. Each chunk's instances are shuffled, so drawing the
+ *  first N of them is an even thinning of the whole chunk: distance LOD is
+ *  just a smaller instance count. Visible chunks are gathered into one
+ *  multi-draw-indirect call (OpenGL 4.3) or one instanced draw per chunk.
+ */
+
+#include "grass.h"
+#include "ground.h"
+#include "../utils.h"
+
+#define GRASS_CHUNK 8.0       // Chunk side in world units
+#define GRASS_DENSITY 96.0    // Peak blades per square unit
+#define GRASS_MAP 128         // Density map resolution
+#define GRASS_LOD_NEAR 8.0    // Full density up to this distance
+#define GRASS_LOD_FAR 70.0    // No grass beyond this distance
+#define GRASS_MAX_HEIGHT 0.9  // Tallest blade (for chunk bounds)
+
+/*
+ *  Per-chunk instance range and bounds
+ */
+typedef struct {
+  float minX, minY, minZ, maxX, maxY, maxZ;
+  int first; // First instance in the instance buffer
+  int count; // Instances in the chunk (shuffled)
+} GrassChunk;
+
+/*
+ *  Draw command layout consumed by glMultiDrawArraysIndirect
+ */
+typedef struct {
+  unsigned int count, instanceCount, first, baseInstance;
+} GrassDrawCmd;
+
+static struct {
+  int built;
+  double radius;
+  unsigned int vao, bladeBuf, instBuf, cmdBuf;
+  int indirect;               // Multi-draw indirect available
+  GrassChunk *chunks;
+  GrassDrawCmd *cmds;
+  int numChunks;
+  int total;                  // Blades scattered
+  int drawn;                  // Blades submitted last frame
+  float density[GRASS_MAP * GRASS_MAP];
+} grass;
+
+//  Blade strip: (side -1..1, height fraction 0..1), tapering to a tip
+static const float bladeVerts[] = {-1, 0,        1, 0,        -1, 1.0f / 3,
+                                   1,  1.0f / 3, -1, 2.0f / 3, 1,  2.0f / 3,
+                                   0,  1};
+#define BLADE_VERTS 7
+
+#ifdef GL_VERSION_3_3
+/*
+ *  Small xorshift generator for scattering (deterministic layout)
+ */
+static unsigned int rngState = 2463534242u;
+static double rnd(void) {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return (rngState & 0xFFFFFFu) / 16777216.0;
+}
+
+/*
+ *  Smooth value noise in [0,1] for grass clumps
+ */
+static double hash2(int x, int z) {
+  unsigned int h = (unsigned int)x * 73856093u ^ (unsigned int)z * 19349663u;
+  h = (h ^ (h >> 13)) * 1274126177u;
+  return ((h ^ (h >> 16)) & 0xffff) / 65535.0;
+}
+static double noise2(double x, double z) {
+  double xf = floor(x), zf = floor(z);
+  int xi = (int)xf, zi = (int)zf;
+  double tx = x - xf, tz = z - zf;
+  tx = tx * tx * (3.0 - 2.0 * tx);
+  tz = tz * tz * (3.0 - 2.0 * tz);
+  double a = hash2(xi, zi), b = hash2(xi + 1, zi);
+  double c = hash2(xi, zi + 1), d = hash2(xi + 1, zi + 1);
+  double ab = a + tx * (b - a), cd = c + tx * (d - c);
+  return ab + tz * (cd - ab);
+}
+
+/*
+ *  Fill the density map: clumps and clearings from noise, thinning toward
+ *  the island edge where the ground blends into the mountain ring
+ */
+static void buildDensityMap(double radius) {
+  for (int j = 0; j < GRASS_MAP; j++)
+    for (int i = 0; i < GRASS_MAP; i++) {
+      double x = ((i + 0.5) / GRASS_MAP * 2.0 - 1.0) * radius;
+      double z = ((j + 0.5) / GRASS_MAP * 2.0 - 1.0) * radius;
+      double n = 0.65 * noise2(x * 0.08, z * 0.08) +
+                 0.35 * noise2(x * 0.3 + 7.1, z * 0.3 - 3.7);
+      double d = (n - 0.25) / 0.35;
+      d = d < 0.0 ? 0.0 : d > 1.0 ? 1.0 : d;
+      double edge = (radius - sqrt(x * x + z * z)) / (0.2 * radius);
+      edge = edge < 0.0 ? 0.0 : edge > 1.0 ? 1.0 : edge;
+      grass.density[j * GRASS_MAP + i] = (float)(d * edge);
+    }
+}
+
+/*
+ *  Bilinear lookup in the density map
+ */
+static double densityAt(double x, double z) {
+  double u = (x / grass.radius * 0.5 + 0.5) * GRASS_MAP - 0.5;
+  double v = (z / grass.radius * 0.5 + 0.5) * GRASS_MAP - 0.5;
+  if (u < 0 || v < 0 || u >= GRASS_MAP - 1 || v >= GRASS_MAP - 1) return 0.0;
+  int i = (int)u, j = (int)v;
+  double tu = u - i, tv = v - j;
+  const float *d = grass.density + j * GRASS_MAP + i;
+  double a = d[0] + tu * (d[1] - d[0]);
+  double b = d[GRASS_MAP] + tu * (d[GRASS_MAP + 1] - d[GRASS_MAP]);
+  return a + tv * (b - a);
+}
+
+/*
+ *  Scatter blades into chunks and upload the instance buffer
+ *  Instance layout: (x, y, z, height), (yaw, wind phase, tint, rank)
+ *  @return 0 if the terrain is not ready yet
+ */
+static int buildGrass(double radius) {
+  if (terrainHeightAt(0.0, 0.0) < -1e8) return 0;
+  grass.radius = radius;
+  buildDensityMap(radius);
+
+  int side = (int)ceil(2.0 * radius / GRASS_CHUNK);
+  int perChunk = (int)(GRASS_CHUNK * GRASS_CHUNK * GRASS_DENSITY);
+  grass.chunks = (GrassChunk *)malloc(sizeof(GrassChunk) * side * side);
+  grass.cmds = (GrassDrawCmd *)malloc(sizeof(GrassDrawCmd) * side * side);
+  float *inst = (float *)malloc(sizeof(float) * 8 * perChunk * side * side);
+  if (!grass.chunks || !grass.cmds || !inst) Fatal("Out of memory for grass\n");
+
+  int n = 0;
+  for (int cz = 0; cz < side; cz++)
+    for (int cx = 0; cx < side; cx++) {
+      double x0 = -radius + cx * GRASS_CHUNK, z0 = -radius + cz * GRASS_CHUNK;
+      GrassChunk *c = &grass.chunks[grass.numChunks];
+      c->first = n;
+      c->minY = 1e9f;
+      c->maxY = -1e9f;
+      // Rejection sampling against the density map
+      for (int k = 0; k < perChunk; k++) {
+        double x = x0 + rnd() * GRASS_CHUNK, z = z0 + rnd() * GRASS_CHUNK;
+        if (rnd() >= densityAt(x, z)) continue;
+        float *b = inst + 8 * n++;
+        b[0] = (float)x;
+        b[1] = (float)terrainHeightAt(x, z);
+        b[2] = (float)z;
+        b[3] = (float)(GRASS_MAX_HEIGHT * (0.45 + 0.55 * rnd()));
+        b[4] = (float)(rnd() * 6.2831853);
+        b[5] = (float)(rnd() * 6.2831853);
+        b[6] = (float)rnd();
+        if (b[1] < c->minY) c->minY = b[1];
+        if (b[1] + b[3] > c->maxY) c->maxY = b[1] + b[3];
+      }
+      c->count = n - c->first;
+      if (!c->count) continue;
+      // Shuffle so any prefix is an even thinning, then store each rank
+      float *base = inst + 8 * c->first;
+      for (int k = c->count - 1; k > 0; k--) {
+        int r = (int)(rnd() * (k + 1));
+        for (int q = 0; q < 8; q++) {
+          float t = base[8 * k + q];
+          base[8 * k + q] = base[8 * r + q];
+          base[8 * r + q] = t;
+        }
+      }
+      for (int k = 0; k < c->count; k++)
+        base[8 * k + 7] = (float)k / c->count;
+      c->minX = (float)x0;
+      c->minZ = (float)z0;
+      c->maxX = (float)(x0 + GRASS_CHUNK);
+      c->maxZ = (float)(z0 + GRASS_CHUNK);
+      grass.numChunks++;
+    }
+  grass.total = n;
+
+  // Buffers + vertex array: blade strip (divisor 0) and instances (divisor 1)
+  glGenVertexArrays(1, &grass.vao);
+  glBindVertexArray(grass.vao);
+  glGenBuffers(1, &grass.bladeBuf);
+  glBindBuffer(GL_ARRAY_BUFFER, grass.bladeBuf);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(bladeVerts), bladeVerts, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+  glGenBuffers(1, &grass.instBuf);
+  glBindBuffer(GL_ARRAY_BUFFER, grass.instBuf);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 8 * n, inst, GL_STATIC_DRAW);
+  for (int a = 1; a <= 2; a++) {
+    glEnableVertexAttribArray(a);
+    glVertexAttribPointer(a, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                          (void *)(sizeof(float) * 4 * (a - 1)));
+    glVertexAttribDivisor(a, 1);
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  free(inst);
+
+#ifdef GL_VERSION_4_3
+  grass.indirect = GLVersionAtLeast(4, 3);
+  if (grass.indirect) {
+    glGenBuffers(1, &grass.cmdBuf);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, grass.cmdBuf);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                 sizeof(GrassDrawCmd) * grass.numChunks, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  }
+#endif
+  ErrCheck("buildGrass");
+  grass.built = 1;
+  return 1;
+}
+
+/*
+ *  Fraction of a chunk's blades kept at a distance (same curve as grass.vert)
+ *  Quadratic falloff keeps the blade count per screen area roughly constant
+ */
+static double lodKeep(double d) {
+  double k = (GRASS_LOD_FAR - d) / (GRASS_LOD_FAR - GRASS_LOD_NEAR);
+  k = k < 0.0 ? 0.0 : k > 1.0 ? 1.0 : k;
+  return k * k;
+}
+#endif
+
+/*
+ *  Draw the grass (OpenGL 3.3+)
+ */
+void drawGrass(double radius, double time, unsigned int shader) {
+#ifdef GL_VERSION_3_3
+  if (!shader || (!grass.built && !buildGrass(radius))) return;
+
+  // Frustum planes from the combined projection * modelview matrix
+  float P[16], M[16], C[16], pl[6][4];
+  glGetFloatv(GL_PROJECTION_MATRIX, P);
+  glGetFloatv(GL_MODELVIEW_MATRIX, M);
+  for (int c = 0; c < 4; c++)
+    for (int r = 0; r < 4; r++)
+      C[4 * c + r] = P[r] * M[4 * c] + P[4 + r] * M[4 * c + 1] +
+                     P[8 + r] * M[4 * c + 2] + P[12 + r] * M[4 * c + 3];
+  for (int i = 0; i < 3; i++)
+    for (int k = 0; k < 4; k++) {
+      pl[2 * i][k] = C[4 * k + 3] + C[4 * k + i];
+      pl[2 * i + 1][k] = C[4 * k + 3] - C[4 * k + i];
+    }
+  // Camera position: inverse of the rigid view transform
+  double ex = -(M[0] * M[12] + M[1] * M[13] + M[2] * M[14]);
+  double ey = -(M[4] * M[12] + M[5] * M[13] + M[6] * M[14]);
+  double ez = -(M[8] * M[12] + M[9] * M[13] + M[10] * M[14]);
+
+  // Cull chunks and pick how many of their shuffled blades to draw
+  int numCmds = 0;
+  grass.drawn = 0;
+  for (int i = 0; i < grass.numChunks; i++) {
+    const GrassChunk *c = &grass.chunks[i];
+    int visible = 1;
+    for (int p = 0; p < 6 && visible; p++) {
+      float x = pl[p][0] >= 0 ? c->maxX : c->minX;
+      float y = pl[p][1] >= 0 ? c->maxY : c->minY;
+      float z = pl[p][2] >= 0 ? c->maxZ : c->minZ;
+      visible = pl[p][0] * x + pl[p][1] * y + pl[p][2] * z + pl[p][3] >= 0;
+    }
+    if (!visible) continue;
+    double dx = ex < c->minX ? c->minX - ex : ex > c->maxX ? ex - c->maxX : 0;
+    double dy = ey < c->minY ? c->minY - ey : ey > c->maxY ? ey - c->maxY : 0;
+    double dz = ez < c->minZ ? c->minZ - ez : ez > c->maxZ ? ez - c->maxZ : 0;
+    // Blades ranked just past the cut shrink away in the shader (+0.05)
+    double keep = lodKeep(sqrt(dx * dx + dy * dy + dz * dz)) + 0.05;
+    int count = (keep >= 1.0) ? c->count : (int)ceil(c->count * keep);
+    if (keep <= 0.05 || count <= 0) continue;
+    GrassDrawCmd *cmd = &grass.cmds[numCmds++];
+    cmd->count = BLADE_VERTS;
+    cmd->instanceCount = count;
+    cmd->first = 0;
+    cmd->baseInstance = c->first;
+    grass.drawn += count;
+  }
+  if (!numCmds) return;
+
+  glUseProgram(shader);
+  glUniform1f(glGetUniformLocation(shader, "time"), (float)time);
+  glUniform2f(glGetUniformLocation(shader, "lodRange"), (float)GRASS_LOD_NEAR,
+              (float)GRASS_LOD_FAR);
+  glUniform1f(glGetUniformLocation(shader, "bladeWidth"), 0.035f);
+  glUniform1i(glGetUniformLocation(shader, "fogEnabled"),
+              glIsEnabled(GL_FOG) ? 1 : 0);
+  glBindVertexArray(grass.vao);
+  GLboolean cull = glIsEnabled(GL_CULL_FACE);
+  glDisable(GL_CULL_FACE); // Blades are two-sided
+#ifdef GL_VERSION_4_3
+  if (grass.indirect) {
+    // All visible chunks in a single call
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, grass.cmdBuf);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(GrassDrawCmd) * numCmds,
+                    grass.cmds);
+    glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, 0, numCmds, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  } else
+#endif
+  {
+    // One instanced draw per chunk; point the instance streams at its range
+    glBindBuffer(GL_ARRAY_BUFFER, grass.instBuf);
+    for (int i = 0; i < numCmds; i++) {
+      size_t off = sizeof(float) * 8 * grass.cmds[i].baseInstance;
+      glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                            (void *)off);
+      glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
+                            (void *)(off + sizeof(float) * 4));
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, BLADE_VERTS,
+                            grass.cmds[i].instanceCount);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+  if (cull) glEnable(GL_CULL_FACE);
+  glBindVertexArray(0);
+  glUseProgram(0);
+#else
+  (void)radius, (void)time, (void)shader;
+#endif
+}
+
+/*
+ *  Blade counts for the HUD
+ */
+int grassBladesDrawn(int *total) {
+  if (total) *total = grass.total;
+  return grass.drawn;
+}
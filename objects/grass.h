@@ -0,0 +1,27 @@
+/*
+ *  Ground-cover object - header file
+ *  GPU-instanced grass blades scattered over the forest island
+ */
+
+#ifndef OBJECTS_GRASS_H
+#define OBJECTS_GRASS_H
+
+/*
+ *  Draw instanced grass over the island (OpenGL 3.3+)
+ *  Instances are scattered once from a density map into per-chunk ranges;
+ *  each frame chunks are frustum-culled and thinned with distance.
+ *  Call after the terrain so terrainHeightAt() is valid.
+ *  @param radius radius of the grassy area around the origin
+ *  @param time animation time in seconds (wind sway)
+ *  @param shader grass.vert/grass.frag program
+ */
+void drawGrass(double radius, double time, unsigned int shader);
+
+/*
+ *  Number of grass blades submitted by the last drawGrass call
+ *  @param total total blades scattered (output, may be NULL)
+ *  @return blades drawn last frame
+ */
+int grassBladesDrawn(int *total);
+
+#endif
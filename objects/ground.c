@@ -481,3 +481,491 @@ void drawMountainRing(double innerR, double outerR, double baseY,
 
   if (ringList) glCallList(ringList);
 }
+
+/*
+ *  Parameters of the unified terrain (forest island + mountain ring)
+ */
+typedef struct {
+  double steepness;   // Ground height multiplier
+  double groundSize;  // Island radius
+  double innerR;      // Ring inner radius (ring rises from under the island)
+  double outerR;      // Ring outer radius
+  double baseY;       // Base height offset in Y direction
+  double heightScale; // Mountain height scale
+} TerrainLayout;
+
+static TerrainLayout layout = {0};
+
+/*
+ *  Set the terrain parameters used by terrainHeightAt()
+ *  @param steepness ground height multiplier
+ *  @param groundSize island radius
+ *  @param innerR ring inner radius
+ *  @param outerR ring outer radius
+ *  @param baseY base height offset in Y direction
+ *  @param heightScale mountain height scale
+ */
+void setTerrainLayout(double steepness, double groundSize, double innerR,
+                      double outerR, double baseY, double heightScale) {
+  layout = (TerrainLayout){steepness, groundSize, innerR, outerR, baseY,
+                           heightScale};
+}
+
+/*
+ *  Height of the unified terrain: forest ground inside innerR, mountains
+ *  beyond groundSize, smoothly blended across the overlap band between them
+ *  @param L terrain layout
+ *  @param x first coordinate
+ *  @param z second coordinate
+ */
+static double surfaceHeight(const TerrainLayout *L, double x, double z) {
+  double r = sqrt(x * x + z * z);
+  double g = (r < L->groundSize) ? terrainHeight(x, z, L->steepness) : 0.0;
+  if (r <= L->innerR) return g;
+  double m = mountainHeight(x, z, L->innerR, L->outerR, L->heightScale);
+  double w = smoothstep01((r - L->innerR) / (L->groundSize - L->innerR));
+  return lerp(g, m, w);
+}
+
+/*
+ *  Normal of the unified terrain via finite differences
+ *  @param L terrain layout
+ *  @param x first coordinate
+ *  @param z second coordinate
+ *  @param nx normal x component
+ *  @param ny normal y component
+ *  @param nz normal z component
+ */
+static void surfaceNormal(const TerrainLayout *L, double x, double z,
+                          double *nx, double *ny, double *nz) {
+  const double d = 0.1;
+  double hL = surfaceHeight(L, x - d, z);
+  double hR = surfaceHeight(L, x + d, z);
+  double hD = surfaceHeight(L, x, z - d);
+  double hU = surfaceHeight(L, x, z + d);
+  computeFiniteDiffNormal(hL, hR, hD, hU, d, nx, ny, nz);
+}
+
+/*
+ *  Per-vertex data of the unified terrain mesh
+ */
+typedef struct {
+  double h;    // Height above baseY
+  double n[3]; // Unit normal
+  double t[4]; // Unit tangent along +U (world +X), w = bitangent sign
+} TerrainVertex;
+
+/*
+ *  Normal and UV-aligned tangent frame of the unified terrain
+ *  UVs are world XZ, so the tangent follows the surface along +X and the
+ *  bitangent along +Z; only the sign of B = w * cross(N, T) is stored.
+ *  @param L terrain layout
+ *  @param x first coordinate
+ *  @param z second coordinate
+ *  @param v output vertex (height, normal, tangent)
+ */
+static void surfaceFrame(const TerrainLayout *L, double x, double z,
+                         TerrainVertex *v) {
+  const double d = 0.1;
+  double hL = surfaceHeight(L, x - d, z);
+  double hR = surfaceHeight(L, x + d, z);
+  double hD = surfaceHeight(L, x, z - d);
+  double hU = surfaceHeight(L, x, z + d);
+  v->h = surfaceHeight(L, x, z);
+  computeFiniteDiffNormal(hL, hR, hD, hU, d, &v->n[0], &v->n[1], &v->n[2]);
+
+  // dP/du and dP/dv of the heightfield (both already orthogonal to N)
+  double tx = 2.0 * d, ty = hR - hL, tz = 0.0;
+  double bx = 0.0, by = hU - hD, bz = 2.0 * d;
+  Vec3Normalize(&tx, &ty, &tz);
+  v->t[0] = tx;
+  v->t[1] = ty;
+  v->t[2] = tz;
+
+  // Handedness: does cross(N, T) point along dP/dv?
+  double cx, cy, cz;
+  Vec3Cross(v->n[0], v->n[1], v->n[2], tx, ty, tz, &cx, &cy, &cz);
+  v->t[3] = (cx * bx + cy * by + cz * bz < 0.0) ? -1.0 : 1.0;
+}
+
+/*
+ *  Set the splat shader uniforms shared by the mesh and tessellated paths
+ *  @param shader terrain shader program (bound by caller), 0 for none
+ */
+static void setSplatUniforms(unsigned int shader) {
+  if (!shader) return;
+  // Rock fades in across the overlap band, on steep slopes and up high
+  glUniform4f(glGetUniformLocation(shader, "splatParams"), (float)layout.innerR,
+              (float)layout.groundSize, (float)layout.baseY, 0.0f);
+  // Same tiling as drawGround (0.2) and drawMountainRing (0.04)
+  glUniform2f(glGetUniformLocation(shader, "texScale"), 0.2f, 0.04f);
+}
+
+/*
+ *  Terrain material: low specular to avoid stretched highlights
+ */
+static void setTerrainMaterial(void) {
+  float spec[] = {0.05f, 0.05f, 0.05f, 1.0f};
+  glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, spec);
+  glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, 3.0f);
+  glColor3f(1.0f, 1.0f, 1.0f);
+}
+
+/*
+ *  Restore the default specular material
+ */
+static void restoreDefaultMaterial(void) {
+  float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
+  glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, white);
+  glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, 32.0f);
+}
+
+/*
+ *  Draw the island and mountain ring as one mesh for the splat shader;
+ *  caches a display list of row-wise strips over the whole disk, as dense
+ *  as drawGround across the island and half as dense beyond it
+ *  @param steepness ground height multiplier
+ *  @param groundSize island radius
+ *  @param innerR ring inner radius
+ *  @param outerR ring outer radius
+ *  @param baseY base height offset in Y direction
+ *  @param heightScale mountain height scale
+ *  @param shader splat shader program (bound by caller), 0 for none
+ */
+void drawTerrain(double steepness, double groundSize, double innerR,
+                 double outerR, double baseY, double heightScale,
+                 unsigned int shader) {
+  const double fineStep = 0.5;   // Grid spacing across the island (as drawGround)
+  const double coarseStep = 1.0; // Grid spacing over the rest of the ring
+  static GLuint terrainList = 0;
+
+  setTerrainLayout(steepness, groundSize, innerR, outerR, baseY, heightScale);
+
+  if (!terrainList) {
+    // Grid lines (shared by X and Z): fine inside the island's square,
+    // coarse beyond it. One tensor grid has no T-junctions between the two
+    // densities, so the mesh needs no stitching.
+    int maxLines = (int)ceil(2.0 * outerR / fineStep) + 2, n = 0;
+    double *G = (double *)malloc(sizeof(double) * maxLines);
+    if (!G) return;
+    for (double g = -outerR; g < outerR - 1e-9 && n < maxLines - 1;) {
+      G[n++] = g;
+      g += (g >= -groundSize - 1e-9 && g < groundSize - 1e-9) ? fineStep
+                                                              : coarseStep;
+    }
+    G[n++] = outerR;
+
+    TerrainVertex *P = (TerrainVertex *)malloc(sizeof(TerrainVertex) * n * n);
+    if (!P) {
+      free(G);
+      return;
+    }
+    const double outerR2 = outerR * outerR;
+    for (int iz = 0; iz < n; ++iz) {
+      for (int ix = 0; ix < n; ++ix) {
+        double x = G[ix], z = G[iz];
+        if (x * x + z * z > outerR2) continue; // never emitted
+        surfaceFrame(&layout, x, z, &P[iz * n + ix]);
+      }
+    }
+
+    terrainList = glGenLists(1);
+    glNewList(terrainList, GL_COMPILE);
+    // Strips per row, split where a row leaves the outer disk
+    for (int iz = 0; iz < n - 1; ++iz) {
+      double zA = G[iz];
+      double zB = G[iz + 1];
+      int open = 0;
+      for (int ix = 0; ix < n; ++ix) {
+        double x = G[ix];
+        int in = (x * x + zA * zA <= outerR2) && (x * x + zB * zB <= outerR2);
+        if (in) {
+          if (!open) {
+            glBegin(GL_TRIANGLE_STRIP);
+            open = 1;
+          }
+          const TerrainVertex *a = &P[iz * n + ix];
+          const TerrainVertex *b = &P[(iz + 1) * n + ix];
+          glVertexAttrib4dv(TERRAIN_TANGENT_ATTRIB, a->t);
+          glNormal3dv(a->n);
+          glVertex3d(x, baseY + a->h, zA);
+          glVertexAttrib4dv(TERRAIN_TANGENT_ATTRIB, b->t);
+          glNormal3dv(b->n);
+          glVertex3d(x, baseY + b->h, zB);
+        } else if (open) {
+          glEnd();
+          open = 0;
+        }
+      }
+      if (open) glEnd();
+    }
+    glEndList();
+
+    free(P);
+    free(G);
+  }
+
+  setTerrainMaterial();
+  setSplatUniforms(shader);
+  glCallList(terrainList);
+  restoreDefaultMaterial();
+}
+
+/*
+ *  Baked heightmap + coarse patch grid for the tessellated terrain path
+ */
+typedef struct {
+  unsigned int heightTex;  // RGBA32F texels: xyz = normal, w = height
+  unsigned int patchBuf;   // Patch corners (x,0,z), 4 per quad patch
+  int patchVerts;          // Number of corner vertices in patchBuf
+  int res;                 // Heightmap resolution (res x res)
+  float x0, z0;            // Heightmap origin in world XZ
+  float extent;            // Heightmap width/depth in world units
+  float *cpuHeights;       // Heights kept on the CPU for queries (may be NULL)
+} TessTerrain;
+
+static TessTerrain terrainTess = {0};
+static unsigned int terrainGenProg = 0; // Compute program (0 = bake on CPU)
+static int terrainReadback = 0;          // Copy GPU heights back to the CPU
+
+/*
+ *  Select how tessellation heightmaps are generated
+ *  @param computeShader terrain_gen.comp program (0 = CPU bake)
+ *  @param readback 1 to keep a CPU copy of GPU-generated heights
+ */
+void setTerrainGenerator(unsigned int computeShader, int readback) {
+  terrainGenProg = computeShader;
+  terrainReadback = readback;
+}
+
+/*
+ *  Height of the terrain surface at (x,z) for CPU-side queries
+ *  Reads the tessellation heightfield when one was kept on the CPU,
+ *  otherwise evaluates the height functions directly; returns -1e9 until
+ *  the layout is set
+ *  @param x world X
+ *  @param z world Z
+ */
+double terrainHeightAt(double x, double z) {
+  if (layout.outerR <= 0.0) return -1e9;
+  const TessTerrain *tt = &terrainTess;
+  if (!tt->cpuHeights)
+    return layout.baseY + surfaceHeight(&layout, x, z);
+
+  // Bilinear lookup (heights stored at texel centers)
+  double fx = (x - tt->x0) / tt->extent * tt->res - 0.5;
+  double fz = (z - tt->z0) / tt->extent * tt->res - 0.5;
+  fx = fmin(fmax(fx, 0.0), tt->res - 1.001);
+  fz = fmin(fmax(fz, 0.0), tt->res - 1.001);
+  int ix = (int)fx, iz = (int)fz;
+  double u = fx - ix, v = fz - iz;
+  const float *row0 = tt->cpuHeights + iz * tt->res + ix;
+  const float *row1 = row0 + tt->res;
+  return layout.baseY +
+         lerp(lerp(row0[0], row0[1], u), lerp(row1[0], row1[1], u), v);
+}
+
+#ifdef GL_VERSION_4_0
+/*
+ *  Allocate an n x n RGBA32F heightmap texture (normal + height)
+ *  @param texels initial data or NULL (filled by the compute shader)
+ *  @param n texture resolution
+ */
+static GLuint createHeightTexture(const float *texels, int n) {
+  GLuint tex;
+  glGenTextures(1, &tex);
+  // Create it in the heightmap unit so the caller's color/normal binds survive
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, tex);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, n, n, 0, GL_RGBA, GL_FLOAT, texels);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glActiveTexture(GL_TEXTURE0);
+  return tex;
+}
+
+/*
+ *  Bake heights + normals on the CPU
+ *  @param tt terrain to fill (heightTex, cpuHeights)
+ */
+static void bakeHeightsCPU(TessTerrain *tt) {
+  int n = tt->res;
+  float *T = (float *)malloc(sizeof(float) * 4 * n * n);
+  tt->cpuHeights = (float *)malloc(sizeof(float) * n * n);
+  if (!T || !tt->cpuHeights) {
+    free(T);
+    free(tt->cpuHeights);
+    tt->cpuHeights = NULL;
+    return;
+  }
+  // Sample at texel centers
+  for (int iz = 0; iz < n; ++iz) {
+    double z = tt->z0 + (iz + 0.5) * tt->extent / n;
+    for (int ix = 0; ix < n; ++ix) {
+      double x = tt->x0 + (ix + 0.5) * tt->extent / n;
+      double nx, ny, nz;
+      double h = surfaceHeight(&layout, x, z);
+      surfaceNormal(&layout, x, z, &nx, &ny, &nz);
+      float *t = T + 4 * (iz * n + ix);
+      t[0] = (float)nx;
+      t[1] = (float)ny;
+      t[2] = (float)nz;
+      t[3] = (float)h;
+      tt->cpuHeights[iz * n + ix] = (float)h;
+    }
+  }
+  tt->heightTex = createHeightTexture(T, n);
+  free(T);
+}
+
+/*
+ *  Generate heights + normals with the terrain_gen.comp compute shader
+ *  (OpenGL 4.3); optionally reads the heights back for CPU queries
+ *  @param tt terrain to fill (heightTex, cpuHeights)
+ *  @return 1 on success, 0 if compute shaders are unavailable
+ */
+static int bakeHeightsGPU(TessTerrain *tt) {
+#ifdef GL_VERSION_4_3
+  int n = tt->res;
+  tt->heightTex = createHeightTexture(NULL, n);
+
+  GLint prev = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &prev);
+  glUseProgram(terrainGenProg);
+  glUniform4f(glGetUniformLocation(terrainGenProg, "heightRegion"), tt->x0,
+              tt->z0, tt->extent, 0.0f);
+  glUniform1f(glGetUniformLocation(terrainGenProg, "steepness"),
+              (float)layout.steepness);
+  glUniform1f(glGetUniformLocation(terrainGenProg, "groundSize"),
+              (float)layout.groundSize);
+  glUniform1f(glGetUniformLocation(terrainGenProg, "innerR"),
+              (float)layout.innerR);
+  glUniform1f(glGetUniformLocation(terrainGenProg, "outerR"),
+              (float)layout.outerR);
+  glUniform1f(glGetUniformLocation(terrainGenProg, "heightScale"),
+              (float)layout.heightScale);
+  glBindImageTexture(0, tt->heightTex, 0, GL_FALSE, 0, GL_WRITE_ONLY,
+                     GL_RGBA32F);
+  glDispatchCompute((n + 15) / 16, (n + 15) / 16, 1);
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+  glUseProgram(prev);
+
+  // Optional readback so CPU physics can query the same surface
+  if (terrainReadback) {
+    tt->cpuHeights = (float *)malloc(sizeof(float) * n * n);
+    if (tt->cpuHeights) {
+      glActiveTexture(GL_TEXTURE2);
+      glBindTexture(GL_TEXTURE_2D, tt->heightTex);
+      glGetTexImage(GL_TEXTURE_2D, 0, GL_ALPHA, GL_FLOAT, tt->cpuHeights);
+      glActiveTexture(GL_TEXTURE0);
+    }
+  }
+  ErrCheck("terrain compute");
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+/*
+ *  Build a buffer of square patches covering the disk of radius rMax
+ *  Patches entirely outside the disk are skipped
+ *  @param tt terrain to fill (patchBuf/patchVerts)
+ *  @param rMax disk radius
+ *  @param patch patch edge length in world units
+ */
+static void createPatchBuffer(TessTerrain *tt, double rMax, double patch) {
+  int n = (int)ceil((2.0 * rMax) / patch);
+  float *v = (float *)malloc(sizeof(float) * 12 * n * n);
+  if (!v) return;
+
+  int count = 0;
+  for (int iz = 0; iz < n; ++iz) {
+    for (int ix = 0; ix < n; ++ix) {
+      double xa = -rMax + ix * patch, xb = xa + patch;
+      double za = -rMax + iz * patch, zb = za + patch;
+      // Nearest distance from the origin to this square
+      double nx = fmax(0.0, fmax(xa, -xb)), nz = fmax(0.0, fmax(za, -zb));
+      if (nx * nx + nz * nz > rMax * rMax)
+        continue;
+      // Corner order matches the control shader: (0,0) (1,0) (1,1) (0,1)
+      const double cx[4] = {xa, xb, xb, xa};
+      const double cz[4] = {za, za, zb, zb};
+      for (int k = 0; k < 4; ++k) {
+        v[count * 3 + 0] = (float)cx[k];
+        v[count * 3 + 1] = 0.0f;
+        v[count * 3 + 2] = (float)cz[k];
+        count++;
+      }
+    }
+  }
+
+  glGenBuffers(1, &tt->patchBuf);
+  glBindBuffer(GL_ARRAY_BUFFER, tt->patchBuf);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 3 * count, v, GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  tt->patchVerts = count;
+  free(v);
+}
+#endif
+
+/*
+ *  Draw the island and mountain ring as one set of tessellated patches;
+ *  bakes the heightmap (GPU when a compute program is set) on first use
+ *  @param steepness ground height multiplier
+ *  @param groundSize island radius
+ *  @param innerR ring inner radius
+ *  @param outerR ring outer radius
+ *  @param baseY base height offset in Y direction
+ *  @param heightScale mountain height scale
+ *  @param shader tessellation splat shader program (bound by caller)
+ */
+void drawTerrainTess(double steepness, double groundSize, double innerR,
+                     double outerR, double baseY, double heightScale,
+                     unsigned int shader) {
+#ifdef GL_VERSION_4_0
+  TessTerrain *tt = &terrainTess;
+  setTerrainLayout(steepness, groundSize, innerR, outerR, baseY, heightScale);
+
+  if (!tt->heightTex) {
+    tt->res = 1024;
+    tt->x0 = tt->z0 = (float)-outerR;
+    tt->extent = (float)(2.0 * outerR);
+    if (!terrainGenProg || !bakeHeightsGPU(tt))
+      bakeHeightsCPU(tt);
+    createPatchBuffer(tt, outerR, 8.0);
+  }
+  if (!tt->patchVerts) return;
+
+  GLint vp[4];
+  glGetIntegerv(GL_VIEWPORT, vp);
+  glUniform4f(glGetUniformLocation(shader, "heightRegion"), tt->x0, tt->z0,
+              1.0f / tt->extent, 1.0f / tt->extent);
+  glUniform1f(glGetUniformLocation(shader, "baseY"), (float)baseY);
+  glUniform1f(glGetUniformLocation(shader, "outerR"), (float)outerR);
+  glUniform2f(glGetUniformLocation(shader, "viewport"), (float)vp[2],
+              (float)vp[3]);
+  glUniform1f(glGetUniformLocation(shader, "pixelsPerEdge"), 12.0f);
+  glUniform1f(glGetUniformLocation(shader, "maxDisplace"),
+              (float)(heightScale + 1.0));
+  setSplatUniforms(shader);
+  setTerrainMaterial();
+
+  // Heights live in texture unit 2 (0/1 ground maps, 3/4 rock maps)
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, tt->heightTex);
+  glActiveTexture(GL_TEXTURE0);
+
+  glPatchParameteri(GL_PATCH_VERTICES, 4);
+  glBindBuffer(GL_ARRAY_BUFFER, tt->patchBuf);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 0, 0);
+  glDrawArrays(GL_PATCHES, 0, tt->patchVerts);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  restoreDefaultMaterial();
+#endif
+}
@@ -6,6 +6,10 @@
 #ifndef OBJECTS_GROUND_H
 #define OBJECTS_GROUND_H
 
+//  Generic attribute index of the terrain "tangent" input; bound before
+//  linking so every program drawing the cached terrain list agrees on it
+#define TERRAIN_TANGENT_ATTRIB 6
+
 /*
  *  Draw ground terrain with varied height
  *  @param steepness terrain height multiplier
@@ -27,4 +31,64 @@ void drawGround(double steepness, double size, double groundY,
 void drawMountainRing(double innerR, double outerR, double baseY,
                       unsigned int texture, double heightScale);
 
+/*
+ *  Draw the forest island and mountain ring as one mesh in a single pass;
+ *  the bound splat shader blends ground and rock maps per pixel
+ *  @param steepness ground height multiplier
+ *  @param groundSize island radius
+ *  @param innerR mountain ring inner radius (ring starts under the island)
+ *  @param outerR mountain ring outer radius
+ *  @param baseY base height offset in Y direction
+ *  @param heightScale vertical scale of the mountains
+ *  @param shader splat shader program (bound by caller), or 0 for plain
+ *                geometry (shadow map passes); precomputed tangent frames go
+ *                to attribute TERRAIN_TANGENT_ATTRIB
+ */
+void drawTerrain(double steepness, double groundSize, double innerR,
+                 double outerR, double baseY, double heightScale,
+                 unsigned int shader);
+
+/*
+ *  Same terrain as drawTerrain drawn with hardware tessellation (OpenGL 4.0+)
+ *  Heights are baked into a texture once; patch density follows the camera
+ *  @param steepness ground height multiplier
+ *  @param groundSize island radius
+ *  @param innerR mountain ring inner radius
+ *  @param outerR mountain ring outer radius
+ *  @param baseY base height offset in Y direction
+ *  @param heightScale vertical scale of the mountains
+ *  @param shader tessellation splat shader program (bound by caller)
+ */
+void drawTerrainTess(double steepness, double groundSize, double innerR,
+                     double outerR, double baseY, double heightScale,
+                     unsigned int shader);
+
+/*
+ *  Select how the tessellated path generates its heightmaps
+ *  @param computeShader terrain_gen.comp program (0 = bake on the CPU)
+ *  @param readback 1 to copy GPU heights back for terrainHeightAt()
+ */
+void setTerrainGenerator(unsigned int computeShader, int readback);
+
+/*
+ *  Set the terrain parameters without drawing it, so terrainHeightAt()
+ *  answers before the first frame (the draw calls set the same values)
+ *  @param steepness ground height multiplier
+ *  @param groundSize island radius
+ *  @param innerR mountain ring inner radius
+ *  @param outerR mountain ring outer radius
+ *  @param baseY base height offset in Y direction
+ *  @param heightScale vertical scale of the mountains
+ */
+void setTerrainLayout(double steepness, double groundSize, double innerR,
+                      double outerR, double baseY, double heightScale);
+
+/*
+ *  Height of the terrain surface for CPU-side queries (physics)
+ *  @param x world X
+ *  @param z world Z
+ *  @return world Y, or -1e9 until the terrain layout is set
+ */
+double terrainHeightAt(double x, double z);
+
 #endif
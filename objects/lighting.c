@@ -1,6 +1,6 @@
 /*
  *  Lighting objects - implementation file
- *  Contains drawing functions for light representation
+ *  Contains drawing functions for light representation and the sky
  */
 
 #include "lighting.h"
@@ -77,77 +77,136 @@ void drawLightBall(double x, double y, double z, double r, int isDay) {
   glPopMatrix();
 }
 
+#define SKY_GRID_X 16 // Fallback grid columns
+#define SKY_GRID_Y 12 // Fallback grid rows
+
+/*
+ *  Sky-view table on the GPU (refreshed every frame)
+ */
+static struct {
+  int built;
+  unsigned int tex;
+} skyGL;
+
+#ifdef GL_VERSION_3_3
+/*
+ *  Create the sky-view texture
+ */
+static void buildSkyGL(void) {
+  glGenTextures(1, &skyGL.tex);
+  glBindTexture(GL_TEXTURE_2D, skyGL.tex);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, SKY_AZIMUTH, SKY_ELEVATION, 0,
+               GL_RGB, GL_FLOAT, NULL);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  ErrCheck("buildSkyGL");
+  skyGL.built = 1;
+}
+#endif
+
 /*
- *  Draw the sky background with day/night cycle
- *  @param dayNightCycle 0.0 to 1.0, where 0.0 and 1.0 are noon, 0.5 is midnight
+ *  World view rays through the screen corners for the current camera
+ *  @param rays bottom-left, bottom-right, top-right, top-left (output)
  */
-void drawSky(double dayNightCycle) {
+static void cornerRays(double rays[4][3]) {
+  double mv[16], proj[16];
+  glGetDoublev(GL_MODELVIEW_MATRIX, mv);
+  glGetDoublev(GL_PROJECTION_MATRIX, proj);
+  // Only the camera's rotation matters for a direction
+  mv[12] = mv[13] = mv[14] = 0;
+  const int unit[4] = {0, 0, 1, 1};
+  const double cx[4] = {0, 1, 1, 0}, cy[4] = {0, 0, 1, 1};
+  for (int i = 0; i < 4; i++) {
+    double n[3], f[3];
+    gluUnProject(cx[i], cy[i], 0, mv, proj, unit, &n[0], &n[1], &n[2]);
+    gluUnProject(cx[i], cy[i], 1, mv, proj, unit, &f[0], &f[1], &f[2]);
+    for (int k = 0; k < 3; k++) rays[i][k] = f[k] - n[k];
+  }
+}
+
+/*
+ *  Draw the sky background from the frame's sky-view table
+ *  One full-screen pass: the sky shader reads the table once per pixel.
+ *  Without it, a coarse screen grid is colored on the CPU with the same
+ *  lookup.
+ *  @param view sky for the current sun (updateSkyView())
+ *  @param shader sky.vert/sky.frag program (0 for the CPU grid)
+ */
+void drawSky(const SkyView *view, unsigned int shader) {
+  double rays[4][3];
+  cornerRays(rays);
+
   // Save current state
   GLboolean wasLit = glIsEnabled(GL_LIGHTING);
   GLboolean wasDepthTest = glIsEnabled(GL_DEPTH_TEST);
   glDisable(GL_LIGHTING);
   glDisable(GL_DEPTH_TEST);
 
-  // Calculate sky colors based on time of day
-  // dayNightCycle: 0.0-0.25 = morning, 0.25-0.5 = night, 0.5-0.75 = morning, 0.75-1.0 = day
-  double dayFactor;
-  
-  // Convert cycle to a smooth curve where 0 and 1 are day, 0.5 is night
-  // Use cosine for smooth transitions: cos(0) = 1 (day), cos(PI) = -1 (night)
-  dayFactor = (Cos(dayNightCycle * 360.0) + 1.0) / 2.0; // Range 0 to 1
-
-  // Top color (sky zenith)
-  double topR, topG, topB;
-  // Bottom color (horizon)
-  double botR, botG, botB;
-
-  // Day sky: bright blue top, lighter blue bottom
-  double dayTopR = 0.4, dayTopG = 0.6, dayTopB = 0.9;
-  double dayBotR = 0.7, dayBotG = 0.85, dayBotB = 1.0;
-
-  // Night sky: dark blue top, slightly lighter bottom
-  double nightTopR = 0.05, nightTopG = 0.05, nightTopB = 0.15;
-  double nightBotR = 0.1, nightBotG = 0.1, nightBotB = 0.25;
-
-  // Interpolate between day and night colors
-  topR = nightTopR + dayFactor * (dayTopR - nightTopR);
-  topG = nightTopG + dayFactor * (dayTopG - nightTopG);
-  topB = nightTopB + dayFactor * (dayTopB - nightTopB);
-
-  botR = nightBotR + dayFactor * (dayBotR - nightBotR);
-  botG = nightBotG + dayFactor * (dayBotG - nightBotG);
-  botB = nightBotB + dayFactor * (dayBotB - nightBotB);
-
-  // Draw sky as a large quad with gradient
-  glPushMatrix();
-  glLoadIdentity();
-  
-  // Set up projection to cover entire screen
+  // Draw in clip space
   glMatrixMode(GL_PROJECTION);
   glPushMatrix();
   glLoadIdentity();
-  glOrtho(-1, 1, -1, 1, -1, 1);
   glMatrixMode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity();
 
-  // Draw gradient quad
-  glBegin(GL_QUADS);
-  // Top vertices (sky)
-  glColor3f(topR, topG, topB);
-  glVertex3f(-1, 1, -0.999);
-  glVertex3f(1, 1, -0.999);
-  // Bottom vertices (horizon)
-  glColor3f(botR, botG, botB);
-  glVertex3f(1, -1, -0.999);
-  glVertex3f(-1, -1, -0.999);
-  glEnd();
+#ifdef GL_VERSION_3_3
+  if (shader) {
+    if (!skyGL.built) buildSkyGL();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, skyGL.tex);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SKY_AZIMUTH, SKY_ELEVATION, GL_RGB,
+                    GL_FLOAT, view->texels);
+    glUseProgram(shader);
+    glUniform1i(glGetUniformLocation(shader, "skyView"), 0);
+    glUniform2f(glGetUniformLocation(shader, "sunDir"), view->sunX,
+                view->sunZ);
+    glUniform1f(glGetUniformLocation(shader, "gamma"), SKY_GAMMA);
+    const float cx[4] = {-1, 1, 1, -1}, cy[4] = {-1, -1, 1, 1};
+    glBegin(GL_QUADS);
+    for (int i = 0; i < 4; i++) {
+      glTexCoord3dv(rays[i]);
+      glVertex3f(cx[i], cy[i], 0.999);
+    }
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+  } else
+#endif
+  {
+    (void)shader;
+    // Rays blend bilinearly across the screen; color each grid vertex
+    float colors[SKY_GRID_Y + 1][SKY_GRID_X + 1][3];
+    for (int j = 0; j <= SKY_GRID_Y; j++)
+      for (int i = 0; i <= SKY_GRID_X; i++) {
+        const double u = (double)i / SKY_GRID_X, v = (double)j / SKY_GRID_Y;
+        double ray[3];
+        for (int k = 0; k < 3; k++)
+          ray[k] = (rays[0][k] * (1 - u) + rays[1][k] * u) * (1 - v) +
+                   (rays[3][k] * (1 - u) + rays[2][k] * u) * v;
+        skyColor(view, ray, colors[j][i]);
+      }
+    for (int j = 0; j < SKY_GRID_Y; j++) {
+      glBegin(GL_QUAD_STRIP);
+      for (int i = 0; i <= SKY_GRID_X; i++) {
+        const float x = 2.0f * i / SKY_GRID_X - 1;
+        glColor3fv(colors[j + 1][i]);
+        glVertex3f(x, 2.0f * (j + 1) / SKY_GRID_Y - 1, 0.999);
+        glColor3fv(colors[j][i]);
+        glVertex3f(x, 2.0f * j / SKY_GRID_Y - 1, 0.999);
+      }
+      glEnd();
+    }
+  }
 
-  // Restore projection
+  // Restore matrices and state
   glMatrixMode(GL_PROJECTION);
   glPopMatrix();
   glMatrixMode(GL_MODELVIEW);
   glPopMatrix();
-
-  // Restore state
   if (wasLit)
     glEnable(GL_LIGHTING);
   if (wasDepthTest)
@@ -1,11 +1,13 @@
 /*
  *  Lighting objects - header file
- *  Defines light ball drawing functions
+ *  Defines light ball and sky drawing functions
  */
 
 #ifndef OBJECTS_LIGHTING_H
 #define OBJECTS_LIGHTING_H
 
+#include "../sky.h"
+
 /*
  *  Draw a small sphere to represent the light (unlit so it appears emissive)
  *  @param x x position
@@ -17,9 +19,11 @@
 void drawLightBall(double x, double y, double z, double r, int isDay);
 
 /*
- *  Draw the sky background with day/night cycle
- *  @param dayNightCycle 0.0 to 1.0, where 0.0 and 1.0 are noon, 0.5 is midnight
+ *  Draw the sky background from the frame's sky-view table
+ *  Call with the camera set: the sky follows the view.
+ *  @param view sky for the current sun (updateSkyView())
+ *  @param shader sky.vert/sky.frag program (0 for the CPU grid)
  */
-void drawSky(double dayNightCycle);
+void drawSky(const SkyView *view, unsigned int shader);
 
 #endif
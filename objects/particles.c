@@ -0,0 +1,268 @@
+/*
+ *  Particle object - implementation
+ *  All particles share one update kernel: per-particle gravity and drag
+ *  arrays let trails, splinters and dust differ without branching on type.
+ *  Live particles stay packed at the front of the pool, so the whole system
+ *  is one contiguous update and one draw call.
+ */
+
+#include "particles.h"
+#include "../utils.h"
+
+/*
+ *  Emission parameters per PARTICLE_* type
+ */
+static const struct {
+  float speed;   // Speed along the emission direction
+  float spread;  // Largest random velocity added in any direction
+  float life;    // Mean lifetime in seconds
+  float size;    // Mean sprite diameter
+  float gravity; // Downward acceleration (negative floats up)
+  float drag;    // Fraction of velocity lost per second
+  unsigned char rgba[4];
+} effects[] = {
+    {0.0f, 0.3f, 0.6f, 0.12f, -0.3f, 2.0f, {235, 235, 225, 110}}, // Trail
+    {5.0f, 3.5f, 1.2f, 0.07f, 9.8f, 0.5f, {150, 100, 50, 255}},   // Splinter
+    {1.0f, 2.0f, 1.6f, 0.45f, 0.6f, 2.5f, {140, 120, 90, 150}},   // Dust
+};
+
+/*
+ *  Random float in [-1,1] from the pool's xorshift state
+ */
+static float randSigned(ParticlePool *pool) {
+  unsigned int s = pool->seed;
+  s ^= s << 13;
+  s ^= s >> 17;
+  s ^= s << 5;
+  pool->seed = s;
+  return (s & 0xFFFFFF) / 8388607.5f - 1.0f;
+}
+
+/*
+ *  Random vector in the unit ball (rejection sampling, so bursts are round
+ *  rather than cube-shaped)
+ */
+static void randBall(ParticlePool *pool, float v[3]) {
+  do {
+    v[0] = randSigned(pool);
+    v[1] = randSigned(pool);
+    v[2] = randSigned(pool);
+  } while (v[0] * v[0] + v[1] * v[1] + v[2] * v[2] > 1.0f);
+}
+
+/*
+ *  Allocate an empty particle pool
+ *  @param pool pool to initialize
+ *  @param capacity maximum number of particles
+ *  @return 1 on success, 0 if allocation failed
+ */
+int initParticlePool(ParticlePool *pool, int capacity) {
+  memset(pool, 0, sizeof(*pool));
+  // One block for the 11 float arrays
+  float *f = malloc((size_t)capacity * 11 * sizeof(float));
+  pool->color = malloc(capacity * sizeof(unsigned int));
+  if (!f || !pool->color) {
+    free(f);
+    free(pool->color);
+    memset(pool, 0, sizeof(*pool));
+    return 0;
+  }
+  float **arrays[11] = {&pool->x,    &pool->y,       &pool->z,   &pool->vx,
+                        &pool->vy,   &pool->vz,      &pool->age, &pool->life,
+                        &pool->size, &pool->gravity, &pool->drag};
+  for (int k = 0; k < 11; k++) *arrays[k] = f + (size_t)k * capacity;
+  pool->capacity = capacity;
+  pool->seed = 2463534242u;
+  return 1;
+}
+
+/*
+ *  Remove every particle from the pool
+ *  @param pool particle pool
+ */
+void clearParticlePool(ParticlePool *pool) { pool->count = 0; }
+
+/*
+ *  Emit a burst of particles
+ *  @return number emitted (fewer than n when the pool is full)
+ */
+int emitParticles(ParticlePool *pool, int type, double x, double y, double z,
+                  double dx, double dy, double dz, int n) {
+  if (n > pool->capacity - pool->count) n = pool->capacity - pool->count;
+  const float speed = effects[type].speed, spread = effects[type].spread;
+  float r[3];
+  const unsigned char *c = effects[type].rgba;
+  const unsigned int rgba = c[0] | c[1] << 8 | c[2] << 16 | (unsigned)c[3] << 24;
+  for (int k = 0; k < n; k++) {
+    const int i = pool->count++;
+    const float s = speed * (0.75f + 0.25f * randSigned(pool));
+    pool->x[i] = x;
+    pool->y[i] = y;
+    pool->z[i] = z;
+    randBall(pool, r);
+    pool->vx[i] = dx * s + spread * r[0];
+    pool->vy[i] = dy * s + spread * r[1];
+    pool->vz[i] = dz * s + spread * r[2];
+    pool->age[i] = 0.0f;
+    pool->life[i] = effects[type].life * (1.0f + 0.3f * randSigned(pool));
+    pool->size[i] = effects[type].size * (1.0f + 0.3f * randSigned(pool));
+    pool->gravity[i] = effects[type].gravity;
+    pool->drag[i] = effects[type].drag;
+    pool->color[i] = rgba;
+  }
+  return n;
+}
+
+/*
+ *  Update kernel over [0, n): restrict-qualified parameters so the loop
+ *  vectorizes (same pattern as the arrow integrator)
+ */
+static void particleKernel(int n, float h, float *restrict x,
+                           float *restrict y, float *restrict z,
+                           float *restrict vx, float *restrict vy,
+                           float *restrict vz, float *restrict age,
+                           const float *restrict gravity,
+                           const float *restrict drag) {
+  for (int i = 0; i < n; i++) {
+    const float k = 1.0f - drag[i] * h;
+    vx[i] *= k;
+    vy[i] = (vy[i] - gravity[i] * h) * k;
+    vz[i] *= k;
+    x[i] += vx[i] * h;
+    y[i] += vy[i] * h;
+    z[i] += vz[i] * h;
+    age[i] += h;
+  }
+}
+
+/*
+ *  Advance every particle and remove expired ones
+ *  @param pool particle pool
+ *  @param dt time delta in seconds
+ */
+void updateParticles(ParticlePool *pool, double dt) {
+  pool->lastDt = dt;
+  if (!pool->count) return;
+  particleKernel(pool->count, (float)dt, pool->x, pool->y, pool->z, pool->vx,
+                 pool->vy, pool->vz, pool->age, pool->gravity, pool->drag);
+
+  // Compact: move the last live particle into each expired slot
+  float **arrays[11] = {&pool->x,    &pool->y,       &pool->z,   &pool->vx,
+                        &pool->vy,   &pool->vz,      &pool->age, &pool->life,
+                        &pool->size, &pool->gravity, &pool->drag};
+  int i = 0;
+  while (i < pool->count) {
+    if (pool->age[i] < pool->life[i]) {
+      i++;
+      continue;
+    }
+    const int last = --pool->count;
+    for (int k = 0; k < 11; k++) (*arrays[k])[i] = (*arrays[k])[last];
+    pool->color[i] = pool->color[last];
+  }
+}
+
+/*
+ *  Drawing: one vertex per particle, rebuilt each frame
+ */
+typedef struct {
+  float x, y, z, size;    // Position between ticks, sprite diameter
+  unsigned char rgba[4];  // Color with alpha faded by age
+} ParticleVertex;
+
+static struct {
+  int built;
+  unsigned int vao, buf;
+  ParticleVertex *verts; // CPU staging (capacity entries)
+} particleGL;
+
+/*
+ *  Draw every live particle in one call
+ *  @param pool particle pool
+ *  @param alpha blend between the previous and current tick (0-1)
+ *  @param shader particle.vert/particle.frag program (0 for plain points)
+ */
+void drawParticles(const ParticlePool *pool, double alpha,
+                   unsigned int shader) {
+  if (!pool->count) return;
+  if (!particleGL.verts) {
+    particleGL.verts = malloc(pool->capacity * sizeof(ParticleVertex));
+    if (!particleGL.verts) Fatal("Cannot allocate particle vertices\n");
+  }
+
+  // Step back from the current tick along the velocity (render interpolation)
+  const float back = (float)((alpha - 1.0) * pool->lastDt);
+  for (int i = 0; i < pool->count; i++) {
+    ParticleVertex *v = particleGL.verts + i;
+    const unsigned int c = pool->color[i];
+    const float fade = 1.0f - pool->age[i] / pool->life[i];
+    v->x = pool->x[i] + pool->vx[i] * back;
+    v->y = pool->y[i] + pool->vy[i] * back;
+    v->z = pool->z[i] + pool->vz[i] * back;
+    v->size = pool->size[i];
+    v->rgba[0] = c & 0xFF;
+    v->rgba[1] = (c >> 8) & 0xFF;
+    v->rgba[2] = (c >> 16) & 0xFF;
+    v->rgba[3] = (unsigned char)((c >> 24) * fade);
+  }
+  const int stride = sizeof(ParticleVertex);
+
+#ifdef GL_VERSION_3_3
+  if (shader) {
+    if (!particleGL.built) {
+      glGenVertexArrays(1, &particleGL.vao);
+      glBindVertexArray(particleGL.vao);
+      glGenBuffers(1, &particleGL.buf);
+      glBindBuffer(GL_ARRAY_BUFFER, particleGL.buf);
+      glEnableVertexAttribArray(0);
+      glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void *)0);
+      glEnableVertexAttribArray(1);
+      glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                            (void *)(4 * sizeof(float)));
+      glBindVertexArray(0);
+      ErrCheck("drawParticles");
+      particleGL.built = 1;
+    }
+
+    // Orphan the buffer so the upload doesn't wait on last frame's draw
+    glBindBuffer(GL_ARRAY_BUFFER, particleGL.buf);
+    glBufferData(GL_ARRAY_BUFFER, (size_t)pool->capacity * stride, NULL,
+                 GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (size_t)pool->count * stride,
+                    particleGL.verts);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glUseProgram(shader);
+    glUniform1f(glGetUniformLocation(shader, "viewportHeight"), viewport[3]);
+    glUniform1i(glGetUniformLocation(shader, "lit"),
+                glIsEnabled(GL_LIGHTING) ? 1 : 0);
+    glUniform1i(glGetUniformLocation(shader, "fogEnabled"),
+                glIsEnabled(GL_FOG) ? 1 : 0);
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glEnable(GL_POINT_SPRITE);
+    glBindVertexArray(particleGL.vao);
+    glDrawArrays(GL_POINTS, 0, pool->count);
+    glBindVertexArray(0);
+    glDisable(GL_POINT_SPRITE);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+    glUseProgram(0);
+    return;
+  }
+#endif
+
+  // Fallback: fixed-size points from client arrays (still one draw call)
+  int lighting = glIsEnabled(GL_LIGHTING);
+  glDisable(GL_LIGHTING);
+  glPointSize(3.0f);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glVertexPointer(3, GL_FLOAT, stride, &particleGL.verts[0].x);
+  glColorPointer(4, GL_UNSIGNED_BYTE, stride, particleGL.verts[0].rgba);
+  glDrawArrays(GL_POINTS, 0, pool->count);
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glPointSize(1.0f);
+  if (lighting) glEnable(GL_LIGHTING);
+}
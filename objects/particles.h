@@ -0,0 +1,89 @@
+/*
+ *  Particle object - header file
+ *  Arrow trails, wood splinters on target hits and dust on ground hits,
+ *  kept in one fixed-capacity structure-of-arrays pool
+ */
+
+#ifndef OBJECTS_PARTICLES_H
+#define OBJECTS_PARTICLES_H
+
+/*
+ *  Particle effect types (each has its own speed, life, size and color)
+ */
+enum {
+  PARTICLE_TRAIL,    // Faint puff left behind a flying arrow
+  PARTICLE_SPLINTER, // Wood chip thrown back from a target hit
+  PARTICLE_DUST      // Dust kicked up where an arrow meets the ground
+};
+
+/*
+ *  Particle pool: live particles are packed in [0, count)
+ *  A dead particle is replaced by the last live one, so the update and the
+ *  draw both run over one contiguous range and nothing is allocated after
+ *  init. Emitting into a full pool drops the new particles.
+ */
+#define PARTICLE_CAPACITY 131072
+
+typedef struct {
+  int capacity;           // Maximum number of particles
+  int count;              // Live particles
+  float *x, *y, *z;       // Position
+  float *vx, *vy, *vz;    // Velocity
+  float *age, *life;      // Seconds since emission and lifetime
+  float *size;            // Sprite diameter in world units
+  float *gravity, *drag;  // Downward acceleration and velocity damping
+  unsigned int *color;    // Packed RGBA (alpha fades with age)
+  unsigned int seed;      // Random state for emission (visual only)
+  float lastDt;           // Step of the last update (for interpolation)
+} ParticlePool;
+
+/*
+ *  Allocate an empty particle pool
+ *  @param pool pool to initialize
+ *  @param capacity maximum number of particles
+ *  @return 1 on success, 0 if allocation failed
+ */
+int initParticlePool(ParticlePool *pool, int capacity);
+
+/*
+ *  Remove every particle from the pool
+ *  @param pool particle pool
+ */
+void clearParticlePool(ParticlePool *pool);
+
+/*
+ *  Emit a burst of particles
+ *  @param pool particle pool
+ *  @param type PARTICLE_* effect
+ *  @param x emission point x
+ *  @param y emission point y
+ *  @param z emission point z
+ *  @param dx main direction x (unit; velocities spread around it)
+ *  @param dy main direction y
+ *  @param dz main direction z
+ *  @param n number of particles
+ *  @return number emitted (fewer than n when the pool is full)
+ */
+int emitParticles(ParticlePool *pool, int type, double x, double y, double z,
+                  double dx, double dy, double dz, int n);
+
+/*
+ *  Advance every particle and remove expired ones
+ *  @param pool particle pool
+ *  @param dt time delta in seconds
+ */
+void updateParticles(ParticlePool *pool, double dt);
+
+/*
+ *  Draw every live particle in one call
+ *  Point sprites sized by distance with particle.vert/particle.frag, or
+ *  fixed-size points from client vertex arrays without the shader.
+ *  Call with blending on and depth writes off.
+ *  @param pool particle pool
+ *  @param alpha blend between the previous and current tick (0-1)
+ *  @param shader particle.vert/particle.frag program (0 for plain points)
+ */
+void drawParticles(const ParticlePool *pool, double alpha,
+                   unsigned int shader);
+
+#endif
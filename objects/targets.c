@@ -0,0 +1,348 @@
+/*
+ *  Target layout object - implementation file
+ *  Layout files are plain text, one command per line ('#' starts a
+ *  comment). A target line starts a target; the lines after it set its
+ *  facing and motion:
+ *
+ *    target x y z radius rings r g b
+ *    face x z                          point it faces (default 0 30)
+ *    static                            no motion (default)
+ *    sine ax ay az [cycles [phase]]    a sin(cycles zh + phase)
+ *    orbit ax ay az bx by bz [cycles [phase]]
+ *                                      a sin(...) + b cos(...)
+ *    key zh x y z                      spline keyframe (closed Catmull-Rom
+ *                                      through the keys, zh ascending)
+ *
+ *  Motion offsets are sampled TARGET_LUT_SIZE times over the cycle into one
+ *  shared float table (block 0 is all zeros for static targets), so every
+ *  target is evaluated by the same loop with no per-type branches.
+ */
+
+#include "targets.h"
+#include "../utils.h"
+
+#define LUT_STRIDE (TARGET_LUT_SIZE + 1) // Samples per target (last = first)
+
+/*
+ *  Built-in layout: the original five targets
+ */
+static const char *builtInLayout =
+    "target 0 0 -1.5 2.0 6 1 0 0\n"
+    "sine 0 0 1.2\n"
+    "target -8 5 -4 1.25 5 0 0 1\n"
+    "sine 1.8 0 -1.2\n"
+    "target 8 5 -4 1.25 4 0 1 0\n"
+    "sine -1.8 0 1.2\n"
+    "target -7 1.75 5.5 1.25 4 1 0 1\n"
+    "sine 1.5 0 2.1\n"
+    "target 7.5 2.25 6 1.25 5 0 1 1\n"
+    "sine -1.5 0 1.8\n";
+
+static TargetDef defs[TARGET_MAX];
+static int defCount = 0;
+static float *lut = NULL; // Motion samples, LUT_STRIDE x 3 floats per block
+static int layoutReady = 0;
+
+/*
+ *  Motion of the target being parsed
+ */
+enum { MOTION_STATIC, MOTION_SINE, MOTION_ORBIT, MOTION_SPLINE };
+typedef struct {
+  int type;
+  double a[3], b[3];               // Sine/orbit amplitudes
+  int cycles;                      // Periods per animation cycle
+  double phase;                    // Phase (degrees)
+  int keys;                        // Spline keyframes
+  double key[TARGET_MAX_KEYS][4];  // zh, x, y, z
+} Motion;
+
+/*
+ *  Offset of a closed Catmull-Rom spline at angle a
+ */
+static void splineAt(const Motion *m, double a, double out[3]) {
+  const int n = m->keys;
+  if (n == 1) {
+    for (int c = 0; c < 3; c++) out[c] = m->key[0][1 + c];
+    return;
+  }
+  // Segment k runs from key k to key k+1 (the last wraps to key 0 + 360)
+  int k = n - 1;
+  if (a < m->key[0][0]) {
+    a += 360.0; // Before the first key: inside the wrap segment
+  } else {
+    for (int i = 0; i + 1 < n; i++)
+      if (a < m->key[i + 1][0]) {
+        k = i;
+        break;
+      }
+  }
+  const double a0 = m->key[k][0];
+  const double a1 = k + 1 < n ? m->key[k + 1][0] : m->key[0][0] + 360.0;
+  const double t = (a - a0) / (a1 - a0);
+  const double *p0 = m->key[(k + n - 1) % n], *p1 = m->key[k];
+  const double *p2 = m->key[(k + 1) % n], *p3 = m->key[(k + 2) % n];
+  const double t2 = t * t, t3 = t2 * t;
+  for (int c = 1; c <= 3; c++)
+    out[c - 1] = 0.5 * (2.0 * p1[c] + (p2[c] - p0[c]) * t +
+                        (2.0 * p0[c] - 5.0 * p1[c] + 4.0 * p2[c] - p3[c]) * t2 +
+                        (3.0 * p1[c] - p0[c] - 3.0 * p2[c] + p3[c]) * t3);
+}
+
+/*
+ *  Sample a motion into its table block and record the center's bounds
+ *  @param m motion
+ *  @param block samples (output, LUT_STRIDE x 3)
+ *  @param d target (bounds updated)
+ */
+static void sampleMotion(const Motion *m, float *block, TargetDef *d) {
+  for (int c = 0; c < 3; c++) d->lo[c] = d->hi[c] = d->base[c];
+  for (int s = 0; s < LUT_STRIDE; s++) {
+    const double a = 360.0 * (s % TARGET_LUT_SIZE) / TARGET_LUT_SIZE;
+    double off[3] = {0.0, 0.0, 0.0};
+    if (m->type == MOTION_SINE || m->type == MOTION_ORBIT) {
+      const double sn = Sin(m->cycles * a + m->phase);
+      const double cs = m->type == MOTION_ORBIT ? Cos(m->cycles * a + m->phase)
+                                                : 0.0;
+      for (int c = 0; c < 3; c++) off[c] = m->a[c] * sn + m->b[c] * cs;
+    } else if (m->type == MOTION_SPLINE) {
+      splineAt(m, a, off);
+    }
+    for (int c = 0; c < 3; c++) {
+      block[3 * s + c] = (float)off[c];
+      // Bounds of what is evaluated (float samples, linear between them)
+      const double p = d->base[c] + (float)off[c];
+      d->lo[c] = fmin(d->lo[c], p);
+      d->hi[c] = fmax(d->hi[c], p);
+    }
+  }
+}
+
+/*
+ *  Parse a layout into new tables
+ *  @param text layout text (modified: split into lines)
+ *  @param name file name for error messages
+ *  @param out definitions (output)
+ *  @param table motion samples (output, TARGET_MAX + 1 blocks)
+ *  @return number of targets, or -1 on error
+ */
+static int parseLayout(char *text, const char *name, TargetDef *out,
+                       float *table) {
+  int count = 0, lineNo = 0;
+  Motion m;
+  const char *err = NULL;
+  memset(table, 0, LUT_STRIDE * 3 * sizeof(float)); // Block 0: no motion
+
+  for (char *line = text; line && !err;) {
+    char *next = strchr(line, '\n');
+    if (next) *next++ = 0;
+    lineNo++;
+    char *hash = strchr(line, '#');
+    if (hash) *hash = 0;
+
+    char cmd[16];
+    int used = 0;
+    if (sscanf(line, " %15s%n", cmd, &used) != 1) {
+      line = next;
+      continue;
+    }
+    const char *args = line + used;
+    double v[9];
+    int n = 0;
+    if (strcmp(cmd, "target") && !count) {
+      err = "motion before the first target";
+    } else if (!strcmp(cmd, "target")) {
+      if (count && m.type == MOTION_SPLINE)
+        sampleMotion(&m, table + (size_t)count * LUT_STRIDE * 3,
+                     &out[count - 1]);
+      int rings;
+      if (count == TARGET_MAX) {
+        err = "too many targets";
+      } else if (sscanf(args, "%lf %lf %lf %lf %d %lf %lf %lf%n", &v[0],
+                        &v[1], &v[2], &v[3], &rings, &v[4], &v[5], &v[6],
+                        &n) != 8) {
+        err = "expected: target x y z radius rings r g b";
+      } else if (v[3] <= 0.0 || rings < 1 || rings > TARGET_MAX_RINGS) {
+        err = "radius must be positive and rings 1-8";
+      } else {
+        TargetDef *d = &out[count++];
+        memset(d, 0, sizeof(*d));
+        for (int c = 0; c < 3; c++) {
+          d->base[c] = d->lo[c] = d->hi[c] = v[c];
+          d->color[c] = v[4 + c];
+        }
+        d->radius = v[3];
+        d->rings = rings;
+        d->face[0] = 0.0;
+        d->face[1] = 30.0;
+        memset(&m, 0, sizeof(m));
+      }
+    } else if (!strcmp(cmd, "face")) {
+      if (sscanf(args, "%lf %lf", &v[0], &v[1]) != 2)
+        err = "expected: face x z";
+      else {
+        out[count - 1].face[0] = v[0];
+        out[count - 1].face[1] = v[1];
+      }
+    } else if (!strcmp(cmd, "key")) {
+      if (m.type != MOTION_STATIC && m.type != MOTION_SPLINE)
+        err = "target already has a motion";
+      else if (m.keys == TARGET_MAX_KEYS)
+        err = "too many keys";
+      else if (sscanf(args, "%lf %lf %lf %lf", &v[0], &v[1], &v[2], &v[3]) != 4)
+        err = "expected: key zh x y z";
+      else if (v[0] < 0.0 || v[0] >= 360.0 ||
+               (m.keys && v[0] <= m.key[m.keys - 1][0]))
+        err = "key angles must ascend within [0, 360)";
+      else {
+        m.type = MOTION_SPLINE;
+        for (int c = 0; c < 4; c++) m.key[m.keys][c] = v[c];
+        out[count - 1].lut = count * LUT_STRIDE;
+        m.keys++;
+      }
+    } else if (!strcmp(cmd, "static") || !strcmp(cmd, "sine") ||
+               !strcmp(cmd, "orbit")) {
+      const int orbit = !strcmp(cmd, "orbit");
+      const int want = !strcmp(cmd, "static") ? 0 : orbit ? 6 : 3;
+      int got = sscanf(args, "%lf %lf %lf %lf %lf %lf %lf %lf", &v[0], &v[1],
+                       &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]);
+      if (got < 0) got = 0;
+      if (m.type != MOTION_STATIC)
+        err = "target already has a motion";
+      else if (got < want || got > want + 2)
+        err = orbit ? "expected: orbit ax ay az bx by bz [cycles [phase]]"
+                    : want ? "expected: sine ax ay az [cycles [phase]]"
+                           : "expected: static";
+      else if (got > want && (v[want] < 1.0 || v[want] != floor(v[want])))
+        err = "cycles must be a positive whole number";
+      else if (want) {
+        m.type = orbit ? MOTION_ORBIT : MOTION_SINE;
+        for (int c = 0; c < 3; c++) {
+          m.a[c] = v[c];
+          m.b[c] = orbit ? v[3 + c] : 0.0;
+        }
+        m.cycles = got > want ? (int)v[want] : 1;
+        m.phase = got > want + 1 ? v[want + 1] : 0.0;
+        out[count - 1].lut = count * LUT_STRIDE;
+        sampleMotion(&m, table + (size_t)count * LUT_STRIDE * 3,
+                     &out[count - 1]);
+      }
+    } else {
+      err = "unknown command";
+    }
+    line = next;
+  }
+
+  if (!err && count && m.type == MOTION_SPLINE)
+    sampleMotion(&m, table + (size_t)count * LUT_STRIDE * 3, &out[count - 1]);
+  if (!err && !count) err = "no targets";
+  if (err) {
+    fprintf(stderr, "%s:%d: %s\n", name, lineNo, err);
+    return -1;
+  }
+  return count;
+}
+
+/*
+ *  Parse a layout and make it current
+ *  @return 1 on success, 0 on error (current layout kept)
+ */
+static int useLayout(char *text, const char *name) {
+  static TargetDef parsed[TARGET_MAX];
+  float *table = malloc((size_t)(TARGET_MAX + 1) * LUT_STRIDE * 3 *
+                        sizeof(float));
+  if (!table) Fatal("Cannot allocate target motion table\n");
+  const int count = parseLayout(text, name, parsed, table);
+  if (count < 0) {
+    free(table);
+    return 0;
+  }
+  // Keep only the blocks in use
+  float *fit = realloc(table, (size_t)(count + 1) * LUT_STRIDE * 3 *
+                                  sizeof(float));
+  free(lut);
+  lut = fit ? fit : table;
+  memcpy(defs, parsed, count * sizeof(TargetDef));
+  defCount = count;
+  layoutReady = 1;
+  return 1;
+}
+
+/*
+ *  Use the built-in layout if nothing has been loaded
+ *  (first called from the main thread, before any simulator workers start)
+ */
+static void ensureLayout(void) {
+  if (layoutReady) return;
+  char *text = strdup(builtInLayout);
+  if (!text || !useLayout(text, "built-in layout"))
+    Fatal("Cannot build the built-in target layout\n");
+  free(text);
+}
+
+/*
+ *  Load a target layout, replacing the current one
+ *  @param file layout file
+ *  @return 1 on success, 0 if the file is missing or malformed
+ */
+int loadTargetLayout(const char *file) {
+  FILE *f = fopen(file, "rb");
+  if (!f) {
+    fprintf(stderr, "Cannot open target layout %s\n", file);
+    return 0;
+  }
+  fseek(f, 0, SEEK_END);
+  long n = ftell(f);
+  rewind(f);
+  char *text = malloc(n + 1);
+  if (!text) Fatal("Cannot allocate %ld bytes for %s\n", n + 1, file);
+  if (n > 0 && fread(text, n, 1, f) != 1) n = 0;
+  text[n] = 0;
+  fclose(f);
+  const int ok = useLayout(text, file);
+  free(text);
+  return ok;
+}
+
+/*
+ *  Number of targets in the layout
+ */
+int targetLayoutCount(void) {
+  ensureLayout();
+  return defCount;
+}
+
+/*
+ *  Definition of one target
+ *  @param index target index (0 to count-1)
+ *  @return definition, or NULL if index is out of range
+ */
+const TargetDef *targetLayoutDef(int index) {
+  ensureLayout();
+  return index >= 0 && index < defCount ? &defs[index] : NULL;
+}
+
+/*
+ *  Centers of a run of targets at an animation angle
+ *  @param zh animation angle (degrees, any range)
+ *  @param first first target
+ *  @param count number of targets
+ *  @param pos centers (output)
+ */
+void targetLayoutPositions(double zh, int first, int count, double (*pos)[3]) {
+  ensureLayout();
+  // Table position of the angle, shared by every target
+  double u = zh / 360.0;
+  u = (u - floor(u)) * TARGET_LUT_SIZE;
+  int i = (int)u;
+  double f = u - i;
+  if (i >= TARGET_LUT_SIZE) {
+    i = TARGET_LUT_SIZE - 1;
+    f = 1.0;
+  }
+  for (int k = 0; k < count; k++) {
+    const TargetDef *d = &defs[first + k];
+    const float *a = lut + 3 * (d->lut + i), *b = a + 3;
+    for (int c = 0; c < 3; c++)
+      pos[k][c] = d->base[c] + a[c] + f * (b[c] - a[c]);
+  }
+}
@@ -0,0 +1,62 @@
+/*
+ *  Target layout object - header file
+ *  Target definitions (position, size, rings, color, facing and motion)
+ *  loaded from a layout file. Each target's motion over one animation
+ *  cycle is sampled once into a lookup table, so evaluating a pose is a
+ *  table read and a lerp.
+ */
+
+#ifndef OBJECTS_TARGETS_H
+#define OBJECTS_TARGETS_H
+
+#define TARGET_MAX 1024      // Most targets in a layout
+#define TARGET_MAX_RINGS 8   // Most rings on one target
+#define TARGET_LUT_SIZE 256  // Motion samples per animation cycle (360 deg)
+#define TARGET_MAX_KEYS 64   // Most spline keyframes per target
+
+/*
+ *  One target of the layout
+ */
+typedef struct {
+  double base[3];  // Position at zero motion offset
+  double radius;   // Outer radius
+  int rings;       // Number of rings
+  double color[3]; // Color for alternating rings
+  double face[2];  // XZ point the target faces
+  int lut;         // First sample of its motion in the shared table
+  double lo[3];    // Lowest center over the cycle
+  double hi[3];    // Highest center over the cycle
+} TargetDef;
+
+/*
+ *  Load a target layout, replacing the current one
+ *  Without a successful load the built-in five-target layout is used.
+ *  @param file layout file
+ *  @return 1 on success, 0 if the file is missing or malformed (an error
+ *          is printed and the current layout is kept)
+ */
+int loadTargetLayout(const char *file);
+
+/*
+ *  Number of targets in the layout
+ */
+int targetLayoutCount(void);
+
+/*
+ *  Definition of one target
+ *  @param index target index (0 to count-1)
+ *  @return definition, or NULL if index is out of range
+ */
+const TargetDef *targetLayoutDef(int index);
+
+/*
+ *  Centers of a run of targets at an animation angle
+ *  The angle's table position is found once for the whole run.
+ *  @param zh animation angle (degrees, any range)
+ *  @param first first target
+ *  @param count number of targets (first + count <= layout count)
+ *  @param pos centers (output, count entries)
+ */
+void targetLayoutPositions(double zh, int first, int count, double (*pos)[3]);
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ *  Trajectory preview object - implementation
+ *  The flight is in closed form, sampled at fixed times rather than stepped
+ *  through the simulation: the parabola p(t) = p0 + v0 t - g t^2 / 2 in
+ *  still air, and with drag k pulling the velocity toward the terminal
+ *  velocity u = (wind x, -g/k, wind z)
+ *    p(t) = p0 + u t + (v0 - u) (1 - e^-kt) / k
+ *  The wind is taken where the arrow is launched. The
+ *  tip's path between samples is swept against the moving targets (same
+ *  swept test as the game) and against the terrain.
+ */
+
+#include "trajectory.h"
+#include "arrow.h"
+#include "ground.h"
+#include "../utils.h"
+
+/*
+ *  Arrow tip at time t after launch (the arrow points along its velocity)
+ *  @param air wind x, wind z and drag rate
+ */
+static void tipAt(const double p0[3], const double v0[3], const double air[3],
+                  double t, double tip[3]) {
+  const double g = 9.8, k = air[2];
+  double p[3], v[3];
+  if (k > 0.0) {
+    const double u[3] = {air[0], -g / k, air[1]};
+    const double e = exp(-k * t), f = (1.0 - e) / k;
+    for (int a = 0; a < 3; a++) {
+      p[a] = p0[a] + u[a] * t + (v0[a] - u[a]) * f;
+      v[a] = u[a] + (v0[a] - u[a]) * e;
+    }
+  } else {
+    for (int a = 0; a < 3; a++) {
+      p[a] = p0[a] + v0[a] * t;
+      v[a] = v0[a];
+    }
+    p[1] -= 0.5 * g * t * t;
+    v[1] -= g * t;
+  }
+  double len = Vec3Length(v[0], v[1], v[2]);
+  if (len < 1e-9) len = 1e-9;
+  for (int a = 0; a < 3; a++) tip[a] = p[a] + ARROW_LENGTH * v[a] / len;
+}
+
+/*
+ *  Height of the tip above the terrain (the game's miss plane at y = -5
+ *  counts as ground too)
+ */
+static double clearance(const double tip[3]) {
+  return tip[1] - fmax(terrainHeightAt(tip[0], tip[2]), -5.0);
+}
+
+/*
+ *  Sample the arc for a launch and find where it meets the ground
+ */
+static void buildArc(Trajectory *tr, const double launch[9]) {
+  double v0[3];
+  DirectionFromAngles(launch[3], launch[4], &v0[0], &v0[1], &v0[2]);
+  for (int a = 0; a < 3; a++) v0[a] *= launch[5];
+
+  tr->arcPoints = TRAJ_POINTS;
+  tr->groundT = -1.0;
+  const double *air = launch + 6;
+  tipAt(launch, v0, air, 0.0, tr->arc[0]);
+  for (int k = 1; k < TRAJ_POINTS; k++) {
+    tipAt(launch, v0, air, k * TRAJ_STEP, tr->arc[k]);
+    if (clearance(tr->arc[k]) >= 0.0) continue;
+
+    // Bisect the crossing inside this segment
+    double lo = 0.0, hi = 1.0, tip[3];
+    for (int i = 0; i < 12; i++) {
+      const double mid = 0.5 * (lo + hi);
+      tipAt(launch, v0, air, (k - 1 + mid) * TRAJ_STEP, tip);
+      if (clearance(tip) < 0.0)
+        hi = mid;
+      else
+        lo = mid;
+    }
+    tipAt(launch, v0, air, (k - 1 + hi) * TRAJ_STEP, tr->groundHit);
+    tr->groundT = k - 1 + hi;
+    tr->arcPoints = k + 1;
+    break;
+  }
+}
+
+/*
+ *  Update the preview for a launch (no work if nothing changed)
+ */
+void updateTrajectory(Trajectory *tr, double x, double y, double z,
+                      double th, double ph, double speed,
+                      const WindField *wind, double zh, double rate) {
+  double air[2] = {0.0, 0.0};
+  const double k = wind ? wind->drag : 0.0;
+  if (k > 0.0) sampleWind(wind, x, z, air);
+  const double launch[9] = {x, y, z, th, ph, speed, air[0], air[1], k};
+  const int launchChanged =
+      !tr->valid || memcmp(launch, tr->launch, sizeof(launch));
+  if (!launchChanged && zh == tr->zh) return;
+  if (launchChanged) {
+    memcpy(tr->launch, launch, sizeof(launch));
+    buildArc(tr, launch);
+  }
+  tr->zh = zh;
+  tr->valid = 1;
+
+  // First target hit, if it comes before the ground
+  double endT = tr->arcPoints - 1;
+  const double *end = tr->arc[tr->arcPoints - 1];
+  tr->hitKind = TRAJ_MISS;
+  if (tr->groundT >= 0.0) {
+    endT = tr->groundT;
+    end = tr->groundHit;
+    tr->hitKind = TRAJ_GROUND;
+  }
+  if (sweepPathBullseyes((const double(*)[3])tr->arc, tr->arcPoints, zh,
+                         rate * TRAJ_STEP, &tr->hit) &&
+      tr->hit.t <= endT) {
+    endT = tr->hit.t;
+    end = &tr->hit.x;
+    tr->hitKind = TRAJ_TARGET;
+  }
+
+  // Line: every sample before the end, then the end point
+  int n = 0;
+  for (int i = 0; i < tr->arcPoints && i < endT; i++, n++)
+    for (int a = 0; a < 3; a++) tr->line[n][a] = tr->arc[i][a];
+  for (int a = 0; a < 3; a++) tr->line[n][a] = end[a];
+  tr->linePoints = n + 1;
+}
+
+/*
+ *  Draw the predicted arc and a marker at its hit point
+ */
+void drawTrajectory(const Trajectory *tr) {
+  if (!tr->valid) return;
+  glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LINE_BIT | GL_POINT_BIT);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_TEXTURE_2D);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 0, tr->line);
+  glLineWidth(2.0f);
+  glColor4f(1.0f, 1.0f, 1.0f, 0.6f);
+  glDrawArrays(GL_LINE_STRIP, 0, tr->linePoints);
+
+  // Marker: yellow on a target, tan on the ground, none for a miss
+  if (tr->hitKind != TRAJ_MISS) {
+    if (tr->hitKind == TRAJ_TARGET)
+      glColor4f(1.0f, 1.0f, 0.0f, 0.9f);
+    else
+      glColor4f(0.8f, 0.7f, 0.5f, 0.9f);
+    glPointSize(9.0f);
+    glDrawArrays(GL_POINTS, tr->linePoints - 1, 1);
+  }
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glPopAttrib();
+}
@@ -0,0 +1,62 @@
+/*
+ *  Trajectory preview object - header file
+ *  Predicted flight of the arrow being charged, drawn as an arc that ends
+ *  at its first hit on a target or the terrain
+ */
+
+#ifndef OBJECTS_TRAJECTORY_H
+#define OBJECTS_TRAJECTORY_H
+
+#include "bullseye.h"
+#include "../wind.h"
+
+#define TRAJ_POINTS 65       // Arc samples (64 segments)
+#define TRAJ_STEP (1.0 / 16) // Flight time between samples (seconds)
+
+/*
+ *  What the predicted arc ends on
+ */
+enum { TRAJ_MISS, TRAJ_TARGET, TRAJ_GROUND };
+
+/*
+ *  Cached preview: the arc is rebuilt only when the launch changes and the
+ *  target test only when the launch or the target angle changes
+ */
+typedef struct {
+  int valid;                   // Arc holds a computed launch
+  double launch[9];            // x, y, z, th, ph, speed, wind x, z, drag
+  double zh;                   // Target angle the hit was predicted for
+  double arc[TRAJ_POINTS][3];  // Arrow tip every TRAJ_STEP seconds
+  int arcPoints;               // Samples up to the ground (or the last one)
+  double groundT;              // Ground crossing (segment + fraction), or -1
+  double groundHit[3];         // Ground crossing point
+  int hitKind;                 // TRAJ_* the arc ends on
+  BullseyeHit hit;             // Target hit (hitKind == TRAJ_TARGET)
+  float line[TRAJ_POINTS + 1][3]; // Arc to draw, ending at the hit point
+  int linePoints;              // Points in line
+} Trajectory;
+
+/*
+ *  Update the preview for a launch (no work if nothing changed)
+ *  @param tr preview cache
+ *  @param x launch position x
+ *  @param y launch position y
+ *  @param z launch position z
+ *  @param th view angle theta (degrees)
+ *  @param ph view angle phi (degrees)
+ *  @param speed launch speed
+ *  @param wind air the arrow flies through (NULL for still air)
+ *  @param zh animation angle of targets at launch
+ *  @param rate target animation speed (degrees per second)
+ */
+void updateTrajectory(Trajectory *tr, double x, double y, double z,
+                      double th, double ph, double speed,
+                      const WindField *wind, double zh, double rate);
+
+/*
+ *  Draw the predicted arc and a marker at its hit point
+ *  @param tr preview cache
+ */
+void drawTrajectory(const Trajectory *tr);
+
+#endif
@@ -3,6 +3,7 @@
  */
 
 #include "tree.h"
+#include "ground.h"
 #include "../utils.h"
 
 /* 
@@ -94,6 +95,11 @@ static void drawFrustum(double r0, double r1, double length, unsigned int sides,
   if (texture) glDisable(GL_TEXTURE_2D);
 }
 
+/*
+ *  Sway amplitude of the tree being drawn (set from its local wind)
+ */
+static double swayGain = 1.0;
+
 /*
  *  Add leaf clusters to branch tips (only for outer branches)
  *  @param depth branch depth
@@ -132,7 +138,7 @@ static void addLeavesToBranch(int depth, double len, double r, double anim,
     double yRot = 360.0 * Rand01(lseed + 5u);
 
     /* Gentle sway */
-    double sway = 3.0 * Sin(anim + (double)i * 23.0 + (double)depth * 17.0);
+    double sway = 3.0 * swayGain * Sin(anim + (double)i * 23.0 + (double)depth * 17.0);
 
     glPushMatrix();
     glTranslated(xOff, yPos, zOff);
@@ -143,76 +149,6 @@ static void addLeavesToBranch(int depth, double len, double r, double anim,
   }
 }
 
-/* 
- *  Forward declaration for helper used by drawForest
- *  @param x X position
- *  @param z Z position
- *  @param anim animation phase
- *  @param barkTexture bark texture
- *  @param leafTexture leaf texture
- *  @param seed random seed
- *  @param leavesOnly only draw leaves
- */
-static void drawTreeAt(double x, double z, double anim,
-                       unsigned int barkTexture, unsigned int leafTexture,
-                       unsigned int seed, int leavesOnly);
-
-/* 
- *  Internal helper: iterate all tree rings and draw each tree
- *  @param anim animation phase
- *  @param barkTexture bark texture
- *  @param leafTexture leaf texture
- *  @param leavesOnly only draw leaves 
- */
-static void drawForest(double anim, unsigned int barkTexture,
-                       unsigned int leafTexture, int leavesOnly) {
-  const double r1 = 15.0;
-  const double r2 = 22.0;
-  const double r3 = 29.0;
-  const double r4 = 36.0;
-
-  int n1 = 4;
-  for (int i = 0; i < n1; i++) {
-    unsigned int seed = 12345u + (unsigned int)i * 17u;
-    double a = i * (360.0 / n1) + (25.0 * Rand01(seed + 50u) - 12.5);
-    double rVar = r1 + (3.0 * Rand01(seed + 51u) - 1.5);
-    double x = rVar * Cos(a);
-    double z = rVar * Sin(a);
-    drawTreeAt(x, z, anim, leavesOnly ? 0 : barkTexture, leafTexture,
-               seed, leavesOnly);
-  }
-  int n2 = 6;
-  for (int i = 0; i < n2; i++) {
-    unsigned int seed = 67890u + (unsigned int)i * 31u;
-    double a = i * (360.0 / n2) + 12.0 + (20.0 * Rand01(seed + 50u) - 10.0);
-    double rVar = r2 + (3.5 * Rand01(seed + 51u) - 1.75);
-    double x = rVar * Cos(a);
-    double z = rVar * Sin(a);
-    drawTreeAt(x, z, anim, leavesOnly ? 0 : barkTexture, leafTexture,
-               seed, leavesOnly);
-  }
-  int n3 = 8;
-  for (int i = 0; i < n3; i++) {
-    unsigned int seed = 24680u + (unsigned int)i * 41u;
-    double a = i * (360.0 / n3) + 8.0 + (18.0 * Rand01(seed + 50u) - 9.0);
-    double rVar = r3 + (4.0 * Rand01(seed + 51u) - 2.0);
-    double x = rVar * Cos(a);
-    double z = rVar * Sin(a);
-    drawTreeAt(x, z, anim, leavesOnly ? 0 : barkTexture, leafTexture,
-               seed, leavesOnly);
-  }
-  int n4 = 10;
-  for (int i = 0; i < n4; i++) {
-    unsigned int seed = 13579u + (unsigned int)i * 53u;
-    double a = i * (360.0 / n4) + 15.0 + (16.0 * Rand01(seed + 50u) - 8.0);
-    double rVar = r4 + (4.5 * Rand01(seed + 51u) - 2.25);
-    double x = rVar * Cos(a);
-    double z = rVar * Sin(a);
-    drawTreeAt(x, z, anim, leavesOnly ? 0 : barkTexture, leafTexture,
-               seed, leavesOnly);
-  }
-}
-
 /*
  *  Recursive branch: starts at origin, grows along +Y.
  *  @param len branch length
@@ -265,7 +201,7 @@ static void drawBranch(double len, double r, int depth, double swayDeg,
     if (si < segs - 1) {
       double bend = 2.0 + 3.0 * Rand01(seed + 22u + si * 3u);
       double bendDir = 360.0 * Rand01(seed + 23u + si * 7u);
-      double sway = 0.8 * Sin(swayDeg + (double)(depth + si) * 17.0);
+      double sway = 0.8 * swayGain * Sin(swayDeg + (double)(depth + si) * 17.0);
       double ax = Cos(bendDir), az = Sin(bendDir);
       /* Translate to segment end first */
       glTranslated(0, segLen, 0);
@@ -302,7 +238,7 @@ static void drawBranch(double len, double r, int depth, double swayDeg,
     /* Make first branches (depth >= 4) shorter */
     double scale = (depth >= 4) ? (0.55 + 0.12 * Rand01(cseed + 3u))
                                 : (0.70 + 0.18 * Rand01(cseed + 3u));
-    double swayYaw = 2.5 * Sin(swayDeg + (double)(i * depth) * 13.0);
+    double swayYaw = 2.5 * swayGain * Sin(swayDeg + (double)(i * depth) * 13.0);
 
     glPushMatrix();
     glRotated(angY + swayYaw, 0, 1, 0);
@@ -340,23 +276,6 @@ static void drawBranch(double len, double r, int depth, double swayDeg,
   glPopMatrix();
 }
 
-/*
- *  Simple helper to compute approximate terrain height used in ground.c for placement
- *  @param x X position
- *  @param z Z position
- *  @return approximate terrain height
- */
-static double approxTerrainY(double x, double z) {
-  /* Mirror ground.c: steepness=0.5 and groundY=-3.0 */
-  double steep = 0.5;
-  double h = 0.0;
-  // Uses sin and cos in radians to match terrainHeight
-  h += 0.3 * sin(x * 0.5) * cos(z * 0.5);
-  h += 0.2 * sin(x * 0.8 + z * 0.3);
-  h += 0.15 * cos(x * 1.2 - z * 0.7);
-  return -3.0 + h * steep;
-}
-
 /*
  *  Draw a single tree from a Tree struct
  *  @param t Tree struct
@@ -368,6 +287,11 @@ void drawTree(const Tree *t, int leavesOnly) {
 
   glPushMatrix();
   glTranslated(t->x, t->y, t->z);
+  /* Lean downwind and sway harder in stronger wind */
+  const double wind = Vec3Length(t->windX, 0.0, t->windZ);
+  swayGain = 0.5 + 0.25 * wind;
+  if (wind > 1e-6)
+    glRotated(fmin(1.5 * wind, 10.0), t->windZ / wind, 0, -t->windX / wind);
   /* Small base tilt to avoid perfect verticals */
   double tilt = 2.0 * (Rand01(t->seed + 11u) - 0.5);
   double tiltDir = 360.0 * Rand01(t->seed + 12u);
@@ -393,42 +317,125 @@ void drawTree(const Tree *t, int leavesOnly) {
 }
 
 /*
- *  Internal helper: draw a tree at (x,z) with procedural parameters
- *  @param x X position
- *  @param z Z position
+ *  Rings of trees around the targets: tree count, first seed and seed step,
+ *  angle offset and jitter (degrees), radius and radius jitter
+ */
+static const struct {
+  int count;
+  unsigned int seed, seedStep;
+  double angle, angleJitter, radius, radiusJitter;
+} forestRings[] = {
+    {4, 12345u, 17u, 0.0, 25.0, 15.0, 3.0},
+    {6, 67890u, 31u, 12.0, 20.0, 22.0, 3.5},
+    {8, 24680u, 41u, 8.0, 18.0, 29.0, 4.0},
+    {10, 13579u, 53u, 15.0, 16.0, 36.0, 4.5},
+};
+
+/*
+ *  Allocate an empty forest
+ *  @param f forest to initialize
+ *  @param capacity most trees
+ *  @return 1 on success, 0 if allocation failed
+ */
+int initForest(Forest *f, int capacity) {
+  memset(f, 0, sizeof(*f));
+  f->base = malloc(capacity * sizeof(*f->base));
+  f->shape = malloc(capacity * sizeof(*f->shape));
+  if (!f->base || !f->shape) {
+    freeForest(f);
+    return 0;
+  }
+  f->capacity = capacity;
+  return 1;
+}
+
+/*
+ *  Release a forest
+ *  @param f forest
+ */
+void freeForest(Forest *f) {
+  free(f->base);
+  free(f->shape);
+  memset(f, 0, sizeof(*f));
+}
+
+/*
+ *  Plant the forest: each tree's base (standing on the terrain) and its
+ *  procedural shape
+ *  @param f forest (allocated with initForest)
+ *  @return trees planted
+ */
+int spawnForest(Forest *f) {
+  const int rings = (int)(sizeof(forestRings) / sizeof(forestRings[0]));
+  f->count = 0;
+  for (int r = 0; r < rings; r++) {
+    const int n = forestRings[r].count;
+    const double aj = forestRings[r].angleJitter;
+    const double rj = forestRings[r].radiusJitter;
+    for (int i = 0; i < n; i++) {
+      unsigned int seed =
+          forestRings[r].seed + (unsigned int)i * forestRings[r].seedStep;
+      double a = i * (360.0 / n) + forestRings[r].angle +
+                 (aj * Rand01(seed + 50u) - 0.5 * aj);
+      double rVar = forestRings[r].radius + (rj * Rand01(seed + 51u) - 0.5 * rj);
+      double x = rVar * Cos(a);
+      double z = rVar * Sin(a);
+
+      if (f->count == f->capacity) return f->count;
+      const int k = f->count++;
+      f->base[k][0] = x;
+      f->base[k][1] = terrainHeightAt(x, z);
+      f->base[k][2] = z;
+      f->shape[k] = (TreeShape){.baseLength = 2.5 + 1.2 * Rand01(seed + 5u),
+                                .baseRadius = 0.25 + 0.08 * Rand01(seed + 6u),
+                                .depth = 4 + (int)(2.0 * Rand01(seed + 7u)),
+                                .seed = seed};
+    }
+  }
+  return f->count;
+}
+
+/*
+ *  Draw every tree of a forest, in planting order
+ *  @param f forest
  *  @param anim animation phase
+ *  @param wind wind field (NULL for still air)
  *  @param barkTexture bark texture
  *  @param leafTexture leaf texture
- *  @param seed random seed
  *  @param leavesOnly only draw leaves
  */
-static void drawTreeAt(double x, double z, double anim,
+static void drawForest(const Forest *f, double anim, const WindField *wind,
                        unsigned int barkTexture, unsigned int leafTexture,
-                       unsigned int seed, int leavesOnly) {
-  double y = approxTerrainY(x, z);
-  double baseLen = 2.5 + 1.2 * Rand01(seed + 5u);
-  double baseRad = 0.25 + 0.08 * Rand01(seed + 6u);
-  int depth = 4 + (int)(2.0 * Rand01(seed + 7u));
-
-  Tree t = {.x = x, .y = y, .z = z,
-            .baseLength = baseLen,
-            .baseRadius = baseRad,
-            .depth = depth,
-            .barkTexture = barkTexture,
-            .leafTexture = leafTexture,
-            .anim = anim,
-            .seed = seed};
-  drawTree(&t, leavesOnly);
+                       int leavesOnly) {
+  const TreeShape *shape = f->shape;
+  for (int k = 0; k < f->count; k++) {
+    const float *m = f->base[k];
+    double wv[2] = {0.0, 0.0};
+    if (wind) sampleWind(wind, m[0], m[2], wv);
+    Tree t = {.x = m[0], .y = m[1], .z = m[2],
+              .baseLength = shape[k].baseLength,
+              .baseRadius = shape[k].baseRadius,
+              .depth = shape[k].depth,
+              .barkTexture = leavesOnly ? 0 : barkTexture,
+              .leafTexture = leafTexture,
+              .anim = anim,
+              .windX = wv[0],
+              .windZ = wv[1],
+              .seed = shape[k].seed};
+    drawTree(&t, leavesOnly);
+  }
 }
 
 /*
- *  Public entry: draw a ring (or two) of trees around origin/bullseyes
+ *  Public entry: draw every tree in the forest
+ *  @param f forest
  *  @param anim animation phase
+ *  @param wind wind field (NULL for still air)
  *  @param barkTexture bark texture
  *  @param leafTexture leaf texture
  */
-void drawTreeScene(double anim, unsigned int barkTexture,
-                   unsigned int leafTexture) {
+void drawTreeScene(const Forest *f, double anim, const WindField *wind,
+                   unsigned int barkTexture, unsigned int leafTexture) {
   /* Set face winding for tree geometry */
   glFrontFace(GL_CW); // Tree geometry winds clockwise; treat CW as front
   /* Material: slightly less specular for bark */
@@ -437,7 +444,7 @@ void drawTreeScene(double anim, unsigned int barkTexture,
   glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, 6.0f);
 
   /* Iterate via shared helper */
-  drawForest(anim, barkTexture, leafTexture, 0);
+  drawForest(f, anim, wind, barkTexture, leafTexture, 0);
 
   /* Restore generic specular */
   float white[] = {1, 1, 1, 1};
@@ -448,10 +455,13 @@ void drawTreeScene(double anim, unsigned int barkTexture,
 
 /*
  *  Draw only leaves for all trees (separate function for transparent pass)
+ *  @param f forest
  *  @param anim animation phase
+ *  @param wind wind field (NULL for still air)
  *  @param leafTexture leaf texture
  */
-void drawTreeLeaves(double anim, unsigned int leafTexture) {
+void drawTreeLeaves(const Forest *f, double anim, const WindField *wind,
+                    unsigned int leafTexture) {
   if (!leafTexture) return;
-  drawForest(anim, 0, leafTexture, 1);
+  drawForest(f, anim, wind, 0, leafTexture, 1);
 }
@@ -6,6 +6,9 @@
 #ifndef OBJECTS_TREE_H
 #define OBJECTS_TREE_H
 
+#include "../scene.h"
+#include "../wind.h"
+
 /*
  *  Tree description for passing parameters around
  */
@@ -21,10 +24,32 @@ typedef struct {
   unsigned int leafTexture;
   /* animation and rendering */
   double anim;     /* animation parameter (sway angle in degrees) */
+  double windX, windZ; /* wind at the tree (leans and sways it) */
   /* seeding for procedural variation */
   unsigned int seed;
 } Tree;
 
+/*
+ *  Procedural shape of one tree in a forest
+ */
+typedef struct {
+  double baseLength; /* initial trunk length */
+  double baseRadius; /* initial trunk radius */
+  int depth;         /* recursion depth */
+  unsigned int seed; /* seed for procedural variation */
+} TreeShape;
+
+/*
+ *  Forest: every tree's base and shape in dense parallel arrays, planted
+ *  once at startup so each pass draws it with one linear loop
+ */
+typedef struct {
+  int capacity;     /* most trees */
+  int count;        /* trees planted */
+  float (*base)[3]; /* where each tree stands on the terrain */
+  TreeShape *shape; /* procedural shape of each tree */
+} Forest;
+
 /*
  *  Function prototypes
  */
@@ -37,19 +62,46 @@ typedef struct {
 void drawTree(const Tree *t, int leavesOnly);
 
 /*
- *  Draw the scene with a forest of trees around the bullseye scene
+ *  Allocate an empty forest
+ *  @param f forest to initialize
+ *  @param capacity most trees
+ *  @return 1 on success, 0 if allocation failed
+ */
+int initForest(Forest *f, int capacity);
+
+/*
+ *  Release a forest
+ *  @param f forest
+ */
+void freeForest(Forest *f);
+
+/*
+ *  Plant the rings of trees around the targets on the terrain surface
+ *  (call after setTerrainLayout)
+ *  @param f forest (allocated with initForest)
+ *  @return trees planted
+ */
+int spawnForest(Forest *f);
+
+/*
+ *  Draw every tree in a forest (trunks and branches, plus leaves if given)
+ *  @param f forest
  *  @param anim animation parameter (e.g., sway angle in degrees)
+ *  @param wind wind field the trees sway in (NULL for still air)
  *  @param barkTexture OpenGL texture ID for bark
  *  @param leafTexture OpenGL texture ID for leaves (0 = draw only trunks/branches)
  */
-void drawTreeScene(double anim, unsigned int barkTexture,
-                   unsigned int leafTexture);
+void drawTreeScene(const Forest *f, double anim, const WindField *wind,
+                   unsigned int barkTexture, unsigned int leafTexture);
 
 /*
  *  Draw only the leaves for all trees (for transparent pass)
+ *  @param f forest
  *  @param anim animation parameter (e.g., sway angle in degrees)
+ *  @param wind wind field the trees sway in (NULL for still air)
  *  @param leafTexture OpenGL texture ID for leaves
  */
-void drawTreeLeaves(double anim, unsigned int leafTexture);
+void drawTreeLeaves(const Forest *f, double anim, const WindField *wind,
+                    unsigned int leafTexture);
 
 #endif
@@ -0,0 +1,22 @@
+#version 330 compatibility
+
+uniform int fogEnabled; // Non-zero when fog should be applied
+
+in vec4 color;    // Sprite color
+in float fogDist; // Distance from eye
+
+void main()
+{
+   // Round sprite with a soft edge
+   vec2 d = gl_PointCoord * 2.0 - 1.0;
+   float r2 = dot(d, d);
+   if (r2 > 1.0) discard;
+   vec4 c = vec4(color.rgb, color.a * (1.0 - r2));
+   // Linear fog, same as the terrain shader
+   if (fogEnabled != 0)
+   {
+      float fogFactor = clamp((gl_Fog.end - fogDist) * gl_Fog.scale, 0.0, 1.0);
+      c.rgb = mix(gl_Fog.color.rgb, c.rgb, fogFactor);
+   }
+   gl_FragColor = c;
+}
@@ -0,0 +1,28 @@
+#version 330 compatibility
+
+// One point per particle
+layout(location = 0) in vec4 posSize; // World position, sprite diameter
+layout(location = 1) in vec4 rgba;    // Color, alpha faded by age
+
+uniform float viewportHeight; // Viewport height in pixels
+uniform int lit;              // Non-zero when fixed-function lighting is on
+
+out vec4 color;    // Sprite color
+out float fogDist; // Distance from eye for fog
+
+void main()
+{
+   vec4 P = gl_ModelViewMatrix * vec4(posSize.xyz, 1.0);
+   fogDist = length(P.xyz);
+   gl_Position = gl_ProjectionMatrix * P;
+
+   // Diameter in pixels: world size projected at this depth
+   float pixels = posSize.w * gl_ProjectionMatrix[1][1] * 0.5 * viewportHeight;
+   gl_PointSize = clamp(pixels / max(-P.z, 0.1), 1.0, 64.0);
+
+   // Unlit dust would glow at night: scale by the ambient + diffuse light
+   color = rgba;
+   if (lit != 0)
+      color.rgb *= min(gl_LightModel.ambient.rgb + gl_LightSource[0].ambient.rgb +
+                       gl_LightSource[0].diffuse.rgb, vec3(1.0));
+}
@@ -0,0 +1,153 @@
+/*
+ *  Replay module - implementation file
+ *  Recordings are plain text:
+ *    archery-replay 2
+ *    state <ReplayState fields>
+ *    <tick> <type> <a> <b> <x> <y>      (one line per event)
+ *    end <ticks> <fired> <hits> <score> <checksum>
+ *  Doubles are written with %.17g so they read back bit-exact.
+ */
+#include "replay.h"
+#include "utils.h"
+
+static FILE *recordFile = NULL; // Open while recording
+static ReplayEvent *events = NULL; // Loaded events
+static int eventCount = 0;
+static int nextEvent = 0;        // Next event to play
+static int replayLoaded = 0;
+static ReplayResult recorded;    // Outcome stored in the recording
+
+/*
+ *  Start recording to a file
+ *  @param file output file
+ *  @param state initial simulation state
+ *  @return 1 on success, 0 if the file can't be written
+ */
+int startRecording(const char *file, const ReplayState *state) {
+  recordFile = fopen(file, "w");
+  if (!recordFile) return 0;
+  fprintf(recordFile, "archery-replay 2\n");
+  fprintf(recordFile,
+          "state %.17g %.17g %.17g %.17g %.17g %d %.17g %.17g %.17g %.17g "
+          "%.17g %d %d %d %d %u %.17g %.17g\n",
+          state->px, state->py, state->pz, state->th, state->ph, state->mode,
+          state->zhTargets, state->zhTrees, state->dayNightCycle,
+          state->targetRate, state->cycleRate, state->moveCycle,
+          state->rapidFire, state->score, state->arrowsLeft, state->seed,
+          state->wind, state->drag);
+  return 1;
+}
+
+/*
+ *  Record one input event (ignored when not recording)
+ */
+void recordEvent(int tick, int type, int a, int b, int x, int y) {
+  if (!recordFile) return;
+  fprintf(recordFile, "%d %d %d %d %d %d\n", tick, type, a, b, x, y);
+}
+
+/*
+ *  Finish a recording with the session's outcome
+ *  @param result outcome to store for later comparison
+ */
+void stopRecording(const ReplayResult *result) {
+  if (!recordFile) return;
+  fprintf(recordFile, "end %d %d %d %d %u\n", result->ticks, result->fired,
+          result->hits, result->score, result->checksum);
+  fclose(recordFile);
+  recordFile = NULL;
+}
+
+/*
+ *  Load a recording for playback
+ *  @param file recording file
+ *  @param state initial simulation state (output)
+ *  @return 1 on success, 0 if the file is missing or malformed
+ */
+int loadReplay(const char *file, ReplayState *state) {
+  FILE *f = fopen(file, "r");
+  if (!f) return 0;
+  int version = 0;
+  if (fscanf(f, "archery-replay %d", &version) != 1 || version < 1 ||
+      version > 2 ||
+      fscanf(f, " state %lf %lf %lf %lf %lf %d %lf %lf %lf %lf %lf %d %d %d %d %u",
+             &state->px, &state->py, &state->pz, &state->th, &state->ph,
+             &state->mode, &state->zhTargets, &state->zhTrees,
+             &state->dayNightCycle, &state->targetRate, &state->cycleRate,
+             &state->moveCycle, &state->rapidFire, &state->score,
+             &state->arrowsLeft, &state->seed) != 16) {
+    fclose(f);
+    return 0;
+  }
+  // Version 1 predates wind: those sessions flew in still air
+  state->wind = state->drag = 0.0;
+  if (version >= 2 &&
+      fscanf(f, " %lf %lf", &state->wind, &state->drag) != 2) {
+    fclose(f);
+    return 0;
+  }
+
+  // Events until the "end" line (a recording cut short has none)
+  int capacity = 1024;
+  events = realloc(events, capacity * sizeof(ReplayEvent));
+  eventCount = 0;
+  memset(&recorded, 0, sizeof(recorded));
+  ReplayEvent ev;
+  while (fscanf(f, " %d %d %d %d %d %d", &ev.tick, &ev.type, &ev.a, &ev.b,
+                &ev.x, &ev.y) == 6) {
+    if (eventCount == capacity) {
+      capacity *= 2;
+      events = realloc(events, capacity * sizeof(ReplayEvent));
+    }
+    if (!events) Fatal("Out of memory loading %s\n", file);
+    events[eventCount++] = ev;
+    recorded.ticks = ev.tick;
+  }
+  if (fscanf(f, " end %d %d %d %d %u", &recorded.ticks, &recorded.fired,
+             &recorded.hits, &recorded.score, &recorded.checksum) != 5)
+    fprintf(stderr, "Replay %s has no end record; outcome can't be checked\n",
+            file);
+  fclose(f);
+
+  nextEvent = 0;
+  replayLoaded = 1;
+  return 1;
+}
+
+/*
+ *  Next recorded event due at or before a tick
+ *  @return 1 if an event was returned, 0 if none is due
+ */
+int nextReplayEvent(int tick, ReplayEvent *ev) {
+  if (!replayLoaded || nextEvent >= eventCount || events[nextEvent].tick > tick)
+    return 0;
+  *ev = events[nextEvent++];
+  return 1;
+}
+
+int isRecording(void) { return recordFile != NULL; }
+
+int isReplaying(void) { return replayLoaded; }
+
+int replayLength(void) { return recorded.ticks; }
+
+/*
+ *  Compare a replay's outcome with the recorded one and print both
+ *  @param result outcome of the playback
+ *  @return 1 if they match exactly
+ */
+int checkReplayResult(const ReplayResult *result) {
+  int match = result->ticks == recorded.ticks &&
+              result->fired == recorded.fired &&
+              result->hits == recorded.hits &&
+              result->score == recorded.score &&
+              result->checksum == recorded.checksum;
+  printf("Recorded: ticks %d fired %d hits %d score %d checksum %08x\n",
+         recorded.ticks, recorded.fired, recorded.hits, recorded.score,
+         recorded.checksum);
+  printf("Replayed: ticks %d fired %d hits %d score %d checksum %08x\n",
+         result->ticks, result->fired, result->hits, result->score,
+         result->checksum);
+  printf("Replay %s\n", match ? "MATCHES" : "DIFFERS");
+  return match;
+}
@@ -0,0 +1,126 @@
+/*
+ *  Replay module - header file
+ *  Records input events stamped with the simulation tick they precede, plus
+ *  the initial game state, and plays them back so a session reproduces the
+ *  same arrows, hits and score
+ */
+#ifndef REPLAY_H
+#define REPLAY_H
+
+/*
+ *  Input event types (one per GLUT input callback)
+ */
+enum {
+  REPLAY_KEY,     // key(ch, x, y)
+  REPLAY_KEY_UP,  // keyUp(ch, x, y)
+  REPLAY_SPECIAL, // specialDown(key, x, y)
+  REPLAY_MOUSE,   // mouse(button, state, x, y)
+  REPLAY_MOTION   // motion(x, y)
+};
+
+/*
+ *  One recorded input event
+ */
+typedef struct {
+  int tick;         // Event is applied before this simulation tick
+  int type;         // REPLAY_* event type
+  int a, b;         // key/button and state (unused fields are 0)
+  int x, y;         // Mouse position
+} ReplayEvent;
+
+/*
+ *  Simulation state at the start of a recording
+ */
+typedef struct {
+  double px, py, pz;         // Camera position
+  double th, ph;             // View angles
+  int mode;                  // View mode
+  double zhTargets, zhTrees; // Animation angles
+  double dayNightCycle;      // Day/night cycle position
+  double targetRate;         // Target speed (degrees per second)
+  double cycleRate;          // Day/night speed (cycles per second)
+  int moveCycle;             // Day/night cycle running
+  int rapidFire;             // Rapid-fire mode
+  int score, arrowsLeft;     // Game state
+  unsigned int seed;         // Simulation random seed
+  double wind;               // Mean wind speed
+  double drag;               // Arrow drag rate (version 1 files: no wind
+                             // and no drag, as recorded)
+} ReplayState;
+
+/*
+ *  Outcome of a session, written at the end of a recording and compared
+ *  after a replay
+ */
+typedef struct {
+  int ticks;             // Simulation ticks run
+  int fired, hits;       // Arrows fired and arrows that hit a target
+  int score;             // Final score
+  unsigned int checksum; // Hash of the final arrow state
+} ReplayResult;
+
+/*
+ *  Start recording to a file
+ *  @param file output file
+ *  @param state initial simulation state
+ *  @return 1 on success, 0 if the file can't be written
+ */
+int startRecording(const char *file, const ReplayState *state);
+
+/*
+ *  Record one input event (ignored when not recording)
+ *  @param tick next simulation tick
+ *  @param type REPLAY_* event type
+ *  @param a key or button
+ *  @param b button state
+ *  @param x mouse x
+ *  @param y mouse y
+ */
+void recordEvent(int tick, int type, int a, int b, int x, int y);
+
+/*
+ *  Finish a recording with the session's outcome
+ *  @param result outcome to store for later comparison
+ */
+void stopRecording(const ReplayResult *result);
+
+/*
+ *  Load a recording for playback
+ *  @param file recording file
+ *  @param state initial simulation state (output)
+ *  @return 1 on success, 0 if the file is missing or malformed
+ */
+int loadReplay(const char *file, ReplayState *state);
+
+/*
+ *  Next recorded event due at or before a tick
+ *  @param tick simulation tick about to run
+ *  @param ev event (output)
+ *  @return 1 if an event was returned, 0 if none is due
+ */
+int nextReplayEvent(int tick, ReplayEvent *ev);
+
+/*
+ *  @return 1 while recording
+ */
+int isRecording(void);
+
+/*
+ *  @return 1 while a loaded replay is being played
+ */
+int isReplaying(void);
+
+/*
+ *  Length of the loaded replay
+ *  @return number of simulation ticks in the recording
+ */
+int replayLength(void);
+
+/*
+ *  Compare a replay's outcome with the recorded one and print both
+ *  @param result outcome of the playback
+ *  @return 1 if they match exactly
+ */
+int checkReplayResult(const ReplayResult *result);
+
+#endif
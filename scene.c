@@ -0,0 +1,188 @@
+/*
+ *  Scene graph module - implementation file
+ *  An update runs one pass per tree level over the node arrays in storage
+ *  order (not by walking child lists), so a parent is always done before
+ *  its children and memory is read front to back. A node is recomputed
+ *  if it or its parent is dirty; the dirty bit then carries down a level.
+ */
+#include "scene.h"
+#include "utils.h"
+
+static const SceneTransform identity = {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+/*
+ *  Allocate an empty scene graph
+ *  @param g graph to initialize
+ *  @param capacity maximum number of nodes
+ *  @return 1 on success, 0 if allocation failed
+ */
+int initSceneGraph(SceneGraph *g, int capacity) {
+  memset(g, 0, sizeof(*g));
+  g->local = malloc(capacity * sizeof(SceneTransform));
+  g->world = malloc(capacity * sizeof(SceneTransform));
+  // One block for the five link arrays
+  int *links = malloc((size_t)capacity * 5 * sizeof(int));
+  // One block for depth and flags
+  g->depth = calloc(capacity, 2);
+  if (!g->local || !g->world || !links || !g->depth) {
+    free(g->local);
+    free(g->world);
+    free(links);
+    free(g->depth);
+    memset(g, 0, sizeof(*g));
+    return 0;
+  }
+  int **arrays[5] = {&g->parent, &g->child, &g->next, &g->prev,
+                     &g->freeList};
+  for (int k = 0; k < 5; k++) *arrays[k] = links + (size_t)k * capacity;
+  g->flags = g->depth + capacity;
+  g->capacity = capacity;
+  clearSceneGraph(g);
+  return 1;
+}
+
+/*
+ *  Release a graph's arrays
+ *  @param g scene graph
+ */
+void freeSceneGraph(SceneGraph *g) {
+  free(g->local);
+  free(g->world);
+  free(g->parent); // Start of the shared link block
+  free(g->depth);  // Also holds flags
+  memset(g, 0, sizeof(*g));
+}
+
+/*
+ *  Remove every node
+ *  @param g scene graph
+ */
+void clearSceneGraph(SceneGraph *g) {
+  memset(g->flags, 0, g->capacity);
+  g->dirtyCount = 0;
+  g->maxDepth = 0;
+  // Push slots in reverse so the lowest indices are handed out first,
+  // which keeps the update range [0, high) tight
+  g->freeCount = 0;
+  for (int i = g->capacity - 1; i >= 0; i--)
+    g->freeList[g->freeCount++] = i;
+  g->live = 0;
+  g->high = 0;
+}
+
+/*
+ *  Flag a node for the next update
+ */
+static void markDirty(SceneGraph *g, int node) {
+  if (g->flags[node] & SCENE_DIRTY) return;
+  g->flags[node] |= SCENE_DIRTY;
+  g->dirtyCount++;
+}
+
+/*
+ *  Add a node
+ *  @return node index, or SCENE_NONE if the graph is full
+ */
+int addSceneNode(SceneGraph *g, int parent, const float *local) {
+  if (g->freeCount == 0) return SCENE_NONE;
+  const int depth = parent == SCENE_NONE ? 0 : g->depth[parent] + 1;
+  if (depth > 255) return SCENE_NONE;
+  int i = g->freeList[--g->freeCount];
+
+  memcpy(g->local[i], local ? local : identity, sizeof(SceneTransform));
+  g->parent[i] = parent;
+  g->child[i] = SCENE_NONE;
+  g->prev[i] = SCENE_NONE;
+  g->next[i] = SCENE_NONE;
+  if (parent != SCENE_NONE) {
+    // Push onto the front of the parent's child list
+    g->next[i] = g->child[parent];
+    if (g->child[parent] != SCENE_NONE) g->prev[g->child[parent]] = i;
+    g->child[parent] = i;
+  }
+  g->depth[i] = depth;
+  if (depth > g->maxDepth) g->maxDepth = depth;
+  g->flags[i] = SCENE_USED;
+  markDirty(g, i);
+
+  g->live++;
+  if (i >= g->high) g->high = i + 1;
+  return i;
+}
+
+/*
+ *  Remove a node and everything attached to it
+ *  @param g scene graph
+ *  @param node node index
+ */
+void removeSceneNode(SceneGraph *g, int node) {
+  if (node < 0 || !(g->flags[node] & SCENE_USED)) return;
+  while (g->child[node] != SCENE_NONE) removeSceneNode(g, g->child[node]);
+
+  // Unlink from the parent's child list
+  const int p = g->parent[node];
+  if (g->prev[node] != SCENE_NONE)
+    g->next[g->prev[node]] = g->next[node];
+  else if (p != SCENE_NONE)
+    g->child[p] = g->next[node];
+  if (g->next[node] != SCENE_NONE) g->prev[g->next[node]] = g->prev[node];
+
+  if (g->flags[node] & SCENE_DIRTY) g->dirtyCount--;
+  g->flags[node] = 0;
+  g->freeList[g->freeCount++] = node;
+  g->live--;
+  // Shrink the update range past trailing free slots
+  while (g->high > 0 && !g->flags[g->high - 1]) g->high--;
+}
+
+/*
+ *  Set a node's transform relative to its parent
+ *  The node is only marked dirty if the transform changed.
+ */
+void setSceneNodeLocal(SceneGraph *g, int node, const float *local) {
+  if (!memcmp(g->local[node], local, sizeof(SceneTransform))) return;
+  memcpy(g->local[node], local, sizeof(SceneTransform));
+  markDirty(g, node);
+}
+
+/*
+ *  W = P * L (parent world, local)
+ *  Origin: parent origin plus the local origin in parent axes; axes: the
+ *  local axes in parent axes.
+ */
+static void composeTransform(const float *restrict P, const float *restrict L,
+                             float *restrict W) {
+  for (int a = 0; a < 3; a++) {
+    const float x = P[3 + a], y = P[6 + a], z = P[9 + a];
+    W[a] = P[a] + L[0] * x + L[1] * y + L[2] * z;
+    W[3 + a] = L[3] * x + L[4] * y + L[5] * z;
+    W[6 + a] = L[6] * x + L[7] * y + L[8] * z;
+    W[9 + a] = L[9] * x + L[10] * y + L[11] * z;
+  }
+}
+
+/*
+ *  Recompute world transforms below every dirty node
+ *  @param g scene graph
+ */
+void updateSceneGraph(SceneGraph *g) {
+  g->updated = 0;
+  if (!g->dirtyCount) return; // Nothing moved: every world is current
+
+  unsigned char *flags = g->flags;
+  const unsigned char *depth = g->depth;
+  const int *parent = g->parent;
+  for (int d = 0; d <= g->maxDepth; d++) {
+    for (int i = 0; i < g->high; i++) {
+      if (depth[i] != d || !(flags[i] & SCENE_USED)) continue;
+      const int p = parent[i];
+      if (p != SCENE_NONE) flags[i] |= flags[p] & SCENE_DIRTY;
+      if (!(flags[i] & SCENE_DIRTY)) continue;
+      composeTransform(p != SCENE_NONE ? g->world[p] : identity, g->local[i],
+                       g->world[i]);
+      g->updated++;
+    }
+  }
+  for (int i = 0; i < g->high; i++) flags[i] &= ~SCENE_DIRTY;
+  g->dirtyCount = 0;
+}
@@ -0,0 +1,94 @@
+/*
+ *  Scene graph module - header file
+ *  Nodes hold a transform relative to their parent and a cached world
+ *  transform. Moving a node marks it dirty, and world transforms are only
+ *  recomputed for dirty nodes and their descendants, so objects attached
+ *  to something that didn't move cost nothing per frame.
+ */
+#ifndef SCENE_H
+#define SCENE_H
+
+#define SCENE_NONE -1 // No node (parent of a root node, unattached object)
+#define SCENE_USED 1  // Slot holds a node
+#define SCENE_DIRTY 2 // Local transform changed since the last update
+
+/*
+ *  Transforms are rigid 3x4 matrices of 12 floats: the origin, then the
+ *  X, Y and Z axes (the matrix columns)
+ */
+typedef float SceneTransform[12];
+
+/*
+ *  Node storage: parallel arrays indexed by node, with children kept in
+ *  doubly linked sibling lists and free slots recycled through a stack
+ */
+typedef struct {
+  int capacity;            // Number of slots
+  int live;                // Nodes in use
+  int high;                // One past the highest slot in use
+  SceneTransform *local;   // Transform relative to the parent
+  SceneTransform *world;   // Cached world transform
+  int *parent;             // Parent node (SCENE_NONE for roots)
+  int *child;              // First child
+  int *next, *prev;        // Siblings
+  unsigned char *depth;    // Distance from the root
+  unsigned char *flags;    // SCENE_USED | SCENE_DIRTY
+  int maxDepth;            // Deepest level in use
+  int dirtyCount;          // Nodes marked dirty since the last update
+  int *freeList;           // Stack of free slots
+  int freeCount;           // Entries on the free stack
+  int updated;             // World transforms recomputed by the last update
+} SceneGraph;
+
+/*
+ *  Allocate an empty scene graph
+ *  @param g graph to initialize
+ *  @param capacity maximum number of nodes
+ *  @return 1 on success, 0 if allocation failed
+ */
+int initSceneGraph(SceneGraph *g, int capacity);
+
+/*
+ *  Release a graph's arrays
+ *  @param g scene graph
+ */
+void freeSceneGraph(SceneGraph *g);
+
+/*
+ *  Remove every node
+ *  @param g scene graph
+ */
+void clearSceneGraph(SceneGraph *g);
+
+/*
+ *  Add a node
+ *  @param g scene graph
+ *  @param parent parent node, or SCENE_NONE for a root
+ *  @param local transform relative to the parent (NULL for identity)
+ *  @return node index, or SCENE_NONE if the graph is full
+ */
+int addSceneNode(SceneGraph *g, int parent, const float *local);
+
+/*
+ *  Remove a node and everything attached to it
+ *  @param g scene graph
+ *  @param node node index
+ */
+void removeSceneNode(SceneGraph *g, int node);
+
+/*
+ *  Set a node's transform relative to its parent
+ *  The node is only marked dirty if the transform changed.
+ *  @param g scene graph
+ *  @param node node index
+ *  @param local new transform
+ */
+void setSceneNodeLocal(SceneGraph *g, int node, const float *local);
+
+/*
+ *  Recompute world transforms below every dirty node
+ *  @param g scene graph
+ */
+void updateSceneGraph(SceneGraph *g);
+
+#endif
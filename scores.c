@@ -0,0 +1,277 @@
+/*
+ *  Score persistence module - implementation file
+ *  Finished rounds go through a ring of SCORE_QUEUE entries with a head
+ *  written only by the game thread and a tail written only by the writer,
+ *  so neither side ever waits on the other (a full ring drops the round).
+ *  High scores can change on every hit, so they don't queue: the latest one
+ *  sits in a single atomic slot that each post overwrites. The writer wakes
+ *  every SCORE_NAP seconds, folds the slot and every queued round into its
+ *  copy of the leaderboard and saves at most once per SCORE_INTERVAL.
+ *
+ *  File layout (little-endian, 228 bytes with a full board):
+ *    "ASCR" u16 version u16 count
+ *    u32 best, rounds, fired, hits
+ *    count x (u32 score, u16 fired, u16 hits, u32 ticks, i64 time)
+ *    u32 FNV-1a hash of everything before it
+ */
+#include "scores.h"
+#include "utils.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define SCORE_VERSION 1
+#define SCORE_QUEUE 64      // Queued rounds (power of two)
+#define SCORE_NAP 0.02      // Writer sleep between queue checks (seconds)
+#define SCORE_INTERVAL 1.0  // Shortest time between two saves (seconds)
+#define SCORE_HEADER 24     // Bytes before the entries
+#define SCORE_ENTRY 20      // Bytes per entry
+#define SCORE_BYTES (SCORE_HEADER + SCORE_TOP * SCORE_ENTRY + 4)
+
+static ScoreEntry queue[SCORE_QUEUE]; // Finished rounds
+static atomic_uint queueHead;     // Next slot to fill (game thread)
+static atomic_uint queueTail;     // Next slot to read (writer)
+static atomic_int latestBest;     // Newest high score posted
+static atomic_int stopping;       // Set to make the writer finish
+static int running = 0;           // Writer thread started
+static pthread_t writer;
+static char path[512];            // Leaderboard file
+static Leaderboard saved;         // Writer's copy of the leaderboard
+
+/*
+ *  Pack a leaderboard into the file layout
+ *  @return bytes used
+ */
+static int packBoard(const Leaderboard *b, unsigned char *buf) {
+  unsigned char *p = buf;
+  memcpy(p, "ASCR", 4);
+  p = PutLE(p + 4, SCORE_VERSION, 2);
+  p = PutLE(p, b->count, 2);
+  p = PutLE(p, b->best, 4);
+  p = PutLE(p, b->rounds, 4);
+  p = PutLE(p, b->fired, 4);
+  p = PutLE(p, b->hits, 4);
+  for (int k = 0; k < b->count; k++) {
+    const ScoreEntry *e = &b->top[k];
+    p = PutLE(p, e->score, 4);
+    p = PutLE(p, e->fired, 2);
+    p = PutLE(p, e->hits, 2);
+    p = PutLE(p, e->ticks, 4);
+    p = PutLE(p, (unsigned long long)e->time, 8);
+  }
+  p = PutLE(p, HashBytes(2166136261u, buf, (int)(p - buf)), 4);
+  return (int)(p - buf);
+}
+
+/*
+ *  Unpack the file layout
+ *  @return 1 if the data is a complete, intact leaderboard
+ */
+static int unpackBoard(const unsigned char *buf, int n, Leaderboard *b) {
+  unsigned long long v, count;
+  if (n < SCORE_HEADER + 4 || memcmp(buf, "ASCR", 4)) return 0;
+  const unsigned char *p = GetLE(buf + 4, &v, 2);
+  if (v != SCORE_VERSION) return 0;
+  p = GetLE(p, &count, 2);
+  if (count > SCORE_TOP || n != SCORE_HEADER + (int)count * SCORE_ENTRY + 4)
+    return 0;
+  GetLE(buf + n - 4, &v, 4);
+  if (v != HashBytes(2166136261u, buf, n - 4)) return 0;
+
+  memset(b, 0, sizeof(*b));
+  b->count = (int)count;
+  p = GetLE(p, &v, 4), b->best = (int)v;
+  p = GetLE(p, &v, 4), b->rounds = (int)v;
+  p = GetLE(p, &v, 4), b->fired = (int)v;
+  p = GetLE(p, &v, 4), b->hits = (int)v;
+  for (int k = 0; k < b->count; k++) {
+    ScoreEntry *e = &b->top[k];
+    p = GetLE(p, &v, 4), e->score = (int)v;
+    p = GetLE(p, &v, 2), e->fired = (int)v;
+    p = GetLE(p, &v, 2), e->hits = (int)v;
+    p = GetLE(p, &v, 4), e->ticks = (int)v;
+    p = GetLE(p, &v, 8), e->time = (long long)v;
+  }
+  return 1;
+}
+
+/*
+ *  Read the leaderboard (startup only: this is the one synchronous read)
+ *  Falls back to the legacy high score file if there is no valid board.
+ *  @return 1 if the file was read, 0 if the board was started fresh
+ */
+int loadLeaderboard(const char *file, Leaderboard *board) {
+  // The file, then a finished temporary file in case a save was cut off
+  // between writing it and renaming it
+  char name[sizeof(path) + 4];
+  for (int k = 0; k < 2; k++) {
+    snprintf(name, sizeof(name), k ? "%s.tmp" : "%s", file);
+    unsigned char buf[SCORE_BYTES + 1];
+    FILE *f = fopen(name, "rb");
+    if (!f) continue;
+    const int n = (int)fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    if (unpackBoard(buf, n, board)) return 1;
+    if (!k) fprintf(stderr, "Ignoring damaged score file %s\n", name);
+  }
+
+  memset(board, 0, sizeof(*board));
+  FILE *f = fopen(SCORE_LEGACY, "r");
+  if (f) {
+    if (fscanf(f, "%d", &board->best) != 1 || board->best < 0) board->best = 0;
+    fclose(f);
+  }
+  return 0;
+}
+
+/*
+ *  Add a finished round to a leaderboard (no I/O)
+ *  Ties keep the earlier round first; rounds scoring nothing only count
+ *  toward the totals.
+ */
+void recordRound(Leaderboard *board, const ScoreEntry *round) {
+  board->rounds++;
+  board->fired += round->fired;
+  board->hits += round->hits;
+  if (round->score > board->best) board->best = round->score;
+  if (round->score <= 0) return;
+
+  int k = board->count;
+  while (k > 0 && board->top[k - 1].score < round->score) k--;
+  if (k >= SCORE_TOP) return;
+  const int n = board->count < SCORE_TOP ? board->count : SCORE_TOP - 1;
+  memmove(&board->top[k + 1], &board->top[k], (n - k) * sizeof(ScoreEntry));
+  board->top[k] = *round;
+  if (board->count < SCORE_TOP) board->count++;
+}
+
+/*
+ *  Replace the leaderboard file: write a temporary file, flush it to disk,
+ *  then rename it over the old one, so a crash leaves either the old file
+ *  or the new one and never a partial write
+ *  @return 1 on success
+ */
+static int writeBoard(const Leaderboard *b) {
+  unsigned char buf[SCORE_BYTES];
+  const int n = packBoard(b, buf);
+  char tmp[sizeof(path) + 4];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+  FILE *f = fopen(tmp, "wb");
+  if (!f) return 0;
+  int ok = fwrite(buf, 1, n, f) == (size_t)n && fflush(f) == 0;
+#ifdef _WIN32
+  ok = ok && _commit(_fileno(f)) == 0;
+#else
+  ok = ok && fsync(fileno(f)) == 0;
+#endif
+  ok = fclose(f) == 0 && ok;
+#ifdef _WIN32
+  // Windows rename won't replace an existing file (if this is cut off
+  // before the rename, the next load reads the temporary file)
+  if (ok) remove(path);
+#endif
+  if (ok && rename(tmp, path) == 0) return 1;
+  remove(tmp);
+  return 0;
+}
+
+/*
+ *  Take the next round off the queue (writer side)
+ *  @return 1 if a round was taken
+ */
+static int popRound(ScoreEntry *round) {
+  const unsigned int tail = atomic_load_explicit(&queueTail, memory_order_relaxed);
+  if (tail == atomic_load_explicit(&queueHead, memory_order_acquire)) return 0;
+  *round = queue[tail & (SCORE_QUEUE - 1)];
+  atomic_store_explicit(&queueTail, tail + 1, memory_order_release);
+  return 1;
+}
+
+/*
+ *  Queue a finished round (no-op if the writer isn't running)
+ *  A full queue drops the round rather than wait.
+ */
+void postRound(const ScoreEntry *round) {
+  if (!running) return;
+  const unsigned int head = atomic_load_explicit(&queueHead, memory_order_relaxed);
+  if (head - atomic_load_explicit(&queueTail, memory_order_acquire) >= SCORE_QUEUE)
+    return;
+  queue[head & (SCORE_QUEUE - 1)] = *round;
+  atomic_store_explicit(&queueHead, head + 1, memory_order_release);
+}
+
+/*
+ *  Writer thread: fold new scores into the leaderboard and save it
+ *  when it changed, at most once per SCORE_INTERVAL (always before exiting)
+ */
+static void *scoreWriter(void *arg) {
+  (void)arg;
+  const struct timespec nap = {0, (long)(SCORE_NAP * 1e9)};
+  double lastSave = -SCORE_INTERVAL;
+  int dirty = 0, warned = 0;
+  for (;;) {
+    const int stop = atomic_load(&stopping);
+    const int best = atomic_load(&latestBest);
+    if (best > saved.best) {
+      saved.best = best;
+      dirty = 1;
+    }
+    ScoreEntry round;
+    while (popRound(&round)) {
+      recordRound(&saved, &round);
+      dirty = 1;
+    }
+    const double now = TimeNow();
+    if (dirty && (stop || now - lastSave >= SCORE_INTERVAL)) {
+      if (writeBoard(&saved)) {
+        dirty = 0;
+      } else if (!warned) {
+        fprintf(stderr, "Cannot save scores to %s\n", path);
+        warned = 1;
+      }
+      lastSave = now;
+    }
+    if (stop) break;
+    nanosleep(&nap, NULL);
+  }
+  return NULL;
+}
+
+/*
+ *  Start the background writer
+ *  @return 1 if the writer is running, 0 if the thread couldn't start
+ */
+int startScoreWriter(const char *file, const Leaderboard *board) {
+  if (running) return 1;
+  snprintf(path, sizeof(path), "%s", file);
+  saved = *board;
+  atomic_store(&queueHead, 0);
+  atomic_store(&queueTail, 0);
+  atomic_store(&stopping, 0);
+  atomic_store(&latestBest, board->best);
+  running = pthread_create(&writer, NULL, scoreWriter, NULL) == 0;
+  return running;
+}
+
+/*
+ *  Post a new high score (no-op if the writer isn't running)
+ */
+void postHighScore(int score) {
+  if (running) atomic_store(&latestBest, score);
+}
+
+/*
+ *  Write anything still queued and stop the writer
+ */
+void stopScoreWriter(void) {
+  if (!running) return;
+  atomic_store(&stopping, 1);
+  pthread_join(writer, NULL);
+  running = 0;
+}
@@ -0,0 +1,80 @@
+/*
+ *  Score persistence module - header file
+ *  High score, top-N leaderboard and lifetime stats, saved in a small
+ *  binary file by a background writer. The game posts updates into a
+ *  lock-free single-producer queue and never touches the filesystem
+ *  after startup; the writer merges whatever has queued up and replaces
+ *  the file atomically (temporary file, then rename).
+ */
+#ifndef SCORES_H
+#define SCORES_H
+
+#define SCORE_FILE "scores.dat"      // Leaderboard file
+#define SCORE_LEGACY "highscore.txt" // Old plain-text high score (read once)
+#define SCORE_TOP 10                 // Rounds kept on the leaderboard
+
+/*
+ *  One finished round
+ */
+typedef struct {
+  int score;      // Final score
+  int fired;      // Arrows shot
+  int hits;       // Arrows that hit a target
+  int ticks;      // Length of the round (simulation ticks)
+  long long time; // When it ended (seconds since the epoch)
+} ScoreEntry;
+
+/*
+ *  Everything the score file holds
+ */
+typedef struct {
+  int best;                   // High score (may come from an unfinished round)
+  int rounds;                 // Rounds finished
+  int fired, hits;            // Arrows shot and hits over all rounds
+  int count;                  // Entries in top
+  ScoreEntry top[SCORE_TOP];  // Best rounds, highest score first
+} Leaderboard;
+
+/*
+ *  Read the leaderboard (startup only: this is the one synchronous read)
+ *  Falls back to the legacy high score file if there is no valid board.
+ *  @param file leaderboard file
+ *  @param board leaderboard to fill (empty if nothing could be read)
+ *  @return 1 if the file was read, 0 if the board was started fresh
+ */
+int loadLeaderboard(const char *file, Leaderboard *board);
+
+/*
+ *  Add a finished round to a leaderboard (no I/O)
+ *  @param board leaderboard
+ *  @param round finished round
+ */
+void recordRound(Leaderboard *board, const ScoreEntry *round);
+
+/*
+ *  Start the background writer
+ *  @param file leaderboard file
+ *  @param board leaderboard as loaded (the writer keeps its own copy)
+ *  @return 1 if the writer is running, 0 if the thread couldn't start
+ */
+int startScoreWriter(const char *file, const Leaderboard *board);
+
+/*
+ *  Post a new high score (no-op if the writer isn't running)
+ *  Only the latest one is kept until the writer picks it up.
+ *  @param score high score
+ */
+void postHighScore(int score);
+
+/*
+ *  Queue a finished round (no-op if the writer isn't running)
+ *  @param round finished round
+ */
+void postRound(const ScoreEntry *round);
+
+/*
+ *  Write anything still queued and stop the writer
+ */
+void stopScoreWriter(void);
+
+#endif
@@ -0,0 +1,357 @@
+/*
+ *  Shadow module - implementation file
+ *  The light is treated as directional (from the scene center toward the
+ *  GL_LIGHT0 position), so each cascade is an orthographic box along the
+ *  light. The two near cascades follow the camera: their centers sit ahead
+ *  of it on a coarse grid (and on the texel grid across the light), so they
+ *  only move, and need a re-render, after the camera has walked a fair way.
+ *  The far cascade covers the whole island and never moves.
+ *
+ *  A cascade keeps the light direction and box it was drawn with, and the
+ *  receivers use exactly that box, so a cascade that is waiting its turn to
+ *  be refreshed still casts consistent (slightly old) shadows.
+ */
+#include "shadow.h"
+#include "utils.h"
+
+#define SHADOW_DEPTH 150.0 // Box half-depth along the light (covers the
+                           // mountain ring's shadows on the island)
+#define SHADOW_MARGIN 0.02 // Receivers this close to a map's edge use the
+                           // next cascade
+#define SHADOW_OFFSET_FACTOR 2.0 // Slope-scaled depth bias of the casters
+#define SHADOW_OFFSET_UNITS 64.0 // Constant depth bias of the casters
+
+#define SHADOW_AHEAD 0.6   // Near cascades are centered this far ahead of
+                           // the camera (fraction of their half-size)
+
+//  Box half-size across the light (world units); the last cascade is fixed
+//  at the center and covers the island
+static const double cascadeRadius[SHADOW_CASCADES] = {10.0, 30.0, 80.0};
+
+/*
+ *  One cascade: the cached static map, the live map (static + moving
+ *  casters) and the light box both were drawn with
+ */
+typedef struct {
+  unsigned int staticTex, staticFbo; // Cached static depth
+  unsigned int liveTex, liveFbo;     // Static depth + moving casters
+  double light[3];                   // Light direction of the cached map
+  double center[3];                  // Box center of the cached map
+  double view[16], proj[16];         // Light view and projection
+  float texMatrix[16];               // World -> shadow map coordinates
+  int valid;                         // Cached map has been drawn
+  int drawnFrame;                    // Frame the cached map was drawn
+  double wantCenter[3];              // Box center for this frame's camera
+} ShadowCascade;
+
+static struct {
+  int ready;                          // Maps created
+  int frame;                          // updateShadows() calls
+  int active;                         // Light high enough this frame
+  int stale;                          // Cascade to re-render, or -1
+  int redraws;                        // Static re-renders so far
+  int prevFbo;                        // Framebuffer to restore after a pass
+  double light[3];                    // Light direction this frame
+  ShadowCascade c[SHADOW_CASCADES];
+} sm = {.stale = -1};
+
+/*
+ *  Create one depth map (hardware compare, linear filter = 2x2 PCF) and a
+ *  depth-only framebuffer around it
+ */
+#ifdef GL_VERSION_3_0
+static int createDepthTarget(unsigned int *tex, unsigned int *fbo) {
+  glGenTextures(1, tex);
+  glBindTexture(GL_TEXTURE_2D, *tex);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, SHADOW_SIZE, SHADOW_SIZE,
+               0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE,
+                  GL_COMPARE_REF_TO_TEXTURE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glGenFramebuffers(1, fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, *fbo);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
+                         *tex, 0);
+  glDrawBuffer(GL_NONE);
+  glReadBuffer(GL_NONE);
+  return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+#endif
+
+/*
+ *  Create the cascade depth maps and framebuffers
+ */
+int initShadows(void) {
+#ifdef GL_VERSION_3_0
+  if (!GLVersionAtLeast(3, 0)) return 0;
+  GLint prev;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev);
+  int ok = 1;
+  for (int i = 0; i < SHADOW_CASCADES; i++) {
+    ok = ok && createDepthTarget(&sm.c[i].staticTex, &sm.c[i].staticFbo);
+    ok = ok && createDepthTarget(&sm.c[i].liveTex, &sm.c[i].liveFbo);
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, prev);
+  ErrCheck("initShadows");
+  sm.ready = ok;
+  return ok;
+#else
+  return 0;
+#endif
+}
+
+/*
+ *  Light view and projection of a box, and the matrix the receivers use
+ *  The box center is moved onto the map's texel grid across the light so
+ *  that moving the box doesn't make shadow edges crawl.
+ */
+static void setCascadeMatrices(ShadowCascade *c, const double light[3],
+                               const double center[3], double radius) {
+  // Light basis: f along the light rays, s and u across them
+  const double f[3] = {-light[0], -light[1], -light[2]};
+  const double up[3] = {0, fabs(light[1]) > 0.99 ? 0 : 1,
+                        fabs(light[1]) > 0.99 ? 1 : 0};
+  double s[3] = {f[1] * up[2] - f[2] * up[1], f[2] * up[0] - f[0] * up[2],
+                 f[0] * up[1] - f[1] * up[0]};
+  const double sl = sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+  for (int k = 0; k < 3; k++) s[k] /= sl;
+  const double u[3] = {s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2],
+                       s[0] * f[1] - s[1] * f[0]};
+
+  // Snap the center's position across the light to whole texels
+  const double texel = 2.0 * radius / SHADOW_SIZE;
+  const double cs = s[0] * center[0] + s[1] * center[1] + s[2] * center[2];
+  const double cu = u[0] * center[0] + u[1] * center[1] + u[2] * center[2];
+  const double ds = floor(cs / texel + 0.5) * texel - cs;
+  const double du = floor(cu / texel + 0.5) * texel - cu;
+  double eye[3];
+  for (int k = 0; k < 3; k++)
+    eye[k] = center[k] + ds * s[k] + du * u[k] + SHADOW_DEPTH * light[k];
+
+  // View: rows s, u, -f (column-major, like gluLookAt)
+  double *V = c->view;
+  for (int k = 0; k < 3; k++) {
+    V[4 * k + 0] = s[k];
+    V[4 * k + 1] = u[k];
+    V[4 * k + 2] = -f[k];
+    V[4 * k + 3] = 0;
+  }
+  V[12] = -(s[0] * eye[0] + s[1] * eye[1] + s[2] * eye[2]);
+  V[13] = -(u[0] * eye[0] + u[1] * eye[1] + u[2] * eye[2]);
+  V[14] = f[0] * eye[0] + f[1] * eye[1] + f[2] * eye[2];
+  V[15] = 1;
+
+  // Projection: orthographic box, 2*radius across, 2*SHADOW_DEPTH deep
+  double *P = c->proj;
+  memset(P, 0, 16 * sizeof(double));
+  P[0] = P[5] = 1.0 / radius;
+  P[10] = -1.0 / SHADOW_DEPTH;
+  P[14] = -1.0;
+  P[15] = 1.0;
+
+  // Receivers: bias (clip -> 0..1) * projection * view
+  for (int col = 0; col < 4; col++) {
+    double m[4] = {0, 0, 0, 0};
+    for (int row = 0; row < 4; row++)
+      for (int k = 0; k < 4; k++) m[row] += P[4 * k + row] * V[4 * col + k];
+    for (int row = 0; row < 4; row++)
+      c->texMatrix[4 * col + row] = row < 3 ? 0.5 * (m[row] + m[3]) : m[3];
+  }
+}
+
+/*
+ *  Place the cascades around the view and pick the one to re-render
+ */
+int updateShadows(const float light[4]) {
+  sm.frame++;
+  sm.stale = -1;
+  const double len =
+      sqrt(light[0] * light[0] + light[1] * light[1] + light[2] * light[2]);
+  sm.active = sm.ready && len > 0 &&
+              light[1] / len > Sin(SHADOW_MIN_ELEVATION);
+  if (!sm.active) return 0;
+
+  // The shadows follow the light in SHADOW_ANGLE steps of azimuth and
+  // elevation: the cached maps stay valid between steps while the day
+  // cycle turns the light, and all cascades agree on the step they show
+  const double deg = 180.0 / M_PI;
+  const double az =
+      floor(atan2(light[2], light[0]) * deg / SHADOW_ANGLE + 0.5) *
+      SHADOW_ANGLE;
+  double el = floor(asin(light[1] / len) * deg / SHADOW_ANGLE + 0.5) *
+              SHADOW_ANGLE;
+  if (el < SHADOW_MIN_ELEVATION) el = SHADOW_MIN_ELEVATION;
+  sm.light[0] = Cos(el) * Cos(az);
+  sm.light[1] = Sin(el);
+  sm.light[2] = Cos(el) * Sin(az);
+
+  // Camera position and horizontal view direction from the modelview
+  double mv[16];
+  glGetDoublev(GL_MODELVIEW_MATRIX, mv);
+  double eye[3], ahead[3] = {-mv[2], 0, -mv[10]};
+  for (int k = 0; k < 3; k++)
+    eye[k] = -(mv[4 * k] * mv[12] + mv[4 * k + 1] * mv[13] +
+               mv[4 * k + 2] * mv[14]);
+  const double al = sqrt(ahead[0] * ahead[0] + ahead[2] * ahead[2]);
+  if (al > 1e-6) {
+    ahead[0] /= al;
+    ahead[2] /= al;
+  }
+
+  // A cascade is stale if it was never drawn, its center moved to another
+  // grid cell, or the light moved to another step. Only the one waiting
+  // longest (never drawn first) is re-rendered, so refreshes are spread
+  // over frames
+  for (int i = 0; i < SHADOW_CASCADES; i++) {
+    ShadowCascade *c = &sm.c[i];
+    c->wantCenter[0] = c->wantCenter[1] = c->wantCenter[2] = 0;
+    if (i < SHADOW_CASCADES - 1) {
+      const double r = cascadeRadius[i], grid = 0.25 * r;
+      c->wantCenter[0] =
+          floor((eye[0] + ahead[0] * SHADOW_AHEAD * r) / grid + 0.5) * grid;
+      c->wantCenter[2] =
+          floor((eye[2] + ahead[2] * SHADOW_AHEAD * r) / grid + 0.5) * grid;
+    }
+    if (c->valid && !memcmp(c->light, sm.light, sizeof(sm.light)) &&
+        c->wantCenter[0] == c->center[0] && c->wantCenter[2] == c->center[2])
+      continue;
+    const int wait = c->valid ? c->drawnFrame : -1;
+    if (sm.stale < 0 ||
+        wait < (sm.c[sm.stale].valid ? sm.c[sm.stale].drawnFrame : -1))
+      sm.stale = i;
+  }
+  return 1;
+}
+
+/*
+ *  Bind a cascade framebuffer with the light box as the camera and set up
+ *  depth-only rendering
+ */
+static void beginPass(const ShadowCascade *c, unsigned int fbo) {
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &sm.prevFbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glPushAttrib(GL_ENABLE_BIT | GL_VIEWPORT_BIT | GL_COLOR_BUFFER_BIT |
+               GL_DEPTH_BUFFER_BIT | GL_POLYGON_BIT | GL_CURRENT_BIT);
+  glViewport(0, 0, SHADOW_SIZE, SHADOW_SIZE);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  glDepthMask(GL_TRUE);
+  glEnable(GL_DEPTH_TEST);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_FOG);
+  glDisable(GL_BLEND);
+  glDisable(GL_TEXTURE_2D);
+  glDisable(GL_CULL_FACE); // The terrain is one-sided: keep both faces
+  glEnable(GL_POLYGON_OFFSET_FILL);
+  glPolygonOffset(SHADOW_OFFSET_FACTOR, SHADOW_OFFSET_UNITS);
+  glMatrixMode(GL_PROJECTION);
+  glPushMatrix();
+  glLoadMatrixd(c->proj);
+  glMatrixMode(GL_MODELVIEW);
+  glPushMatrix();
+  glLoadMatrixd(c->view);
+}
+
+/*
+ *  Start re-rendering the stale static cascade
+ */
+int beginStaticShadow(void) {
+#ifdef GL_VERSION_3_0
+  if (!sm.active || sm.stale < 0) return 0;
+  const int i = sm.stale;
+  ShadowCascade *c = &sm.c[i];
+  memcpy(c->light, sm.light, sizeof(c->light));
+  memcpy(c->center, c->wantCenter, sizeof(c->center));
+  setCascadeMatrices(c, c->light, c->center, cascadeRadius[i]);
+  c->valid = 1;
+  c->drawnFrame = sm.frame;
+  sm.redraws++;
+  beginPass(c, c->staticFbo);
+  glClear(GL_DEPTH_BUFFER_BIT);
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+/*
+ *  Copy a cascade's cached depth into its live map and bind the live map
+ */
+int beginDynamicShadow(int cascade) {
+#ifdef GL_VERSION_3_0
+  const ShadowCascade *c = &sm.c[cascade];
+  if (!sm.active || !c->valid) return 0;
+  GLint prev;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, c->staticFbo);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, c->liveFbo);
+  glBlitFramebuffer(0, 0, SHADOW_SIZE, SHADOW_SIZE, 0, 0, SHADOW_SIZE,
+                    SHADOW_SIZE, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+  glBindFramebuffer(GL_FRAMEBUFFER, prev);
+  beginPass(c, c->liveFbo);
+  return 1;
+#else
+  (void)cascade;
+  return 0;
+#endif
+}
+
+/*
+ *  Finish a shadow pass
+ */
+void endShadowPass(void) {
+#ifdef GL_VERSION_3_0
+  glMatrixMode(GL_PROJECTION);
+  glPopMatrix();
+  glMatrixMode(GL_MODELVIEW);
+  glPopMatrix();
+  glPopAttrib();
+  glBindFramebuffer(GL_FRAMEBUFFER, sm.prevFbo);
+#endif
+}
+
+/*
+ *  Bind the live maps and set the receiver uniforms
+ */
+void bindShadows(unsigned int shader, int enabled) {
+#ifdef GL_VERSION_3_0
+  // Samplers always point at the shadow units: a shadow sampler left on
+  // unit 0 would clash with the color texture there
+  static const char *samplers[SHADOW_CASCADES] = {"shadowMap0", "shadowMap1",
+                                                  "shadowMap2"};
+  for (int i = 0; i < SHADOW_CASCADES; i++)
+    glUniform1i(glGetUniformLocation(shader, samplers[i]), SHADOW_UNIT + i);
+
+  // Cascades that were never drawn come after the drawn ones in the
+  // shader's nearest-first search, so skip them by count
+  int count = 0;
+  if (enabled && sm.active)
+    while (count < SHADOW_CASCADES && sm.c[count].valid) count++;
+  glUniform1i(glGetUniformLocation(shader, "shadowCascades"), count);
+  if (!count) return;
+  float m[SHADOW_CASCADES][16];
+  for (int i = 0; i < count; i++) {
+    memcpy(m[i], sm.c[i].texMatrix, sizeof(m[i]));
+    glActiveTexture(GL_TEXTURE0 + SHADOW_UNIT + i);
+    glBindTexture(GL_TEXTURE_2D, sm.c[i].liveTex);
+  }
+  glActiveTexture(GL_TEXTURE0);
+  glUniformMatrix4fv(glGetUniformLocation(shader, "shadowMatrix"), count,
+                     GL_FALSE, m[0]);
+  glUniform1f(glGetUniformLocation(shader, "shadowMargin"), SHADOW_MARGIN);
+#else
+  (void)shader, (void)enabled;
+#endif
+}
+
+/*
+ *  Static cascade re-renders since startup
+ */
+int shadowRedraws(void) {
+  return sm.redraws;
+}
@@ -0,0 +1,72 @@
+/*
+ *  Shadow module - header file
+ *  Cascaded shadow maps for the light. Each cascade keeps a cached depth
+ *  map of the static scene (terrain, trees) that is only re-rendered when
+ *  the light has moved to its next step or the camera has left the area
+ *  it covers, and at most one cascade is re-rendered per frame. Every frame
+ *  the cached depth is copied into a live map and the moving objects
+ *  (targets, arrows) are drawn on top, so they cost a few small draws
+ *  instead of a full scene pass per cascade.
+ */
+#ifndef SHADOW_H
+#define SHADOW_H
+
+#define SHADOW_CASCADES 3 // Cascades, nearest first
+#define SHADOW_SIZE 1024  // Depth map width and height (texels)
+#define SHADOW_ANGLE 12.0 // Light direction step (degrees): shadows follow
+                          // the light in steps this size
+#define SHADOW_MIN_ELEVATION 3.0 // Lowest light elevation (degrees) that
+                                 // casts shadows
+#define SHADOW_UNIT 7     // First texture unit of the cascades
+
+/*
+ *  Create the cascade depth maps and framebuffers
+ *  @return 1 if shadow maps are available (OpenGL 3.0+), 0 otherwise
+ */
+int initShadows(void);
+
+/*
+ *  Once per frame, after the camera is set: place the cascades around the
+ *  view and pick the stale cascade (if any) to re-render this frame
+ *  @param light light position (as given to GL_LIGHT0, world space); it is
+ *               treated as a directional light from the scene center
+ *  @return 1 if the light is high enough to cast shadows this frame
+ */
+int updateShadows(const float light[4]);
+
+/*
+ *  Start re-rendering the stale static cascade picked by updateShadows()
+ *  The caller then draws the static casters and calls endShadowPass().
+ *  @return 1 if a static pass should be drawn this frame
+ */
+int beginStaticShadow(void);
+
+/*
+ *  Start the per-frame pass of a cascade: copies its cached static depth
+ *  into the live map and binds it for the moving casters
+ *  The caller then draws the dynamic casters and calls endShadowPass().
+ *  @param cascade cascade index (0 = nearest)
+ *  @return 1 if the cascade has a cached map to draw into
+ */
+int beginDynamicShadow(int cascade);
+
+/*
+ *  Finish a shadow pass and restore the framebuffer, viewport, matrices
+ *  and render state
+ */
+void endShadowPass(void);
+
+/*
+ *  Bind the live maps (units SHADOW_UNIT..) and set the receiver uniforms
+ *  (shadowMap0-2, shadowMatrix[], shadowCascades) of a bound program
+ *  @param shader receiver program (terrain or grass)
+ *  @param enabled 0 to draw without shadows
+ */
+void bindShadows(unsigned int shader, int enabled);
+
+/*
+ *  Static cascade re-renders since startup (for the HUD)
+ */
+int shadowRedraws(void);
+
+#endif
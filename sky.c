@@ -0,0 +1,233 @@
+/*
+ *  Sky module - implementation file
+ *  Single scattering in an Earth-like atmosphere (lengths in kilometers),
+ *  seen from just above the ground. The viewer sits at the pole of the
+ *  planet, so the heights along a view ray depend only on its elevation:
+ *  densities and the transmittance back to the eye are integrated once per
+ *  elevation and reused for every sun elevation and azimuth, leaving a
+ *  transmittance lookup toward the sun per sample.
+ *
+ *  Table coordinates (each 0-1, sampled at texel centers):
+ *    view elevation: elevation = coordinate^2 * 90 degrees (dense near
+ *                    the horizon, where the color changes fastest)
+ *    azimuth:        angle from the light = coordinate * 180 degrees
+ *    sun elevation:  linear from SKY_SUN_MIN to SKY_SUN_MAX
+ */
+#include "sky.h"
+#include "utils.h"
+
+#define PLANET_R 6360.0  // Ground radius
+#define TOP_R 6460.0     // Top of the atmosphere
+#define EYE_HEIGHT 0.2   // Viewer height above the ground
+#define RAYLEIGH_H 8.0   // Rayleigh scale height
+#define MIE_H 1.2        // Mie scale height
+#define MIE_SCATTER 3.996e-3 // Mie scattering (1/km)
+#define MIE_EXTINCT 4.440e-3 // Mie extinction (1/km)
+#define MIE_G 0.8        // Mie forward scattering
+#define SKY_STEPS 32     // Samples along a view ray
+#define T_STEPS 40       // Samples along a transmittance ray
+
+static const double rayleigh[3] = {5.802e-3, 13.558e-3, 33.1e-3}; // 1/km
+static const double ozone[3] = {0.650e-3, 1.881e-3, 0.085e-3};    // 1/km
+
+/*
+ *  Extinction per kilometer at a height
+ */
+static void extinction(double h, double out[3]) {
+  const double r = exp(-h / RAYLEIGH_H), m = exp(-h / MIE_H);
+  const double o = fmax(0.0, 1.0 - fabs(h - 25.0) / 15.0);
+  for (int c = 0; c < 3; c++)
+    out[c] = rayleigh[c] * r + MIE_EXTINCT * m + ozone[c] * o;
+}
+
+/*
+ *  Distance from radius r along zenith cosine mu to the top of the
+ *  atmosphere
+ */
+static double distanceToTop(double r, double mu) {
+  return -r * mu + sqrt(fmax(0.0, r * r * (mu * mu - 1.0) + TOP_R * TOP_R));
+}
+
+/*
+ *  Build the transmittance table
+ *  Rows are heights (height = row coordinate^2 * atmosphere depth), columns
+ *  zenith cosines from -1 to 1. Rays that hit the ground are black.
+ */
+static void buildTransmittance(SkyLuts *s) {
+  for (int j = 0; j < SKY_T_HEIGHT; j++) {
+    const double u = (double)j / (SKY_T_HEIGHT - 1);
+    const double r = PLANET_R + u * u * (TOP_R - PLANET_R);
+    for (int i = 0; i < SKY_T_MU; i++) {
+      const double mu = -1.0 + 2.0 * i / (SKY_T_MU - 1);
+      float *t = s->transmittance[j][i];
+      if (mu < 0 && r * r * (mu * mu - 1.0) + PLANET_R * PLANET_R >= 0) {
+        t[0] = t[1] = t[2] = 0;
+        continue;
+      }
+      const double d = distanceToTop(r, mu) / T_STEPS;
+      double depth[3] = {0, 0, 0}, e[3];
+      for (int k = 0; k < T_STEPS; k++) {
+        const double x = (k + 0.5) * d;
+        const double h = sqrt(r * r + 2.0 * r * mu * x + x * x) - PLANET_R;
+        extinction(h, e);
+        for (int c = 0; c < 3; c++) depth[c] += e[c] * d;
+      }
+      for (int c = 0; c < 3; c++) t[c] = exp(-depth[c]);
+    }
+  }
+}
+
+/*
+ *  Transmittance to the top of the atmosphere (bilinear lookup)
+ */
+static void transmittanceTo(const SkyLuts *s, double h, double mu,
+                            double out[3]) {
+  const double y = sqrt(fmin(fmax(h / (TOP_R - PLANET_R), 0.0), 1.0)) *
+                   (SKY_T_HEIGHT - 1);
+  const double x = fmin(fmax((mu + 1.0) * 0.5, 0.0), 1.0) * (SKY_T_MU - 1);
+  const int j = (int)fmin(y, SKY_T_HEIGHT - 2), i = (int)fmin(x, SKY_T_MU - 2);
+  const double fy = y - j, fx = x - i;
+  const float *a = s->transmittance[j][i], *b = s->transmittance[j][i + 1];
+  const float *c = s->transmittance[j + 1][i], *d = s->transmittance[j + 1][i + 1];
+  for (int k = 0; k < 3; k++)
+    out[k] = (a[k] + (b[k] - a[k]) * fx) * (1 - fy) +
+             (c[k] + (d[k] - c[k]) * fx) * fy;
+}
+
+/*
+ *  Rayleigh and Mie (Cornette-Shanks) phase functions
+ */
+static double phaseRayleigh(double c) {
+  return 3.0 / (16.0 * M_PI) * (1.0 + c * c);
+}
+
+static double phaseMie(double c) {
+  const double g2 = MIE_G * MIE_G;
+  const double k = 1.0 + g2 - 2.0 * MIE_G * c;
+  return 3.0 / (8.0 * M_PI) * (1.0 - g2) * (1.0 + c * c) /
+         ((2.0 + g2) * k * sqrt(k));
+}
+
+/*
+ *  Integrate the atmosphere into the tables
+ *  @param s tables to fill
+ */
+void buildSkyLuts(SkyLuts *s) {
+  buildTransmittance(s);
+  const double r0 = PLANET_R + EYE_HEIGHT;
+  for (int v = 0; v < SKY_ELEVATION; v++) {
+    const double u = (double)v / (SKY_ELEVATION - 1);
+    const double sinEl = Sin(u * u * 90.0), cosEl = Cos(u * u * 90.0);
+    const double tMax = distanceToTop(r0, sinEl);
+
+    // Samples along the ray (spaced quadratically, denser near the eye):
+    // height, position in the vertical plane of the ray, and the light each
+    // scatters back to the eye per unit of phase and sunlight
+    double q[SKY_STEPS], y[SKY_STEPS], r[SKY_STEPS], h[SKY_STEPS];
+    double wR[SKY_STEPS][3], wM[SKY_STEPS][3];
+    double view[3] = {1, 1, 1}, e[3];
+    for (int k = 0; k < SKY_STEPS; k++) {
+      const double t0 = tMax * k * k / (SKY_STEPS * SKY_STEPS);
+      const double t1 = tMax * (k + 1) * (k + 1) / (SKY_STEPS * SKY_STEPS);
+      const double t = 0.5 * (t0 + t1), dt = t1 - t0;
+      q[k] = t * cosEl;
+      y[k] = r0 + t * sinEl;
+      r[k] = sqrt(q[k] * q[k] + y[k] * y[k]);
+      h[k] = r[k] - PLANET_R;
+      extinction(h[k], e);
+      const double dR = exp(-h[k] / RAYLEIGH_H), dM = exp(-h[k] / MIE_H);
+      for (int c = 0; c < 3; c++) {
+        // Light scattered over the segment, attenuated inside it too
+        const double seg = view[c] * (1.0 - exp(-e[c] * dt)) / e[c];
+        wR[k][c] = rayleigh[c] * dR * seg;
+        wM[k][c] = MIE_SCATTER * dM * seg;
+        view[c] *= exp(-e[c] * dt);
+      }
+    }
+
+    for (int si = 0; si < SKY_SUNS; si++) {
+      const double el = SKY_SUN_MIN +
+                        (SKY_SUN_MAX - SKY_SUN_MIN) * si / (SKY_SUNS - 1);
+      const double sunX = Cos(el), sunY = Sin(el);
+      for (int a = 0; a < SKY_AZIMUTH; a++) {
+        const double cosAz = Cos(180.0 * a / (SKY_AZIMUTH - 1));
+        double sumR[3] = {0, 0, 0}, sumM[3] = {0, 0, 0}, sun[3];
+        for (int k = 0; k < SKY_STEPS; k++) {
+          transmittanceTo(s, h[k], (q[k] * cosAz * sunX + y[k] * sunY) / r[k],
+                          sun);
+          for (int c = 0; c < 3; c++) {
+            sumR[c] += sun[c] * wR[k][c];
+            sumM[c] += sun[c] * wM[k][c];
+          }
+        }
+        const double cosTh = cosEl * cosAz * sunX + sinEl * sunY;
+        const double pR = phaseRayleigh(cosTh), pM = phaseMie(cosTh);
+        float *out = s->view[si][v][a];
+        for (int c = 0; c < 3; c++) out[c] = pR * sumR[c] + pM * sumM[c];
+      }
+    }
+  }
+}
+
+/*
+ *  Blend the sky for a sun direction out of the tables
+ *  @param s tables
+ *  @param sun unit direction toward the sun (world, Y up)
+ *  @param view sky for this sun (output)
+ */
+void updateSkyView(const SkyLuts *s, const double sun[3], SkyView *view) {
+  const double el = asin(fmin(fmax(sun[1], -1.0), 1.0)) * 180.0 / M_PI;
+  const double len = sqrt(sun[0] * sun[0] + sun[2] * sun[2]);
+  view->sunX = len > 1e-6 ? sun[0] / len : 1.0f;
+  view->sunZ = len > 1e-6 ? sun[2] / len : 0.0f;
+
+  // Slices and blend weights: the sun, then the moon at the mirrored
+  // elevation
+  int slice[4];
+  float weight[4];
+  for (int i = 0; i < 2; i++) {
+    const double e = i ? -el : el;
+    const double x = fmin(fmax((e - SKY_SUN_MIN) / (SKY_SUN_MAX - SKY_SUN_MIN),
+                               0.0), 1.0) * (SKY_SUNS - 1);
+    const int k = (int)fmin(x, SKY_SUNS - 2);
+    const double scale = SKY_EXPOSURE * (i ? SKY_MOON : 1.0);
+    slice[2 * i] = k;
+    slice[2 * i + 1] = k + 1;
+    weight[2 * i] = scale * (k + 1 - x);
+    weight[2 * i + 1] = scale * (x - k);
+  }
+  const float *a = s->view[slice[0]][0][0], *b = s->view[slice[1]][0][0];
+  const float *c = s->view[slice[2]][0][0], *d = s->view[slice[3]][0][0];
+  float *out = view->texels[0][0];
+  for (int k = 0; k < SKY_ELEVATION * SKY_AZIMUTH * 3; k++)
+    out[k] = weight[0] * a[k] + weight[1] * b[k] + weight[2] * c[k] +
+             weight[3] * d[k];
+}
+
+/*
+ *  Sky color in a direction (the same lookup the sky shader does)
+ *  @param view sky from updateSkyView()
+ *  @param dir view direction (need not be unit length)
+ *  @param rgb display color (output)
+ */
+void skyColor(const SkyView *view, const double dir[3], float rgb[3]) {
+  const double len = sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+  const double horiz = sqrt(dir[0] * dir[0] + dir[2] * dir[2]);
+  const double el = asin(fmax(len > 0 ? dir[1] / len : 0.0, 0.0));
+  const double c = horiz > 1e-6
+                       ? (dir[0] * view->sunX + dir[2] * view->sunZ) / horiz
+                       : view->sunX;
+  // Bilinear lookup at table coordinates
+  const double x = acos(fmin(fmax(c, -1.0), 1.0)) / M_PI * (SKY_AZIMUTH - 1);
+  const double y = fmin(sqrt(el / (0.5 * M_PI)), 1.0) * (SKY_ELEVATION - 1);
+  const int i = (int)fmin(x, SKY_AZIMUTH - 2), j = (int)fmin(y, SKY_ELEVATION - 2);
+  const double fx = x - i, fy = y - j;
+  const float *p = view->texels[j][i], *q = view->texels[j + 1][i];
+  // Exponential tone mapping keeps the bright horizon from clipping, then
+  // display gamma
+  for (int k = 0; k < 3; k++) {
+    const double L = (p[k] + (p[k + 3] - p[k]) * fx) * (1 - fy) +
+                     (q[k] + (q[k + 3] - q[k]) * fx) * fy;
+    rgb[k] = pow(1.0 - exp(-L), 1.0 / SKY_GAMMA);
+  }
+}
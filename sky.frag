@@ -0,0 +1,32 @@
+#version 330 compatibility
+
+// Same lookup as skyColor() in sky.c
+uniform sampler2D skyView; // Sky radiance by (azimuth from the sun, elevation)
+uniform vec2 sunDir;       // Horizontal direction toward the sun (X, Z)
+uniform float gamma;       // Display gamma
+
+in vec3 ray; // World view ray
+
+const float PI = 3.14159265;
+
+// Texture coordinate of a table position (0-1 across the texel centers)
+float texel(float u, float n)
+{
+   return (clamp(u, 0.0, 1.0) * (n - 1.0) + 0.5) / n;
+}
+
+void main()
+{
+   vec3 d = normalize(ray);
+   vec2 size = vec2(textureSize(skyView, 0));
+   // Below the horizon shows the horizon
+   float el = asin(max(d.y, 0.0));
+   float len = length(d.xz);
+   float c = len > 1e-6 ? dot(d.xz, sunDir) / len : sunDir.x;
+   float az = acos(clamp(c, -1.0, 1.0)) / PI;
+   vec3 L = texture(skyView, vec2(texel(az, size.x),
+                                  texel(sqrt(el / (0.5 * PI)), size.y))).rgb;
+   // Exponential tone mapping keeps the bright horizon from clipping, then
+   // display gamma
+   gl_FragColor = vec4(pow(1.0 - exp(-L), vec3(1.0 / gamma)), 1.0);
+}
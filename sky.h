@@ -0,0 +1,74 @@
+/*
+ *  Sky module - header file
+ *  Physically based sky from precomputed lookup tables. At startup the
+ *  atmosphere (Rayleigh and Mie scattering, ozone absorption) is integrated
+ *  once into a transmittance table and a sky-view table: the sky seen from
+ *  the ground for every view direction, with one slice per sun elevation.
+ *  Each frame the slices for the sun and the moon (which lights the same
+ *  table, dimmer) are blended into one small sky-view table, and a sky
+ *  color is one bilinear lookup in it (one texture fetch per pixel in the
+ *  sky shader), so the scattering integral never runs per pixel or per
+ *  frame.
+ */
+#ifndef SKY_H
+#define SKY_H
+
+#define SKY_AZIMUTH 64   // Sky-view azimuths (0-180 degrees from the sun)
+#define SKY_ELEVATION 32 // Sky-view elevations (horizon to zenith)
+#define SKY_SUNS 48      // Sky-view slices (sun elevations)
+#define SKY_SUN_MIN -20.0 // Lowest sun elevation in the table (degrees)
+#define SKY_SUN_MAX 90.0  // Highest sun elevation in the table (degrees)
+#define SKY_T_MU 128     // Transmittance zenith angles
+#define SKY_T_HEIGHT 32  // Transmittance heights
+
+#define SKY_EXPOSURE 12.0 // Radiance to display scale (before tone mapping)
+#define SKY_MOON 0.02    // Moon brightness relative to the sun
+#define SKY_GAMMA 2.2    // Display gamma
+
+/*
+ *  Precomputed tables (radiance for a sun of unit irradiance)
+ */
+typedef struct {
+  // RGB transmittance from a height to the top of the atmosphere, by cosine
+  // of the zenith angle (columns) and height (rows)
+  float transmittance[SKY_T_HEIGHT][SKY_T_MU][3];
+  // RGB sky radiance by sun elevation, view elevation and azimuth from the
+  // sun (laid out as a 3D texture: azimuth varies fastest)
+  float view[SKY_SUNS][SKY_ELEVATION][SKY_AZIMUTH][3];
+} SkyLuts;
+
+/*
+ *  The sky for the current sun and moon: radiance (already scaled by the
+ *  exposure) by view elevation and azimuth from the sun
+ */
+typedef struct {
+  float texels[SKY_ELEVATION][SKY_AZIMUTH][3];
+  float sunX, sunZ; // Horizontal direction toward the sun (unit length)
+} SkyView;
+
+/*
+ *  Integrate the atmosphere into the tables
+ *  @param s tables to fill
+ */
+void buildSkyLuts(SkyLuts *s);
+
+/*
+ *  Blend the sky for a sun direction out of the tables
+ *  The moon is taken to sit opposite in elevation (below the horizon by
+ *  day, above it at night) at the same azimuth, so both share one table.
+ *  @param s tables
+ *  @param sun unit direction toward the sun (world, Y up)
+ *  @param view sky for this sun (output)
+ */
+void updateSkyView(const SkyLuts *s, const double sun[3], SkyView *view);
+
+/*
+ *  Sky color in a direction (the same lookup the sky shader does)
+ *  Directions below the horizon see the horizon.
+ *  @param view sky from updateSkyView()
+ *  @param dir view direction (need not be unit length)
+ *  @param rgb display color (output)
+ */
+void skyColor(const SkyView *view, const double dir[3], float rgb[3]);
+
+#endif
@@ -0,0 +1,12 @@
+#version 330 compatibility
+
+// Full-screen quad: clip-space corners with the world view ray of each
+// corner in the texture coordinate (rays interpolate exactly across the
+// screen of a perspective projection)
+out vec3 ray;
+
+void main()
+{
+   ray = gl_MultiTexCoord0.xyz;
+   gl_Position = gl_Vertex;
+}
@@ -0,0 +1,236 @@
+/*
+ *  Telemetry module - implementation file
+ *  The ring holds TELEMETRY_QUEUE events with a head written only by the
+ *  game thread and a tail written only by the writer, so neither waits on
+ *  the other; a full ring drops the event and counts it. The writer wakes
+ *  every TELEMETRY_NAP seconds, packs what has queued up and writes it with
+ *  one fwrite, so a crash loses at most the last nap's events.
+ *
+ *  File layout (little-endian):
+ *    "ATLM" u16 version u32 tick rate
+ *    then one record per event: u8 kind, u32 shot, u32 tick, and
+ *      shot: u8 flags, f32 charge, speed, th, ph, frame ms, x, y, z
+ *      hit:  u16 target, u8 ring, u16 score, f32 x, y, z
+ *      miss: f32 x, y, z
+ *  The converter links this file and utils.c (for the byte packing)
+ *  without the rest of the game.
+ */
+#include "telemetry.h"
+#include "utils.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_QUEUE 4096 // Queued events (power of two)
+#define TELEMETRY_NAP 0.05   // Writer sleep between flushes (seconds)
+#define TELEMETRY_RECORD 42  // Largest record (a shot) in bytes
+
+static TelemetryEvent queue[TELEMETRY_QUEUE];
+static atomic_uint queueHead;   // Next slot to fill (game thread)
+static atomic_uint queueTail;   // Next slot to read (writer)
+static atomic_int stopping;     // Set to make the writer finish
+static int running = 0;         // Writer thread started
+static pthread_t writer;
+static FILE *out = NULL;        // Telemetry file
+static unsigned int *slotShot = NULL; // Shot number of each pool slot
+static int slotCount = 0;
+static unsigned int nextShot = 0;     // Next shot number (game thread)
+static unsigned int dropped = 0;      // Events lost to a full ring
+static unsigned char packed[TELEMETRY_QUEUE * TELEMETRY_RECORD]; // Writer
+
+/*
+ *  Pack one event into its record
+ *  @return end of the record
+ */
+static unsigned char *packEvent(unsigned char *p, const TelemetryEvent *ev) {
+  p = PutLE(p, ev->kind, 1);
+  p = PutLE(p, ev->shot, 4);
+  p = PutLE(p, ev->tick, 4);
+  if (ev->kind == TELEMETRY_SHOT) {
+    p = PutLE(p, ev->flags, 1);
+    const float v[5] = {ev->charge, ev->speed, ev->th, ev->ph, ev->frameMs};
+    for (int k = 0; k < 5; k++) p = PutLEFloat(p, v[k]);
+  } else if (ev->kind == TELEMETRY_HIT) {
+    p = PutLE(p, ev->target, 2);
+    p = PutLE(p, ev->ring, 1);
+    p = PutLE(p, ev->score, 2);
+  }
+  p = PutLEFloat(p, ev->x);
+  p = PutLEFloat(p, ev->y);
+  return PutLEFloat(p, ev->z);
+}
+
+/*
+ *  Read a telemetry file header
+ *  @return 1 if the file is a telemetry file this version can read
+ */
+int readTelemetryHeader(FILE *f, int *tickRate) {
+  unsigned char b[10];
+  unsigned long long version, rate;
+  if (fread(b, 1, sizeof(b), f) != sizeof(b) || memcmp(b, "ATLM", 4))
+    return 0;
+  GetLE(GetLE(b + 4, &version, 2), &rate, 4);
+  if (version != TELEMETRY_VERSION || rate == 0) return 0;
+  *tickRate = (int)rate;
+  return 1;
+}
+
+/*
+ *  Read the next event
+ *  @return 1 if an event was read, 0 at the end (or a cut-off last record)
+ */
+int readTelemetryEvent(FILE *f, TelemetryEvent *ev) {
+  unsigned char b[TELEMETRY_RECORD];
+  unsigned long long kind, shot, tick, v;
+  memset(ev, 0, sizeof(*ev));
+  if (fread(b, 1, 9, f) != 9) return 0;
+  GetLE(GetLE(GetLE(b, &kind, 1), &shot, 4), &tick, 4);
+  ev->kind = (int)kind;
+  ev->shot = (unsigned int)shot;
+  ev->tick = (int)tick;
+  // The rest of the record: the fields of its kind, then the position
+  const int rest = kind == TELEMETRY_SHOT   ? 33
+                   : kind == TELEMETRY_HIT  ? 17
+                   : kind == TELEMETRY_MISS ? 12
+                                            : 0;
+  if (!rest) return 0; // Unknown record: the rest can't be framed
+  if (fread(b, 1, rest, f) != (size_t)rest) return 0;
+  const unsigned char *p = b;
+  if (kind == TELEMETRY_SHOT) {
+    p = GetLE(p, &v, 1), ev->flags = (int)v;
+    float *fields[5] = {&ev->charge, &ev->speed, &ev->th, &ev->ph,
+                        &ev->frameMs};
+    for (int k = 0; k < 5; k++) p = GetLEFloat(p, fields[k]);
+  } else if (kind == TELEMETRY_HIT) {
+    p = GetLE(p, &v, 2), ev->target = (int)v;
+    p = GetLE(p, &v, 1), ev->ring = (int)v;
+    p = GetLE(p, &v, 2), ev->score = (int)v;
+  }
+  p = GetLEFloat(p, &ev->x);
+  p = GetLEFloat(p, &ev->y);
+  GetLEFloat(p, &ev->z);
+  return 1;
+}
+
+/*
+ *  Put an event on the ring (game thread side)
+ */
+static void pushEvent(const TelemetryEvent *ev) {
+  const unsigned int head = atomic_load_explicit(&queueHead, memory_order_relaxed);
+  if (head - atomic_load_explicit(&queueTail, memory_order_acquire) >=
+      TELEMETRY_QUEUE) {
+    dropped++;
+    return;
+  }
+  queue[head & (TELEMETRY_QUEUE - 1)] = *ev;
+  atomic_store_explicit(&queueHead, head + 1, memory_order_release);
+}
+
+/*
+ *  Pack everything queued and write it in one call (writer side)
+ */
+static void flushEvents(void) {
+  const unsigned int head = atomic_load_explicit(&queueHead, memory_order_acquire);
+  unsigned int tail = atomic_load_explicit(&queueTail, memory_order_relaxed);
+  if (tail == head) return;
+  unsigned char *p = packed;
+  for (; tail != head; tail++)
+    p = packEvent(p, &queue[tail & (TELEMETRY_QUEUE - 1)]);
+  // Slots are free once packed, before the (slow) write
+  atomic_store_explicit(&queueTail, tail, memory_order_release);
+  fwrite(packed, 1, p - packed, out);
+  fflush(out);
+}
+
+/*
+ *  Writer thread: flush the ring every TELEMETRY_NAP seconds
+ */
+static void *telemetryWriter(void *arg) {
+  (void)arg;
+  const struct timespec nap = {0, (long)(TELEMETRY_NAP * 1e9)};
+  for (;;) {
+    const int stop = atomic_load(&stopping);
+    flushEvents();
+    if (stop) break;
+    nanosleep(&nap, NULL);
+  }
+  return NULL;
+}
+
+/*
+ *  Open the telemetry file and start the writer thread
+ *  @return 1 if telemetry is running, 0 on failure
+ */
+int startTelemetry(const char *file, int slots, int tickRate) {
+  if (running) return 1;
+  slotShot = malloc(slots * sizeof(unsigned int));
+  out = fopen(file, "wb");
+  if (!slotShot || !out) {
+    free(slotShot);
+    slotShot = NULL;
+    if (out) fclose(out);
+    out = NULL;
+    return 0;
+  }
+  unsigned char header[10];
+  memcpy(header, "ATLM", 4);
+  PutLE(PutLE(header + 4, TELEMETRY_VERSION, 2), tickRate, 4);
+  fwrite(header, 1, sizeof(header), out);
+
+  // Touch the ring and slot table now so logging never takes a first-use
+  // page fault
+  memset(queue, 0, sizeof(queue));
+  memset(slotShot, 0, slots * sizeof(unsigned int));
+  slotCount = slots;
+  nextShot = dropped = 0;
+  atomic_store(&queueHead, 0);
+  atomic_store(&queueTail, 0);
+  atomic_store(&stopping, 0);
+  running = pthread_create(&writer, NULL, telemetryWriter, NULL) == 0;
+  if (!running) {
+    fclose(out);
+    out = NULL;
+    free(slotShot);
+    slotShot = NULL;
+  }
+  return running;
+}
+
+/*
+ *  Log a released arrow
+ */
+void logTelemetryShot(int slot, const TelemetryEvent *ev) {
+  if (!running || slot < 0 || slot >= slotCount) return;
+  TelemetryEvent e = *ev;
+  e.kind = TELEMETRY_SHOT;
+  e.shot = slotShot[slot] = nextShot++;
+  pushEvent(&e);
+}
+
+/*
+ *  Log the end of an arrow's flight
+ */
+void logTelemetryEnd(int slot, TelemetryEvent *ev) {
+  if (!running || slot < 0 || slot >= slotCount) return;
+  ev->shot = slotShot[slot];
+  pushEvent(ev);
+}
+
+/*
+ *  Write everything still queued, close the file and stop the writer
+ */
+void stopTelemetry(void) {
+  if (!running) return;
+  atomic_store(&stopping, 1);
+  pthread_join(writer, NULL);
+  running = 0;
+  fclose(out);
+  out = NULL;
+  free(slotShot);
+  slotShot = NULL;
+  if (dropped)
+    fprintf(stderr, "Telemetry dropped %u events (ring full)\n", dropped);
+}
@@ -0,0 +1,86 @@
+/*
+ *  Telemetry module - header file
+ *  Per-shot analytics: every release, hit and miss is logged into a
+ *  preallocated lock-free ring and a background thread streams it to a
+ *  compact binary file (telemetry2csv turns that into a table). Logging
+ *  only fills a ring slot: no allocation, lock or system call, so it can
+ *  stay on during normal play.
+ */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdio.h>
+
+/*
+ *  Event kinds
+ */
+enum {
+  TELEMETRY_SHOT, // Arrow released
+  TELEMETRY_HIT,  // Arrow stuck in a target
+  TELEMETRY_MISS  // Arrow fell out of play
+};
+
+#define TELEMETRY_RAPID 1 // Shot flag: rapid-fire arrow (unscored)
+
+/*
+ *  One event (fields not listed for a kind are 0)
+ */
+typedef struct {
+  int kind;           // TELEMETRY_* event kind
+  unsigned int shot;  // Shot number (counts from 0 each session)
+  int tick;           // Simulation tick of the event
+  int flags;          // shot: TELEMETRY_RAPID
+  int target, ring;   // hit: target index and ring index (0 = bullseye)
+  int score;          // hit: points
+  float charge;       // shot: charge time (seconds)
+  float speed;        // shot: launch speed
+  float th, ph;       // shot: aim angles (degrees)
+  float frameMs;      // shot: frame time at release (milliseconds)
+  float x, y, z;      // shot: launch point; hit and miss: arrow position
+} TelemetryEvent;
+
+/*
+ *  Open the telemetry file and start the writer thread
+ *  @param file output file (overwritten)
+ *  @param slots arrow pool capacity (shots are tracked by pool slot)
+ *  @param tickRate simulation ticks per second (stored in the file)
+ *  @return 1 if telemetry is running, 0 on failure
+ */
+int startTelemetry(const char *file, int slots, int tickRate);
+
+/*
+ *  Log a released arrow
+ *  @param slot arrow pool slot the arrow went into
+ *  @param ev shot event (kind and shot number are filled in)
+ */
+void logTelemetryShot(int slot, const TelemetryEvent *ev);
+
+/*
+ *  Log the end of an arrow's flight
+ *  @param slot arrow pool slot
+ *  @param ev TELEMETRY_HIT or TELEMETRY_MISS event (shot number is filled in)
+ */
+void logTelemetryEnd(int slot, TelemetryEvent *ev);
+
+/*
+ *  Write everything still queued, close the file and stop the writer
+ */
+void stopTelemetry(void);
+
+/*
+ *  Read a telemetry file header
+ *  @param f file opened for binary reading
+ *  @param tickRate simulation ticks per second (output)
+ *  @return 1 if the file is a telemetry file this version can read
+ */
+int readTelemetryHeader(FILE *f, int *tickRate);
+
+/*
+ *  Read the next event
+ *  @param f telemetry file after its header
+ *  @param ev event (output)
+ *  @return 1 if an event was read, 0 at the end (or a cut-off last record)
+ */
+int readTelemetryEvent(FILE *f, TelemetryEvent *ev);
+
+#endif
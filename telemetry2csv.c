@@ -0,0 +1,90 @@
+/*
+ *  telemetry2csv - convert a telemetry file to CSV
+ *  One row per shot: when and how it was released, and how it ended (hit,
+ *  miss, or none if the session ended or the round was reset first).
+ *
+ *  Usage: telemetry2csv telemetry.bin > shots.csv
+ */
+#include "telemetry.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ *  A shot and the event that ended it
+ */
+typedef struct {
+  int known;          // Shot record seen
+  TelemetryEvent shot;
+  TelemetryEvent end; // kind -1 while the arrow hasn't landed
+} ShotRow;
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s TELEMETRY_FILE > shots.csv\n", argv[0]);
+    return 1;
+  }
+  FILE *f = fopen(argv[1], "rb");
+  if (!f) {
+    fprintf(stderr, "Cannot open %s\n", argv[1]);
+    return 1;
+  }
+  int tickRate;
+  if (!readTelemetryHeader(f, &tickRate)) {
+    fprintf(stderr, "%s is not a telemetry file\n", argv[1]);
+    fclose(f);
+    return 1;
+  }
+
+  // Gather shots by number (numbers are dense, so the array grows by index)
+  ShotRow *rows = NULL;
+  unsigned int count = 0, capacity = 0;
+  TelemetryEvent ev;
+  while (readTelemetryEvent(f, &ev)) {
+    if (ev.shot >= capacity) {
+      unsigned int grown = capacity ? capacity : 1024;
+      while (grown <= ev.shot) grown *= 2;
+      ShotRow *r = realloc(rows, grown * sizeof(ShotRow));
+      if (!r) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+      }
+      memset(r + capacity, 0, (grown - capacity) * sizeof(ShotRow));
+      rows = r;
+      capacity = grown;
+    }
+    ShotRow *row = &rows[ev.shot];
+    if (ev.kind == TELEMETRY_SHOT) {
+      row->known = 1;
+      row->shot = ev;
+      row->end.kind = -1;
+    } else if (row->known && row->end.kind < 0) {
+      row->end = ev;
+    }
+    if (ev.shot >= count) count = ev.shot + 1;
+  }
+  fclose(f);
+
+  printf("shot,time_s,rapid,charge_s,speed,theta,phi,x,y,z,frame_ms,"
+         "outcome,flight_s,target,ring,score,end_x,end_y,end_z\n");
+  for (unsigned int k = 0; k < count; k++) {
+    const ShotRow *row = &rows[k];
+    if (!row->known) continue; // Dropped when the ring was full
+    const TelemetryEvent *s = &row->shot, *e = &row->end;
+    printf("%u,%.4f,%d,%.4f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,", s->shot,
+           (double)s->tick / tickRate, s->flags & TELEMETRY_RAPID ? 1 : 0,
+           s->charge, s->speed, s->th, s->ph, s->x, s->y, s->z, s->frameMs);
+    if (e->kind < 0) {
+      printf("none,,,,,,,\n");
+      continue;
+    }
+    printf("%s,%.4f,", e->kind == TELEMETRY_HIT ? "hit" : "miss",
+           (double)(e->tick - s->tick) / tickRate);
+    if (e->kind == TELEMETRY_HIT)
+      printf("%d,%d,%d,", e->target, e->ring, e->score);
+    else
+      printf(",,,");
+    printf("%.3f,%.3f,%.3f\n", e->x, e->y, e->z);
+  }
+  free(rows);
+  return 0;
+}
@@ -0,0 +1,8 @@
+#version 400 compatibility
+
+// Depth-only terrain (shadow map casters): no color is written, the
+// rasterizer's depth is all the pass keeps
+
+void main()
+{
+}
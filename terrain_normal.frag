@@ -1,8 +1,21 @@
 #version 120
 
-uniform sampler2D colorTex;   // Diffuse/base color texture
-uniform sampler2D normalTex;  // Normal map texture (tangent-space normals)
-uniform int fogEnabled;       // Non-zero when fog should be applied
+uniform sampler2D groundColorTex;  // Forest ground color (unit 0)
+uniform sampler2D groundNormalTex; // Forest ground normal map (unit 1)
+uniform sampler2D rockColorTex;    // Mountain rock color (unit 3)
+uniform sampler2D rockNormalTex;   // Mountain rock normal map (unit 4)
+uniform sampler2D vtCache;         // Virtual texture page cache (unit 5)
+uniform sampler2D vtPageTable;     // Virtual texture page table (unit 6)
+uniform vec2 texScale;             // World XZ -> UV scale (ground, rock)
+uniform vec4 vtRegion;             // (x0, z0, 1/size, enabled) of the ring's virtual texture
+uniform vec4 vtParams;             // (pages at level 0, page payload, border, 1/cache size)
+uniform int fogEnabled;            // Non-zero when fog should be applied
+uniform sampler2DShadow shadowMap0; // Shadow cascades, nearest first (units 7-9)
+uniform sampler2DShadow shadowMap1;
+uniform sampler2DShadow shadowMap2;
+uniform mat4 shadowMatrix[3];      // World -> shadow map coordinates per cascade
+uniform int shadowCascades;        // Cascades in use (0 = no shadows)
+uniform float shadowMargin;        // Map border left to the next cascade
 
 // Inputs from the vertex shader (eye space)
 varying vec3 T; // Tangent vector
@@ -10,26 +23,82 @@ varying vec3 B; // Bitangent vector
 varying vec3 N; // Normal vector
 varying vec3 L; // Light vector
 varying vec3 V; // View vector
+varying vec2 W;  // World XZ
+varying float rockW; // Splat weight: 0 = forest ground, 1 = rock
+varying vec3 Pw;     // World position
 
-void main()
+// Unique rock color from the virtual texture
+vec4 virtualRock(vec2 w)
+{
+   vec2 uv = clamp((w - vtRegion.xy) * vtRegion.z, 0.0, 0.99999);
+   // Page table mip k holds page level k; the bias turns table texels into
+   // virtual texels so the hardware picks the level the feedback requested
+   vec3 e = floor(texture2D(vtPageTable, uv, log2(vtParams.y)).rgb * 255.0 + 0.5);
+   // e = (cache slot x, cache slot y, level of the resident page)
+   vec2 inPage = fract(uv * vtParams.x * exp2(-e.b));
+   vec2 texel = e.rg * (vtParams.y + 2.0 * vtParams.z) + vtParams.z + inPage * vtParams.y;
+   return texture2D(vtCache, texel * vtParams.w);
+}
+
+// Inside a cascade's map (away from its border)
+bool inCascade(vec3 s)
 {
-   // 1) Build TBN basis in eye space
-   vec3 Tn = normalize(T);
-   vec3 Bn = normalize(B);
-   vec3 Nn = normalize(N);
-   mat3 TBN = mat3(Tn, Bn, Nn); // Columns are tangent, bitangent, normal
+   return all(greaterThan(s, vec3(shadowMargin, shadowMargin, 0.0))) &&
+          all(lessThan(s, vec3(1.0 - shadowMargin, 1.0 - shadowMargin, 1.0)));
+}
+
+// Fraction of the light reaching this point from the nearest cascade that
+// covers it (one hardware-filtered 2x2 comparison)
+float sunlight()
+{
+   vec4 P = vec4(Pw, 1.0);
+   vec3 s;
+   if (shadowCascades > 0)
+   {
+      s = (shadowMatrix[0] * P).xyz;
+      if (inCascade(s)) return shadow2D(shadowMap0, s).r;
+   }
+   if (shadowCascades > 1)
+   {
+      s = (shadowMatrix[1] * P).xyz;
+      if (inCascade(s)) return shadow2D(shadowMap1, s).r;
+   }
+   if (shadowCascades > 2)
+   {
+      s = (shadowMatrix[2] * P).xyz;
+      if (inCascade(s)) return shadow2D(shadowMap2, s).r;
+   }
+   return 1.0;
+}
 
-   // 2) Sample and unpack normal from normal map
-   vec2 uv = gl_TexCoord[0].st;
-   vec3 nTex = texture2D(normalTex, uv).rgb * 2.0 - 1.0;
+void main()
+{
+   // 1) TBN basis in eye space from the interpolated frame
+   //    (unit per vertex; the perturbed normal is normalized once below)
+   mat3 TBN = mat3(T, B, N); // Columns are tangent, bitangent, normal
 
-   // Flip Y to match OpenGL texture convention
-   nTex.g = -nTex.g;
+   // 2) Blend ground and rock layers by the splat weight
+   //    Both UV sets are world-XZ aligned, so they share one tangent frame.
+   //    Layers with zero weight are skipped (most of the terrain is one layer)
+   vec4 base = vec4(0.0);
+   vec3 nTex = vec3(0.0);
+   if (rockW < 1.0)
+   {
+      vec2 uv = W * texScale.x;
+      float w = 1.0 - rockW;
+      base += w * texture2D(groundColorTex, uv);
+      nTex += w * (texture2D(groundNormalTex, uv).rgb * 2.0 - 1.0);
+   }
+   if (rockW > 0.0)
+   {
+      vec2 uv = W * texScale.y;
+      base += rockW * (vtRegion.w > 0.0 ? virtualRock(W) : texture2D(rockColorTex, uv));
+      nTex += rockW * (texture2D(rockNormalTex, uv).rgb * 2.0 - 1.0);
+   }
 
    // Boost bumpiness by scaling XY components
    float strength = 3.0;
-   nTex.xy *= strength;
-   nTex = normalize(nTex);
+   nTex.xy *= strength; // TBN is linear: one normalize below is enough
 
    // 3) Transform tangent-space normal into eye space
    vec3 Np = normalize(TBN * nTex);
@@ -41,6 +110,9 @@ void main()
    // Diffuse term: Lambertian dot product between light and normal
    float Id = max(dot(Ld, Np), 0.0);
 
+   // Shadow: points the light can't reach keep only the ambient term
+   float lit = Id > 0.0 ? sunlight() : 0.0;
+
    // Specular term: only when surface faces the light
    float Is = 0.0;
    if (Id > 0.0)
@@ -49,12 +121,10 @@ void main()
       Is = pow(max(dot(R, Vd), 0.0), gl_FrontMaterial.shininess);
    }
 
-   // 5) Sample base color and combine with lighting
-   vec4 base = texture2D(colorTex, uv);
-
+   // 5) Combine splatted base color with lighting
    vec4 ambient  = gl_FrontLightProduct[0].ambient  * base;
-   vec4 diffuse  = gl_FrontLightProduct[0].diffuse  * base * Id;
-   vec4 specular = gl_FrontLightProduct[0].specular * Is;
+   vec4 diffuse  = gl_FrontLightProduct[0].diffuse  * base * Id * lit;
+   vec4 specular = gl_FrontLightProduct[0].specular * Is * lit;
    vec4 color = ambient + diffuse + specular;
 
    // 6) Apply linear fog (if enabled)
@@ -1,22 +1,30 @@
 #version 120
 
+uniform vec4 splatParams; // (innerR, groundSize, baseY, unused)
+
+// Precomputed in ground.c: unit tangent along +U, w = bitangent sign
+attribute vec4 tangent;
+
 // Outputs to the fragment shader (eye space)
 varying vec3 T; // Tangent vector
 varying vec3 B; // Bitangent vector
 varying vec3 N; // Normal vector
 varying vec3 L; // Light vector   (from point to light)
 varying vec3 V; // View vector    (from point to eye)
+varying vec2 W;  // World XZ (texture coordinates for both layers)
+varying float rockW; // Splat weight: 0 = forest ground, 1 = rock
+varying vec3 Pw;     // World position (shadow map lookups)
 
 void main()
 {
-   // 1) Transform vertex position and normal to eye space
-   vec3 P  = vec3(gl_ModelViewMatrix * gl_Vertex);      // Position in eye space
-   vec3 N0 = normalize(gl_NormalMatrix * gl_Normal);    // Normal  in eye space
+   // 1) Transform vertex position, normal and tangent to eye space
+   //    (unit vectors in, rigid modelview: no renormalization needed)
+   vec3 P  = vec3(gl_ModelViewMatrix * gl_Vertex); // Position in eye space
+   vec3 N0 = gl_NormalMatrix * gl_Normal;          // Normal  in eye space
+   vec3 T0 = gl_NormalMatrix * tangent.xyz;        // Tangent in eye space
 
-   // 2) Construct tangent and bitangent for TBN basis
-   vec3 up = (abs(N0.y) < 0.999) ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
-   vec3 T0 = normalize(cross(up, N0)); // Tangent
-   vec3 B0 = cross(N0, T0);            // Bitangent (already perpendicular)
+   // 2) Bitangent from the stored handedness (points along +V)
+   vec3 B0 = tangent.w * cross(N0, T0);
 
    // 3) Build light and view vectors in eye space
    vec3 LightPos = vec3(gl_LightSource[0].position); // Light position (eye space)
@@ -30,11 +38,17 @@ void main()
    L = L0;
    V = V0;
 
-   // 5) Compute fog coordinate (distance from eye)
-   gl_FogFragCoord = length(P);
+   // 5) Splat weight from radius (overlap band), slope and height
+   //    (terrain is drawn with an identity model matrix, so gl_Vertex is world)
+   float radial = smoothstep(splatParams.x, splatParams.y, length(gl_Vertex.xz));
+   float slope  = smoothstep(0.8, 0.6, gl_Normal.y);
+   float height = smoothstep(2.0, 4.0, gl_Vertex.y - splatParams.z);
+   rockW = max(radial, max(slope, height));
+   W = gl_Vertex.xz;
+   Pw = gl_Vertex.xyz;
 
-   // 6) Pass through base texture coordinates
-   gl_TexCoord[0] = gl_MultiTexCoord0;
+   // 6) Compute fog coordinate (distance from eye)
+   gl_FogFragCoord = length(P);
 
    // 7) Compute final clip-space position
    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
@@ -0,0 +1,18 @@
+#version 400 compatibility
+
+// Coarse patch corners (world XZ) -> tessellation control stage
+// Heights are sampled here so the control stage can measure real edge lengths
+
+uniform sampler2D heightTex; // Baked terrain: xyz = normal, w = height
+uniform vec4 heightRegion;   // (x0, z0, 1/width, 1/depth) of the heightmap
+uniform float baseY;         // Base height offset in Y direction
+
+out vec3 vPos; // World-space corner position
+
+void main()
+{
+   vec2 xz = gl_Vertex.xz;
+   vec2 uv = (xz - heightRegion.xy) * heightRegion.zw;
+   float h = texture(heightTex, uv).a;
+   vPos = vec3(xz.x, baseY + h, xz.y);
+}
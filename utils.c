@@ -1,4 +1,9 @@
 #include "utils.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
 
 /*
  *  Print message to stderr and exit
@@ -53,6 +58,16 @@ void Print(const char *format, ...) {
  */
 double Vec3Length(double x, double y, double z) { return sqrt(x * x + y * y + z * z); }
 
+/*
+ *  Dot product of two 3D vectors.
+ *  @param ax,ay,az first vector
+ *  @param bx,by,bz second vector
+ */
+double Vec3Dot(double ax, double ay, double az, double bx, double by,
+               double bz) {
+  return ax * bx + ay * by + az * bz;
+}
+
 /*
  *  Normalize vector in place if it has non-negligible length.
  *  @param x x component of vector
@@ -121,6 +136,74 @@ double Rand01(unsigned int seed) {
   return (x & 0xFFFFFFu) / 16777215.0;
 }
 
+/*
+ *  Running FNV-1a hash over raw bytes (checksums)
+ *  @param hash previous hash (2166136261 to start)
+ *  @param data bytes to add
+ *  @param size number of bytes
+ *  @return updated hash
+ */
+unsigned int HashBytes(unsigned int hash, const void *data, int size) {
+  const unsigned char *p = data;
+  for (int i = 0; i < size; i++) {
+    hash ^= p[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/*
+ *  Write an unsigned integer as little-endian bytes
+ *  @param p where to write
+ *  @param v value
+ *  @param bytes field size (1 to 8)
+ *  @return end of the field
+ */
+unsigned char *PutLE(unsigned char *p, unsigned long long v, int bytes) {
+  for (int i = 0; i < bytes; i++) p[i] = (unsigned char)(v >> (8 * i));
+  return p + bytes;
+}
+
+/*
+ *  Read a little-endian unsigned integer
+ *  @param p where to read
+ *  @param v value read
+ *  @param bytes field size (1 to 8)
+ *  @return end of the field
+ */
+const unsigned char *GetLE(const unsigned char *p, unsigned long long *v,
+                           int bytes) {
+  *v = 0;
+  for (int i = 0; i < bytes; i++) *v |= (unsigned long long)p[i] << (8 * i);
+  return p + bytes;
+}
+
+/*
+ *  Write a float as 4 little-endian bytes
+ *  @param p where to write
+ *  @param f value
+ *  @return end of the field
+ */
+unsigned char *PutLEFloat(unsigned char *p, float f) {
+  unsigned int v;
+  memcpy(&v, &f, 4);
+  return PutLE(p, v, 4);
+}
+
+/*
+ *  Read a float from 4 little-endian bytes
+ *  @param p where to read
+ *  @param f value read
+ *  @return end of the field
+ */
+const unsigned char *GetLEFloat(const unsigned char *p, float *f) {
+  unsigned long long v;
+  p = GetLE(p, &v, 4);
+  const unsigned int u = (unsigned int)v;
+  memcpy(f, &u, 4);
+  return p;
+}
+
 /*
  *  Reverse n bytes
  *  Original author: Willem A. (Vlakkies) Schreuder
@@ -137,13 +220,17 @@ static void Reverse(void *x, const int n) {
 }
 
 /*
- *  Load texture from BMP file
+ *  Load BMP pixels into memory (RGB or RGBA, bottom row first)
  *  Original author: Willem A. (Vlakkies) Schreuder
  *  Extended with 32-bit support by Richard Roberson
  *  @param file name of file
- *  @return texture name
+ *  @param width image width (output)
+ *  @param height image height (output)
+ *  @param channels 3 for RGB, 4 for RGBA (output)
+ *  @return pixel buffer (caller frees)
  */
-unsigned int LoadTexBMP(const char *file) {
+unsigned char *LoadBMP(const char *file, int *width, int *height,
+                       int *channels) {
   //  Open file
   FILE *f = fopen(file, "rb");
   if (!f)
@@ -172,12 +259,8 @@ unsigned int LoadTexBMP(const char *file) {
     Reverse(&k, 4);
   }
   //  Check image parameters
-  unsigned int max;
-  glGetIntegerv(GL_MAX_TEXTURE_SIZE, (int *)&max);
-  if (dx < 1 || dx > max)
-    Fatal("%s image width %d out of range 1-%d\n", file, dx, max);
-  if (dy < 1 || dy > max)
-    Fatal("%s image height %d out of range 1-%d\n", file, dy, max);
+  if (dx < 1 || dy < 1)
+    Fatal("%s image size %dx%d is empty\n", file, dx, dy);
   if (nbp != 1)
     Fatal("%s bit planes is not 1: %d\n", file, nbp);
   if (bpp != 24 && bpp != 32)
@@ -185,21 +268,9 @@ unsigned int LoadTexBMP(const char *file) {
   //  32-bit BMPs often use BI_BITFIELDS (k=3) which is acceptable for RGBA
   if (k != 0 && !(bpp == 32 && k == 3))
     Fatal("%s compressed files not supported (compression=%d)\n", file, k);
-#ifndef GL_VERSION_2_0
-  //  OpenGL 2.0 lifts the restriction that texture size must be a power of two
-  for (k = 1; k < dx; k *= 2)
-    ;
-  if (k != dx)
-    Fatal("%s image width not a power of two: %d\n", file, dx);
-  for (k = 1; k < dy; k *= 2)
-    ;
-  if (k != dy)
-    Fatal("%s image height not a power of two: %d\n", file, dy);
-#endif
 
   //  Determine bytes per pixel
   int bytesPerPixel = bpp / 8;
-  int hasAlpha = (bpp == 32);
 
   //  Allocate image memory
   unsigned int size = bytesPerPixel * dx * dy;
@@ -218,6 +289,40 @@ unsigned int LoadTexBMP(const char *file) {
     image[k + 2] = temp;
   }
 
+  *width = dx;
+  *height = dy;
+  *channels = bytesPerPixel;
+  return image;
+}
+
+/*
+ *  Load texture from BMP file
+ *  @param file name of file
+ *  @return texture name
+ */
+unsigned int LoadTexBMP(const char *file) {
+  int dx, dy, bytesPerPixel;
+  unsigned char *image = LoadBMP(file, &dx, &dy, &bytesPerPixel);
+  int hasAlpha = (bytesPerPixel == 4);
+  //  Check image size against the GL limit
+  int max;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max);
+  if (dx > max)
+    Fatal("%s image width %d out of range 1-%d\n", file, dx, max);
+  if (dy > max)
+    Fatal("%s image height %d out of range 1-%d\n", file, dy, max);
+#ifndef GL_VERSION_2_0
+  //  OpenGL 2.0 lifts the restriction that texture size must be a power of two
+  int k;
+  for (k = 1; k < dx; k *= 2)
+    ;
+  if (k != dx)
+    Fatal("%s image width not a power of two: %d\n", file, dx);
+  for (k = 1; k < dy; k *= 2)
+    ;
+  if (k != dy)
+    Fatal("%s image height not a power of two: %d\n", file, dy);
+#endif
   //  Sanity check
   ErrCheck("LoadTexBMP");
   //  Generate 2D texture
@@ -343,3 +448,93 @@ unsigned int CreateShaderProg(const char *VertFile, const char *FragFile) {
   PrintProgramLog(prog);
   return prog;
 }
+
+/*
+ *  Create Shader Program with tessellation control/evaluation stages
+ *  Returns 0 when the GL headers predate tessellation shaders
+ *  @param VertFile vertex shader file
+ *  @param TcsFile tessellation control shader file
+ *  @param TesFile tessellation evaluation shader file
+ *  @param FragFile fragment shader file
+ */
+unsigned int CreateShaderProgTess(const char *VertFile, const char *TcsFile,
+                                  const char *TesFile, const char *FragFile) {
+#ifdef GL_VERSION_4_0
+  GLuint prog = glCreateProgram();
+  GLuint vert = CreateShader(GL_VERTEX_SHADER, VertFile);
+  GLuint tcs = CreateShader(GL_TESS_CONTROL_SHADER, TcsFile);
+  GLuint tes = CreateShader(GL_TESS_EVALUATION_SHADER, TesFile);
+  GLuint frag = CreateShader(GL_FRAGMENT_SHADER, FragFile);
+  glAttachShader(prog, vert);
+  glAttachShader(prog, tcs);
+  glAttachShader(prog, tes);
+  glAttachShader(prog, frag);
+  glLinkProgram(prog);
+  PrintProgramLog(prog);
+  //  Report failure as 0 so callers can fall back to the plain shader path
+  GLint linked = 0;
+  glGetProgramiv(prog, GL_LINK_STATUS, &linked);
+  if (!linked) {
+    glDeleteProgram(prog);
+    return 0;
+  }
+  return prog;
+#else
+  return 0;
+#endif
+}
+
+/*
+ *  Create Compute Shader Program
+ *  Returns 0 when the GL headers predate compute shaders or linking fails
+ *  @param CompFile compute shader file
+ */
+unsigned int CreateComputeProg(const char *CompFile) {
+#ifdef GL_VERSION_4_3
+  GLuint prog = glCreateProgram();
+  GLuint comp = CreateShader(GL_COMPUTE_SHADER, CompFile);
+  glAttachShader(prog, comp);
+  glLinkProgram(prog);
+  PrintProgramLog(prog);
+  GLint linked = 0;
+  glGetProgramiv(prog, GL_LINK_STATUS, &linked);
+  if (!linked) {
+    glDeleteProgram(prog);
+    return 0;
+  }
+  return prog;
+#else
+  return 0;
+#endif
+}
+
+/*
+ *  High-resolution monotonic clock (unaffected by wall-clock changes)
+ *  @return seconds since an arbitrary fixed point
+ */
+double TimeNow(void) {
+#ifdef _WIN32
+  static LARGE_INTEGER freq;
+  LARGE_INTEGER now;
+  if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&now);
+  return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+/*
+ *  Check the context version reported by the driver
+ *  @param major required major version
+ *  @param minor required minor version
+ *  @return 1 if the current context is at least major.minor
+ */
+int GLVersionAtLeast(int major, int minor) {
+  const char *ver = (const char *)glGetString(GL_VERSION);
+  int maj = 0, min = 0;
+  if (!ver || sscanf(ver, "%d.%d", &maj, &min) != 2) return 0;
+  return (maj > major) || (maj == major && min >= minor);
+}
@@ -56,17 +56,32 @@ void Fatal(const char* format , ...);
 #endif
 // Utilities
 void ErrCheck(const char* where);
+unsigned char* LoadBMP(const char* file, int* width, int* height, int* channels);
 unsigned int LoadTexBMP(const char* file);
 unsigned int CreateShaderProg(const char* vertFile, const char* fragFile);
+unsigned int CreateShaderProgTess(const char* vertFile, const char* tcsFile,
+                                  const char* tesFile, const char* fragFile);
+unsigned int CreateComputeProg(const char* compFile);
+int GLVersionAtLeast(int major, int minor);
+double TimeNow(void);
 
 // Math helpers
 double Vec3Length(double x, double y, double z);
+double Vec3Dot(double ax, double ay, double az, double bx, double by, double bz);
 void Vec3Normalize(double* x, double* y, double* z);
 void Vec3Cross(double ax, double ay, double az, double bx, double by, double bz,
                double* rx, double* ry, double* rz);
 void DirectionFromAngles(double th, double ph,
                          double* dx, double* dy, double* dz);
 double Rand01(unsigned int seed);
+unsigned int HashBytes(unsigned int hash, const void* data, int size);
+
+// Little-endian fields (file formats)
+unsigned char* PutLE(unsigned char* p, unsigned long long v, int bytes);
+const unsigned char* GetLE(const unsigned char* p, unsigned long long* v,
+                           int bytes);
+unsigned char* PutLEFloat(unsigned char* p, float f);
+const unsigned char* GetLEFloat(const unsigned char* p, float* f);
 
 
 #ifdef __cplusplus
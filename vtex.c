@@ -0,0 +1,557 @@
+/*
+ *  Virtual texture module - implementation file
+ *  The ring's rock color is one unique virtual texture of VT_PAGES x VT_PAGES
+ *  pages at level 0 (plus a mip chain of coarser page levels). Only pages the
+ *  camera actually sees live on the GPU, in a fixed-size page cache texture;
+ *  a page table (one texel per page, one mip level per page level) tells the
+ *  terrain shader where each page sits in the cache.
+ */
+#include "vtex.h"
+#include "utils.h"
+
+//  Virtual texture layout
+#define VT_PAGES 64          // Pages per side at level 0
+#define VT_LEVELS 7          // Page levels: 64x64, 32x32, ... 1x1 pages
+#define VT_PAYLOAD 120       // Unique texels per page side
+#define VT_BORDER 4          // Filtering border around each page
+#define VT_PAGE (VT_PAYLOAD + 2 * VT_BORDER) // Page side in the cache
+#define VT_TOTAL 5461        // Pages over all levels (64^2 + 32^2 + ... + 1)
+//  Page cache and streaming
+#define VT_CACHE_SIDE 16     // Cache is 16x16 pages (2048x2048 RGB)
+#define VT_SLOTS (VT_CACHE_SIDE * VT_CACHE_SIDE)
+#define VT_PINNED_LEVEL 4    // Levels >= 4 (21 pages) are always resident
+#define VT_UPLOADS_PER_FRAME 4
+//  Feedback pass
+#define VT_FEEDBACK_DIV 8    // Feedback target is 1/8 of the window size
+#define VT_FEEDBACK_INTERVAL 2 // Frames between feedback passes
+//  Texture units used by the terrain shader
+#define VT_CACHE_UNIT 5
+#define VT_TABLE_UNIT 6
+//  Source texture tiling, same as the splat shader's texScale
+#define VT_ROCK_SCALE 0.04
+#define VT_MOSS_SCALE 0.05
+
+/*
+ *  CPU copy of a source image with a box-filtered mip chain (RGB)
+ */
+typedef struct {
+  int levels;
+  int size[12];
+  unsigned char *rgb[12];
+} SourceImage;
+
+/*
+ *  All virtual texture state (single instance for the mountain ring)
+ */
+static struct {
+  int ready;
+  float x0, z0, size;            // World region covered
+  SourceImage rock, moss;        // Composition sources
+  unsigned int cacheTex;         // Physical page cache (RGB)
+  unsigned int tableTex;         // Page table (RGBA: slot x, slot y, level)
+  unsigned int fbo, fbColor, fbDepth, pbo;
+  int fbW, fbH;                  // Feedback target size
+  int readW, readH;              // Size of the pending readback
+  int readPending;               // A readback waits in the PBO
+  int prevFbo;                   // Framebuffer to restore after feedback
+  int frame;                     // Display frame counter
+  int lastFeedback;              // Frame of the last feedback pass
+  int stamp;                     // Feedback counter (LRU clock)
+  int slotOfPage[VT_TOTAL];      // Cache slot of each page (-1 = absent)
+  int pageOfSlot[VT_SLOTS];      // Page held by each slot (-1 = free)
+  int lastUsed[VT_SLOTS];        // Feedback stamp that last saw the slot
+  int requested[VT_TOTAL];       // Feedback stamp that last asked for a page
+  int queue[VT_TOTAL];           // Missing pages, coarse levels first
+  int queueLen, queuePos;
+  int resident;
+  int tableDirty;
+  unsigned char table[VT_TOTAL * 4];
+  unsigned char page[VT_PAGE * VT_PAGE * 3];
+} vt;
+
+//  First page index of each level
+static const int levelOffset[VT_LEVELS + 1] = {0,    4096, 5120, 5376,
+                                               5440, 5456, 5460, 5461};
+
+/*
+ *  Level of a page index
+ */
+static int pageLevel(int idx) {
+  int l = 0;
+  while (idx >= levelOffset[l + 1]) l++;
+  return l;
+}
+
+/*
+ *  Page index of page (px, py) at a level
+ */
+static int pageIndex(int level, int px, int py) {
+  return levelOffset[level] + py * (VT_PAGES >> level) + px;
+}
+
+/*
+ *  Load a BMP and build its RGB mip chain (square power-of-two images)
+ *  @param img destination
+ *  @param file BMP file name
+ */
+static void loadSource(SourceImage *img, const char *file) {
+  int w, h, c;
+  unsigned char *pix = LoadBMP(file, &w, &h, &c);
+  int n = w < h ? w : h;
+  img->levels = 0;
+  // Level 0: drop alpha and crop to a square
+  unsigned char *dst = (unsigned char *)malloc(3 * n * n);
+  if (!dst) Fatal("Cannot allocate virtual texture source %s\n", file);
+  for (int y = 0; y < n; y++)
+    for (int x = 0; x < n; x++)
+      for (int k = 0; k < 3; k++) dst[3 * (y * n + x) + k] = pix[c * (y * w + x) + k];
+  free(pix);
+  img->size[0] = n;
+  img->rgb[0] = dst;
+  img->levels = 1;
+  // Box-filter down to 1x1
+  while (n > 1 && img->levels < 12) {
+    int m = n / 2;
+    const unsigned char *src = img->rgb[img->levels - 1];
+    dst = (unsigned char *)malloc(3 * m * m);
+    if (!dst) Fatal("Cannot allocate virtual texture source %s\n", file);
+    for (int y = 0; y < m; y++)
+      for (int x = 0; x < m; x++)
+        for (int k = 0; k < 3; k++) {
+          int s = src[3 * ((2 * y) * n + 2 * x) + k] +
+                  src[3 * ((2 * y) * n + 2 * x + 1) + k] +
+                  src[3 * ((2 * y + 1) * n + 2 * x) + k] +
+                  src[3 * ((2 * y + 1) * n + 2 * x + 1) + k];
+          dst[3 * (y * m + x) + k] = (unsigned char)(s / 4);
+        }
+    img->size[img->levels] = m;
+    img->rgb[img->levels] = dst;
+    img->levels++;
+    n = m;
+  }
+}
+
+/*
+ *  Bilinear, wrapping sample of a source mip level
+ *  @param img source image
+ *  @param level mip level
+ *  @param u texture coordinate (repeats)
+ *  @param v texture coordinate (repeats)
+ *  @param out RGB in 0..255
+ */
+static void sampleSource(const SourceImage *img, int level, double u, double v,
+                         double out[3]) {
+  int n = img->size[level];
+  const unsigned char *p = img->rgb[level];
+  double fx = u * n - 0.5, fy = v * n - 0.5;
+  double x0f = floor(fx), y0f = floor(fy);
+  double tx = fx - x0f, ty = fy - y0f;
+  int x0 = ((int)x0f % n + n) % n, y0 = ((int)y0f % n + n) % n;
+  int x1 = (x0 + 1) % n, y1 = (y0 + 1) % n;
+  for (int k = 0; k < 3; k++) {
+    double a = p[3 * (y0 * n + x0) + k] + tx * (p[3 * (y0 * n + x1) + k] - p[3 * (y0 * n + x0) + k]);
+    double b = p[3 * (y1 * n + x0) + k] + tx * (p[3 * (y1 * n + x1) + k] - p[3 * (y1 * n + x0) + k]);
+    out[k] = a + ty * (b - a);
+  }
+}
+
+/*
+ *  Source mip level whose texels match a footprint in the virtual texture
+ *  @param img source image
+ *  @param texelWorld world size of one virtual texel
+ *  @param scale source tiling (UV per world unit)
+ */
+static int sourceLevel(const SourceImage *img, double texelWorld, double scale) {
+  double footprint = texelWorld * scale * img->size[0]; // Source texels
+  int l = (footprint > 1.0) ? (int)floor(log2(footprint) + 0.5) : 0;
+  return l < img->levels ? l : img->levels - 1;
+}
+
+/*
+ *  Smooth 2D value noise in [0,1] for macro variation
+ */
+static double hashNoise(int x, int y) {
+  unsigned int h = (unsigned int)x * 374761393u + (unsigned int)y * 668265263u;
+  h = (h ^ (h >> 13)) * 1274126177u;
+  return ((h ^ (h >> 16)) & 0xffff) / 65535.0;
+}
+static double valueNoise(double x, double y) {
+  double xf = floor(x), yf = floor(y);
+  int xi = (int)xf, yi = (int)yf;
+  double tx = x - xf, ty = y - yf;
+  tx = tx * tx * (3.0 - 2.0 * tx);
+  ty = ty * ty * (3.0 - 2.0 * ty);
+  double a = hashNoise(xi, yi), b = hashNoise(xi + 1, yi);
+  double c = hashNoise(xi, yi + 1), d = hashNoise(xi + 1, yi + 1);
+  return a + tx * (b - a) + ty * (c + tx * (d - c) - a - tx * (b - a));
+}
+static double fbm3(double x, double y) {
+  return 0.5 * valueNoise(x, y) + 0.3 * valueNoise(2.03 * x, 2.03 * y) +
+         0.2 * valueNoise(4.11 * x, 4.11 * y);
+}
+
+/*
+ *  Compose one page (payload + border) into vt.page
+ *  Rock detail is the tiled rock texture; a second, rotated rock layer,
+ *  brightness variation and moss patches driven by low-frequency noise make
+ *  every page unique so the 25-unit rock tile no longer repeats visibly.
+ *  @param level page level
+ *  @param px page column
+ *  @param py page row
+ */
+static void composePage(int level, int px, int py) {
+  int texels = (VT_PAGES >> level) * VT_PAYLOAD; // Virtual texels per side
+  double texelWorld = vt.size / texels;
+  int rockL = sourceLevel(&vt.rock, texelWorld, VT_ROCK_SCALE);
+  int rock2L = sourceLevel(&vt.rock, texelWorld, VT_ROCK_SCALE * 1.37);
+  int mossL = sourceLevel(&vt.moss, texelWorld, VT_MOSS_SCALE);
+  const double ca = 0.7986, sa = 0.6018; // Second layer rotated ~37 degrees
+
+  unsigned char *dst = vt.page;
+  for (int j = 0; j < VT_PAGE; j++) {
+    double z = vt.z0 + (py * VT_PAYLOAD + j - VT_BORDER + 0.5) * texelWorld;
+    for (int i = 0; i < VT_PAGE; i++) {
+      double x = vt.x0 + (px * VT_PAYLOAD + i - VT_BORDER + 0.5) * texelWorld;
+      double r1[3], r2[3], m[3];
+      sampleSource(&vt.rock, rockL, x * VT_ROCK_SCALE, z * VT_ROCK_SCALE, r1);
+      double u2 = (ca * x - sa * z) * VT_ROCK_SCALE * 1.37 + 0.31;
+      double v2 = (sa * x + ca * z) * VT_ROCK_SCALE * 1.37 + 0.57;
+      sampleSource(&vt.rock, rock2L, u2, v2, r2);
+      sampleSource(&vt.moss, mossL, x * VT_MOSS_SCALE, z * VT_MOSS_SCALE, m);
+
+      // Large-scale layer mix, brightness and moss coverage
+      double mix = fbm3(x * 0.02, z * 0.02);
+      mix = (mix - 0.35) / 0.3;
+      mix = mix < 0 ? 0 : mix > 1 ? 1 : mix;
+      double shade = 0.8 + 0.4 * fbm3(x * 0.07 + 17.0, z * 0.07 - 5.0);
+      double moss = (fbm3(x * 0.05 - 31.0, z * 0.05 + 11.0) - 0.55) / 0.25;
+      moss = moss < 0 ? 0 : moss > 1 ? 0.6 : 0.6 * moss;
+      for (int k = 0; k < 3; k++) {
+        double c = (r1[k] + mix * (r2[k] - r1[k])) * shade;
+        c += moss * (m[k] - c);
+        *dst++ = (unsigned char)(c > 255.0 ? 255.0 : c);
+      }
+    }
+  }
+}
+
+/*
+ *  Compose a page and copy it into a cache slot
+ *  @param idx page index
+ *  @param slot cache slot
+ */
+static void uploadPage(int idx, int slot) {
+  int level = pageLevel(idx);
+  int n = VT_PAGES >> level;
+  int local = idx - levelOffset[level];
+  composePage(level, local % n, local / n);
+  glBindTexture(GL_TEXTURE_2D, vt.cacheTex);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % VT_CACHE_SIDE) * VT_PAGE,
+                  (slot / VT_CACHE_SIDE) * VT_PAGE, VT_PAGE, VT_PAGE, GL_RGB,
+                  GL_UNSIGNED_BYTE, vt.page);
+  vt.slotOfPage[idx] = slot;
+  vt.pageOfSlot[slot] = idx;
+  vt.lastUsed[slot] = vt.stamp;
+  vt.tableDirty = 1;
+}
+
+/*
+ *  Pick a cache slot: a free one, else the least recently used page that
+ *  the latest feedback did not ask for (pinned levels are never evicted)
+ *  @return slot or -1 if every slot is in use
+ */
+static int allocSlot(void) {
+  int best = -1;
+  for (int s = 0; s < VT_SLOTS; s++) {
+    int idx = vt.pageOfSlot[s];
+    if (idx < 0) return s;
+    if (pageLevel(idx) >= VT_PINNED_LEVEL || vt.lastUsed[s] >= vt.stamp)
+      continue;
+    if (best < 0 || vt.lastUsed[s] < vt.lastUsed[best]) best = s;
+  }
+  if (best >= 0) {
+    vt.slotOfPage[vt.pageOfSlot[best]] = -1;
+    vt.pageOfSlot[best] = -1;
+    vt.resident--;
+  }
+  return best;
+}
+
+/*
+ *  Rebuild the page table: each entry points at its own page when resident,
+ *  otherwise at the nearest resident ancestor (coarsest level is pinned)
+ */
+static void refreshTable(void) {
+  for (int l = VT_LEVELS - 1; l >= 0; l--) {
+    int n = VT_PAGES >> l;
+    for (int py = 0; py < n; py++)
+      for (int px = 0; px < n; px++) {
+        int idx = pageIndex(l, px, py);
+        unsigned char *e = vt.table + 4 * idx;
+        int slot = vt.slotOfPage[idx];
+        if (slot >= 0) {
+          e[0] = (unsigned char)(slot % VT_CACHE_SIDE);
+          e[1] = (unsigned char)(slot / VT_CACHE_SIDE);
+          e[2] = (unsigned char)l;
+          e[3] = 255;
+        } else {
+          memcpy(e, vt.table + 4 * pageIndex(l + 1, px / 2, py / 2), 4);
+        }
+      }
+  }
+  glBindTexture(GL_TEXTURE_2D, vt.tableTex);
+  for (int l = 0; l < VT_LEVELS; l++)
+    glTexSubImage2D(GL_TEXTURE_2D, l, 0, 0, VT_PAGES >> l, VT_PAGES >> l,
+                    GL_RGBA, GL_UNSIGNED_BYTE, vt.table + 4 * levelOffset[l]);
+  vt.tableDirty = 0;
+}
+
+/*
+ *  Order missing pages coarse-first so fallbacks sharpen progressively
+ */
+static int coarseFirst(const void *a, const void *b) {
+  return pageLevel(*(const int *)b) - pageLevel(*(const int *)a);
+}
+
+/*
+ *  Turn feedback pixels into page requests (pages plus their ancestors)
+ *  @param pix RGBA feedback: page x, page y, level, alpha 255 = request
+ *  @param count number of pixels
+ */
+static void processFeedback(const unsigned char *pix, int count) {
+  vt.stamp++;
+  vt.queueLen = vt.queuePos = 0;
+  for (int i = 0; i < count; i++, pix += 4) {
+    if (pix[3] != 255 || pix[2] >= VT_LEVELS) continue;
+    int level = pix[2], px = pix[0], py = pix[1];
+    if (px >= (VT_PAGES >> level) || py >= (VT_PAGES >> level)) continue;
+    for (int l = level; l < VT_LEVELS; l++, px /= 2, py /= 2) {
+      int idx = pageIndex(l, px, py);
+      if (vt.requested[idx] == vt.stamp) break; // Ancestors already marked
+      vt.requested[idx] = vt.stamp;
+      int slot = vt.slotOfPage[idx];
+      if (slot >= 0)
+        vt.lastUsed[slot] = vt.stamp;
+      else
+        vt.queue[vt.queueLen++] = idx;
+    }
+  }
+  qsort(vt.queue, vt.queueLen, sizeof(int), coarseFirst);
+}
+
+/*
+ *  Create the page cache, page table and feedback target
+ */
+int initVirtualTexture(double x0, double z0, double size, const char *rockFile,
+                       const char *groundFile) {
+#ifdef GL_VERSION_3_0
+  if (!GLVersionAtLeast(3, 0)) return 0;
+  vt.x0 = (float)x0;
+  vt.z0 = (float)z0;
+  vt.size = (float)size;
+  loadSource(&vt.rock, rockFile);
+  loadSource(&vt.moss, groundFile);
+
+  // Page cache: fixed GPU footprint regardless of the virtual size
+  glActiveTexture(GL_TEXTURE0 + VT_CACHE_UNIT);
+  glGenTextures(1, &vt.cacheTex);
+  glBindTexture(GL_TEXTURE_2D, vt.cacheTex);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, VT_CACHE_SIDE * VT_PAGE,
+               VT_CACHE_SIDE * VT_PAGE, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  // Page table: mip level l holds the entries of page level l
+  glActiveTexture(GL_TEXTURE0 + VT_TABLE_UNIT);
+  glGenTextures(1, &vt.tableTex);
+  glBindTexture(GL_TEXTURE_2D, vt.tableTex);
+  for (int l = 0; l < VT_LEVELS; l++)
+    glTexImage2D(GL_TEXTURE_2D, l, GL_RGBA8, VT_PAGES >> l, VT_PAGES >> l, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, VT_LEVELS - 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glActiveTexture(GL_TEXTURE0);
+
+  // Feedback target (sized lazily to the window) and readback buffer
+  glGenFramebuffers(1, &vt.fbo);
+  glGenRenderbuffers(1, &vt.fbColor);
+  glGenRenderbuffers(1, &vt.fbDepth);
+  glGenBuffers(1, &vt.pbo);
+
+  // Start with the pinned coarse levels so every lookup has a fallback
+  for (int i = 0; i < VT_TOTAL; i++) vt.slotOfPage[i] = -1;
+  for (int s = 0; s < VT_SLOTS; s++) vt.pageOfSlot[s] = -1;
+  for (int idx = levelOffset[VT_PINNED_LEVEL]; idx < VT_TOTAL; idx++) {
+    uploadPage(idx, vt.resident);
+    vt.resident++;
+  }
+  refreshTable();
+  glBindTexture(GL_TEXTURE_2D, 0);
+  ErrCheck("initVirtualTexture");
+  vt.ready = 1;
+  return 1;
+#else
+  (void)x0, (void)z0, (void)size, (void)rockFile, (void)groundFile;
+  return 0;
+#endif
+}
+
+/*
+ *  Bind the feedback target if a feedback pass is due this frame
+ */
+int beginVirtualTextureFeedback(void) {
+#ifdef GL_VERSION_3_0
+  if (!vt.ready || vt.readPending ||
+      vt.frame - vt.lastFeedback < VT_FEEDBACK_INTERVAL)
+    return 0;
+  GLint vp[4];
+  glGetIntegerv(GL_VIEWPORT, vp);
+  int w = vp[2] / VT_FEEDBACK_DIV, h = vp[3] / VT_FEEDBACK_DIV;
+  if (w < 1 || h < 1) return 0;
+
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &vt.prevFbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, vt.fbo);
+  if (w != vt.fbW || h != vt.fbH) {
+    glBindRenderbuffer(GL_RENDERBUFFER, vt.fbColor);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, vt.fbDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                              GL_RENDERBUFFER, vt.fbColor);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                              GL_RENDERBUFFER, vt.fbDepth);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, vt.pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, 4 * w * h, NULL, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    vt.fbW = w;
+    vt.fbH = h;
+  }
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    glBindFramebuffer(GL_FRAMEBUFFER, vt.prevFbo);
+    return 0;
+  }
+
+  glPushAttrib(GL_VIEWPORT_BIT | GL_COLOR_BUFFER_BIT);
+  glViewport(0, 0, w, h);
+  glDisable(GL_BLEND);
+  glClearColor(0, 0, 0, 0); // Alpha 0 = no request
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+/*
+ *  Queue the page ID readback into the PBO (consumed next frame, no stall)
+ */
+void endVirtualTextureFeedback(void) {
+#ifdef GL_VERSION_3_0
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, vt.pbo);
+  glReadPixels(0, 0, vt.fbW, vt.fbH, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, vt.prevFbo);
+  glPopAttrib();
+  vt.readW = vt.fbW;
+  vt.readH = vt.fbH;
+  vt.readPending = 1;
+  vt.lastFeedback = vt.frame;
+#endif
+}
+
+/*
+ *  Consume feedback, stream pages within budget, refresh the page table
+ */
+void updateVirtualTexture(void) {
+#ifdef GL_VERSION_3_0
+  if (!vt.ready) return;
+
+  // Feedback read in an earlier frame has landed in the PBO by now
+  if (vt.readPending && vt.frame > vt.lastFeedback) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, vt.pbo);
+    const unsigned char *pix =
+        (const unsigned char *)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (pix) {
+      processFeedback(pix, vt.readW * vt.readH);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    vt.readPending = 0;
+  }
+
+  // Stream a few missing pages per frame, coarse levels first
+  int uploads = 0;
+  glActiveTexture(GL_TEXTURE0 + VT_CACHE_UNIT);
+  while (vt.queuePos < vt.queueLen && uploads < VT_UPLOADS_PER_FRAME) {
+    int idx = vt.queue[vt.queuePos];
+    if (vt.slotOfPage[idx] >= 0) {
+      vt.queuePos++;
+      continue;
+    }
+    int slot = allocSlot();
+    if (slot < 0) {
+      vt.queuePos = vt.queueLen; // Cache full of visible pages
+      break;
+    }
+    uploadPage(idx, slot);
+    vt.resident++;
+    vt.queuePos++;
+    uploads++;
+  }
+  glActiveTexture(GL_TEXTURE0 + VT_TABLE_UNIT);
+  if (vt.tableDirty) refreshTable();
+  glActiveTexture(GL_TEXTURE0);
+  vt.frame++;
+#endif
+}
+
+/*
+ *  Virtual texture layout uniforms shared by the feedback and terrain shaders
+ */
+static void setLayoutUniforms(unsigned int shader) {
+  glUniform4f(glGetUniformLocation(shader, "vtParams"), (float)VT_PAGES,
+              (float)VT_PAYLOAD, (float)VT_BORDER,
+              1.0f / (VT_CACHE_SIDE * VT_PAGE));
+}
+
+/*
+ *  Feedback program uniforms
+ */
+void setVirtualTextureFeedbackUniforms(unsigned int shader) {
+  setLayoutUniforms(shader);
+  glUniform4f(glGetUniformLocation(shader, "vtRegion"), vt.x0, vt.z0,
+              1.0f / vt.size, 1.0f);
+  // The target is VT_FEEDBACK_DIV times coarser than the screen
+  glUniform2f(glGetUniformLocation(shader, "vtFeedback"),
+              (float)-log2(VT_FEEDBACK_DIV), (float)(VT_LEVELS - 1));
+}
+
+/*
+ *  Bind cache + table and set the terrain shader's virtual texture uniforms
+ */
+void bindVirtualTexture(unsigned int shader, int enabled) {
+  enabled = enabled && vt.ready;
+  glUniform4f(glGetUniformLocation(shader, "vtRegion"), vt.x0, vt.z0,
+              vt.size > 0 ? 1.0f / vt.size : 0.0f, enabled ? 1.0f : 0.0f);
+  if (!enabled) return;
+  setLayoutUniforms(shader);
+  glActiveTexture(GL_TEXTURE0 + VT_CACHE_UNIT);
+  glBindTexture(GL_TEXTURE_2D, vt.cacheTex);
+  glActiveTexture(GL_TEXTURE0 + VT_TABLE_UNIT);
+  glBindTexture(GL_TEXTURE_2D, vt.tableTex);
+  glActiveTexture(GL_TEXTURE0);
+}
+
+/*
+ *  Page cache occupancy
+ */
+void virtualTextureResidency(int *resident, int *capacity) {
+  *resident = vt.resident;
+  *capacity = VT_SLOTS;
+}
@@ -0,0 +1,61 @@
+/*
+ *  Virtual texture module - header file
+ *  Sparse virtual texturing for the mountain ring: a large unique texture
+ *  split into pages that are composed on the CPU and streamed into a page
+ *  cache on demand, driven by a low-resolution feedback pass
+ */
+#ifndef VTEX_H
+#define VTEX_H
+
+/*
+ *  Create the page cache, page table and feedback target
+ *  @param x0 world X of the virtual texture's first texel
+ *  @param z0 world Z of the virtual texture's first texel
+ *  @param size world width/depth covered by the virtual texture
+ *  @param rockFile BMP used as the rock detail source
+ *  @param groundFile BMP blended in as moss/dirt
+ *  @return 1 if virtual texturing is available (OpenGL 3.0+), 0 otherwise
+ */
+int initVirtualTexture(double x0, double z0, double size, const char *rockFile,
+                       const char *groundFile);
+
+/*
+ *  Start a feedback pass: binds the low-resolution feedback target
+ *  The caller then draws the terrain with a vtex_feedback.frag program
+ *  @return 1 if a feedback pass should be drawn this frame
+ */
+int beginVirtualTextureFeedback(void);
+
+/*
+ *  Finish a feedback pass and queue an asynchronous readback of page IDs
+ */
+void endVirtualTextureFeedback(void);
+
+/*
+ *  Once per frame: consume finished feedback, stream missing pages within
+ *  the per-frame upload budget and refresh the page table
+ */
+void updateVirtualTexture(void);
+
+/*
+ *  Set the uniforms a feedback program needs (program bound by caller)
+ *  @param shader feedback program
+ */
+void setVirtualTextureFeedbackUniforms(unsigned int shader);
+
+/*
+ *  Bind the page cache (unit 5) and page table (unit 6) for the terrain
+ *  shader and set its virtual texture uniforms (program bound by caller)
+ *  @param shader terrain splat shader
+ *  @param enabled 0 to make the shader use the tiled rock texture instead
+ */
+void bindVirtualTexture(unsigned int shader, int enabled);
+
+/*
+ *  Page cache occupancy for the HUD
+ *  @param resident pages currently in the cache (output)
+ *  @param capacity cache size in pages (output)
+ */
+void virtualTextureResidency(int *resident, int *capacity);
+
+#endif
@@ -0,0 +1,29 @@
+#version 120
+
+// Virtual texture feedback: writes the page each rock pixel needs
+uniform vec4 vtRegion;   // (x0, z0, 1/size, unused) of the virtual texture
+uniform vec4 vtParams;   // (pages at level 0, page payload, border, 1/cache size)
+uniform vec2 vtFeedback; // (lod bias for the reduced target, coarsest level)
+
+// Inputs shared with terrain_normal.frag (only these two are used)
+varying vec2 W;      // World XZ
+varying float rockW; // Splat weight: 0 = forest ground, 1 = rock
+
+void main()
+{
+   // 1) Level-0 virtual texel coordinates and their screen derivatives
+   //    (taken before any branch so they are well defined)
+   vec2 uv = clamp((W - vtRegion.xy) * vtRegion.z, 0.0, 0.99999);
+   vec2 t  = uv * vtParams.x * vtParams.y;
+   vec2 dx = dFdx(t);
+   vec2 dy = dFdy(t);
+
+   // 2) Same level choice as the page table's nearest-mip lookup
+   float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + vtFeedback.x;
+   float level = clamp(floor(lod + 0.5), 0.0, vtFeedback.y);
+   vec2 page = floor(uv * vtParams.x * exp2(-level));
+
+   // 3) Only the rock layer is virtual: alpha 0 means "no request"
+   float wanted = (rockW > 0.0) ? 255.0 : 0.0;
+   gl_FragColor = vec4(page, level, wanted) / 255.0;
+}
@@ -0,0 +1,181 @@
+/*
+ *  Wind module - implementation file
+ *  Gusts are Gaussian puffs added to the grid at random places and times,
+ *  pointing roughly along the mean wind. Between puffs the grid decays
+ *  toward calm and diffuses a little, so puffs fade and spread as they
+ *  drift. Drifting is free: the grid is sampled at the point minus the
+ *  distance the mean wind has carried it.
+ */
+#include "wind.h"
+#include "utils.h"
+
+#define GUST_RATE 1.5     // New gusts per second
+#define GUST_LIFE 4.0     // Gust decay time (seconds)
+#define GUST_SIGMA 2.0    // Gust size (cells)
+#define GUST_SPREAD 45.0  // Gust heading spread around the mean (degrees)
+#define WIND_DIFFUSE 0.025f // Diffusion per grid update (stencil weight)
+
+/*
+ *  Uniform random number in [0,1) (xorshift)
+ */
+static double windRand(unsigned int *s) {
+  unsigned int x = *s;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *s = x;
+  return x / 4294967296.0;
+}
+
+/*
+ *  Mean wind at the current time: heading veers +/-30 degrees over a minute
+ */
+static void updateMean(WindField *w) {
+  const double heading = w->heading0 + 30.0 * Sin(6.0 * w->time);
+  w->mean[0] = w->strength * Cos(heading);
+  w->mean[1] = w->strength * Sin(heading);
+}
+
+/*
+ *  Add one gust puff at a random place
+ *  @param w wind field
+ *  @param scale peak speed relative to a fresh gust (older gusts are weaker)
+ */
+static void addGust(WindField *w, double scale) {
+  const double cx = WIND_DIM * windRand(&w->seed);
+  const double cz = WIND_DIM * windRand(&w->seed);
+  const double heading = atan2(w->mean[1], w->mean[0]) * 180.0 / M_PI +
+                         GUST_SPREAD * (2.0 * windRand(&w->seed) - 1.0);
+  const double peak = scale * w->strength * (0.5 + 0.5 * windRand(&w->seed));
+  const float ux = (float)(peak * Cos(heading)), uz = (float)(peak * Sin(heading));
+  const int r = (int)(3.0 * GUST_SIGMA);
+  const int i0 = (int)floor(cx), k0 = (int)floor(cz);
+  for (int k = k0 - r; k <= k0 + r; k++) {
+    for (int i = i0 - r; i <= i0 + r; i++) {
+      const double dx = i - cx, dz = k - cz;
+      const float f =
+          (float)exp(-(dx * dx + dz * dz) / (2.0 * GUST_SIGMA * GUST_SIGMA));
+      const int c = (k & (WIND_DIM - 1)) * WIND_DIM + (i & (WIND_DIM - 1));
+      w->gx[c] += f * ux;
+      w->gz[c] += f * uz;
+    }
+  }
+}
+
+/*
+ *  One decay and diffusion step over a grid
+ *  The grid is copied into a padded buffer with wrapped borders first, so
+ *  the stencil loop has no index wrapping and vectorizes.
+ *  @param g grid (updated in place)
+ *  @param keep decay factor for this step
+ */
+static void relaxGrid(float *restrict g, float keep) {
+  enum { P = WIND_DIM + 2 };
+  float pad[P * P];
+  for (int k = 0; k < P; k++) {
+    const int gk = (k + WIND_DIM - 1) & (WIND_DIM - 1);
+    for (int i = 0; i < P; i++)
+      pad[k * P + i] = g[gk * WIND_DIM + ((i + WIND_DIM - 1) & (WIND_DIM - 1))];
+  }
+  for (int k = 0; k < WIND_DIM; k++) {
+    const float *restrict row = pad + (k + 1) * P + 1;
+    float *restrict out = g + k * WIND_DIM;
+    for (int i = 0; i < WIND_DIM; i++) {
+      const float c = row[i];
+      const float lap = row[i - 1] + row[i + 1] + row[i - P] + row[i + P] - 4.0f * c;
+      out[i] = keep * (c + WIND_DIFFUSE * lap);
+    }
+  }
+}
+
+/*
+ *  Start a wind field with gusts already developed
+ *  About GUST_RATE * GUST_LIFE gusts are alive at any time, so that many
+ *  are seeded at random ages instead of simulating a warm-up.
+ */
+void initWindField(WindField *w, double strength, double drag,
+                   unsigned int seed) {
+  memset(w, 0, sizeof(*w));
+  w->strength = strength;
+  w->drag = drag;
+  w->seed = seed ? seed : 1u;
+  w->heading0 = 360.0 * windRand(&w->seed);
+  updateMean(w);
+  if (strength <= 0.0) return;
+  const int n = (int)(GUST_RATE * GUST_LIFE + 0.5);
+  for (int k = 0; k < n; k++) {
+    const double age = GUST_LIFE * windRand(&w->seed);
+    addGust(w, exp(-age / GUST_LIFE));
+  }
+}
+
+/*
+ *  Advance the wind by one simulation tick
+ *  @param w wind field
+ *  @param dt simulation tick (seconds)
+ */
+void advanceWindField(WindField *w, double dt) {
+  if (++w->ticks < WIND_TICKS) return;
+  w->ticks = 0;
+  const double h = dt * WIND_TICKS;
+  w->time += h;
+  updateMean(w);
+  if (w->strength <= 0.0) return; // Calm air has no gusts
+
+  // Gusts drift with the mean wind (wrapped to keep precision)
+  const double span = WIND_DIM * WIND_CELL;
+  for (int a = 0; a < 2; a++)
+    w->shift[a] = fmod(w->shift[a] + w->mean[a] * h + span, span);
+
+  const float keep = (float)exp(-h / GUST_LIFE);
+  relaxGrid(w->gx, keep);
+  relaxGrid(w->gz, keep);
+  if (windRand(&w->seed) < GUST_RATE * h) addGust(w, 1.0);
+}
+
+/*
+ *  Wind at a point (mean plus bilinear gust lookup)
+ */
+void sampleWind(const WindField *w, double x, double z, double out[2]) {
+  const double u = (x - w->shift[0]) / WIND_CELL;
+  const double v = (z - w->shift[1]) / WIND_CELL;
+  const double fu = floor(u), fv = floor(v);
+  const double s = u - fu, t = v - fv;
+  const int m = WIND_DIM - 1;
+  const int i0 = (int)fu & m, i1 = (i0 + 1) & m;
+  const int k0 = ((int)fv & m) * WIND_DIM, k1 = (((int)fv + 1) & m) * WIND_DIM;
+  const float *g[2] = {w->gx, w->gz};
+  for (int a = 0; a < 2; a++) {
+    const double lo = g[a][k0 + i0] + s * (g[a][k0 + i1] - g[a][k0 + i0]);
+    const double hi = g[a][k1 + i0] + s * (g[a][k1 + i1] - g[a][k1 + i0]);
+    out[a] = w->mean[a] + lo + t * (hi - lo);
+  }
+}
+
+/*
+ *  Wind at many points (structure-of-arrays, for the arrow pool)
+ */
+void sampleWindArrays(const WindField *w, int n, const float *restrict x,
+                      const float *restrict z, float *restrict wx,
+                      float *restrict wz) {
+  const float *restrict gx = w->gx, *restrict gz = w->gz;
+  const float inv = (float)(1.0 / WIND_CELL);
+  const float sx = (float)w->shift[0], sz = (float)w->shift[1];
+  const float mx = (float)w->mean[0], mz = (float)w->mean[1];
+  const int m = WIND_DIM - 1;
+  // Offset by whole grid spans so truncation floors (no floorf call)
+  const float bias = 64.0f * WIND_DIM;
+  for (int j = 0; j < n; j++) {
+    const float u = (x[j] - sx) * inv + bias, v = (z[j] - sz) * inv + bias;
+    const int iu = (int)u, iv = (int)v;
+    const float s = u - (float)iu, t = v - (float)iv;
+    const int i0 = iu & m, i1 = (iu + 1) & m;
+    const int k0 = (iv & m) * WIND_DIM, k1 = ((iv + 1) & m) * WIND_DIM;
+    const float w00 = (1 - s) * (1 - t), w10 = s * (1 - t);
+    const float w01 = (1 - s) * t, w11 = s * t;
+    wx[j] = mx + w00 * gx[k0 + i0] + w10 * gx[k0 + i1] + w01 * gx[k1 + i0] +
+            w11 * gx[k1 + i1];
+    wz[j] = mz + w00 * gz[k0 + i0] + w10 * gz[k0 + i1] + w01 * gz[k1 + i0] +
+            w11 * gz[k1 + i1];
+  }
+}
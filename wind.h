@@ -0,0 +1,72 @@
+/*
+ *  Wind module - header file
+ *  Gusty wind over the XZ plane: a steady mean wind that slowly veers,
+ *  plus gusts on a coarse wrapping grid. The grid is stored in a frame
+ *  that drifts with the mean wind, so gusts travel downwind without
+ *  resampling; a grid update only decays and diffuses it and seeds new
+ *  gusts. Updates run every few ticks and sampling is one bilinear lookup.
+ */
+#ifndef WIND_H
+#define WIND_H
+
+#define WIND_DIM 32   // Grid cells per side (power of two; the grid wraps)
+#define WIND_CELL 4.0 // Cell side in world units
+#define WIND_TICKS 4  // Simulation ticks per grid update
+
+/*
+ *  Wind state (also the air arrows fly through: drag lives here)
+ */
+typedef struct {
+  float gx[WIND_DIM * WIND_DIM]; // Gust velocity X, row-major by Z
+  float gz[WIND_DIM * WIND_DIM]; // Gust velocity Z
+  double strength;   // Mean wind speed (units per second, 0 = calm)
+  double drag;       // Drag rate of a flying arrow (1/s, 0 = none)
+  double heading0;   // Heading the mean wind veers around (degrees)
+  double mean[2];    // Mean wind (X, Z)
+  double shift[2];   // Drift of the gust grid (X, Z, wrapped)
+  double time;       // Seconds of wind simulated
+  int ticks;         // Simulation ticks since the last grid update
+  unsigned int seed; // Gust random state
+} WindField;
+
+/*
+ *  Start a wind field with gusts already developed
+ *  @param w field to initialize
+ *  @param strength mean wind speed (units per second, 0 = calm)
+ *  @param drag drag rate of a flying arrow (1/s, 0 = none)
+ *  @param seed random seed (same seed, same wind)
+ */
+void initWindField(WindField *w, double strength, double drag,
+                   unsigned int seed);
+
+/*
+ *  Advance the wind by one simulation tick
+ *  The grid is updated every WIND_TICKS ticks.
+ *  @param w wind field
+ *  @param dt simulation tick (seconds)
+ */
+void advanceWindField(WindField *w, double dt);
+
+/*
+ *  Wind at a point
+ *  @param w wind field
+ *  @param x world X
+ *  @param z world Z
+ *  @param out wind velocity (X, Z)
+ */
+void sampleWind(const WindField *w, double x, double z, double out[2]);
+
+/*
+ *  Wind at many points (structure-of-arrays, for the arrow pool)
+ *  @param w wind field
+ *  @param n number of points
+ *  @param x world X of each point
+ *  @param z world Z of each point
+ *  @param wx wind X at each point (output)
+ *  @param wz wind Z at each point (output)
+ */
+void sampleWindArrays(const WindField *w, int n, const float *restrict x,
+                      const float *restrict z, float *restrict wx,
+                      float *restrict wz);
+
+#endif